@@ -0,0 +1,99 @@
+// compares per box frustum culling against the batch (simd) kernel.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "BoxBounds.h"
+#include "BoxBoundsArray.h"
+#include "Frustum.h"
+#include "Matrix4.h"
+
+using namespace fury;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+double ElapsedMs(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main()
+{
+	const unsigned int boxCount = 100000;
+	const unsigned int repeat = 100;
+
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> position(-1000, 1000);
+	std::uniform_real_distribution<float> size(0.5f, 20);
+
+	std::vector<BoxBounds> boxes;
+	BoxBoundsArray boxArray;
+	boxes.reserve(boxCount);
+	boxArray.Reserve(boxCount);
+
+	for (unsigned int i = 0; i < boxCount; i++)
+	{
+		Vector4 min(position(rng), position(rng), position(rng), 1.0f);
+		Vector4 extents(size(rng), size(rng), size(rng), 0.0f);
+		BoxBounds box(min, min + extents);
+
+		boxes.push_back(box);
+		boxArray.Add(box);
+	}
+
+	Frustum frustum;
+	frustum.Setup(1.0f, 1.5f, 1.0f, 800.0f);
+
+	Matrix4 matrix;
+	matrix.Translate(Vector4(100, 50, 300, 1.0f));
+	frustum.Transform(matrix);
+
+	std::vector<unsigned int> scalarResult, batchResult(boxCount);
+	unsigned int batchCount = 0;
+
+	Clock::time_point start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+	{
+		scalarResult.clear();
+		for (unsigned int i = 0; i < boxCount; i++)
+		{
+			if (frustum.IsInsideFast(boxes[i]))
+				scalarResult.push_back(i);
+		}
+	}
+	double scalarMs = ElapsedMs(start) / repeat;
+
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		batchCount = frustum.IsInsideFastBatch(boxArray, 0, boxCount, &batchResult[0]);
+	double batchMs = ElapsedMs(start) / repeat;
+
+	std::vector<Side> sides(boxCount);
+	unsigned int sideMismatch = 0;
+	frustum.IsInsideBatch(boxArray, 0, boxCount, &sides[0]);
+	for (unsigned int i = 0; i < boxCount; i++)
+	{
+		if (sides[i] != frustum.IsInside(boxes[i]))
+			sideMismatch++;
+	}
+
+	batchResult.resize(batchCount);
+	bool match = batchResult == scalarResult && sideMismatch == 0;
+
+#if defined(FURY_USE_AVX)
+	const char *path = "avx";
+#elif defined(FURY_USE_SSE)
+	const char *path = "sse";
+#else
+	const char *path = "scalar";
+#endif
+
+	printf("boxes: %u, visible: %u, path: %s\n", boxCount, batchCount, path);
+	printf("IsInsideFast:      %.3f ms\n", scalarMs);
+	printf("IsInsideFastBatch: %.3f ms (%.2fx)\n", batchMs, scalarMs / batchMs);
+	printf("results %s\n", match ? "match" : "DIFFER");
+
+	return match ? 0 : 1;
+}
\ No newline at end of file
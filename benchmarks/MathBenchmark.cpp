@@ -0,0 +1,329 @@
+// compares the inline (simd) math operators against the old out of line scalar versions,
+// and AffineMatrix against Matrix4 for trs transforms.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "AffineMatrix.h"
+#include "BoxBounds.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
+#include "Vector4.h"
+
+using namespace fury;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+double ElapsedMs(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// the scalar versions, kept out of line like the old exported functions.
+#if defined(_MSC_VER)
+	#define NOINLINE __declspec(noinline)
+#else
+	#define NOINLINE __attribute__((noinline))
+#endif
+
+NOINLINE Matrix4 ScalarMultiply(const Matrix4 &a, const Matrix4 &b)
+{
+	Matrix4 output;
+	for (int i = 0; i < 16; i += 4)
+	{
+		for (int j = 0; j < 4; j++)
+			output.Raw[i + j] = a.Raw[j] * b.Raw[i] + a.Raw[j + 4] * b.Raw[i + 1] + a.Raw[j + 8] * b.Raw[i + 2] + a.Raw[j + 12] * b.Raw[i + 3];
+	}
+	return output;
+}
+
+NOINLINE Vector4 ScalarMultiply(const Matrix4 &m, Vector4 v)
+{
+	const float *r = m.Raw;
+	return Vector4(
+		v.x * r[0] + v.y * r[4] + v.z * r[8] + v.w * r[12],
+		v.x * r[1] + v.y * r[5] + v.z * r[9] + v.w * r[13],
+		v.x * r[2] + v.y * r[6] + v.z * r[10] + v.w * r[14],
+		v.x * r[3] + v.y * r[7] + v.z * r[11] + v.w * r[15]
+	);
+}
+
+NOINLINE Matrix4 ScalarInverse(const Matrix4 &m)
+{
+	const float *r = m.Raw;
+	Matrix4 output;
+
+	float det = r[0] * (r[5] * r[10] - r[6] * r[9]) + r[1] * (r[6] * r[8] - r[4] * r[10]) + r[2] * (r[4] * r[9] - r[5] * r[8]);
+	if (det != 0)
+	{
+		float det2 = 1.0f / det;
+		output.Raw[0] = (r[5] * r[10] - r[6] * r[9]) * det2;
+		output.Raw[1] = (r[2] * r[9] - r[1] * r[10]) * det2;
+		output.Raw[2] = (r[1] * r[6] - r[2] * r[5]) * det2;
+		output.Raw[4] = (r[6] * r[8] - r[4] * r[10]) * det2;
+		output.Raw[5] = (r[0] * r[10] - r[2] * r[8]) * det2;
+		output.Raw[6] = (r[2] * r[4] - r[0] * r[6]) * det2;
+		output.Raw[8] = (r[4] * r[9] - r[5] * r[8]) * det2;
+		output.Raw[9] = (r[1] * r[8] - r[0] * r[9]) * det2;
+		output.Raw[10] = (r[0] * r[5] - r[1] * r[4]) * det2;
+		output.Raw[12] = -(r[12] * output.Raw[0] + r[13] * output.Raw[4] + r[14] * output.Raw[8]);
+		output.Raw[13] = -(r[12] * output.Raw[1] + r[13] * output.Raw[5] + r[14] * output.Raw[9]);
+		output.Raw[14] = -(r[12] * output.Raw[2] + r[13] * output.Raw[6] + r[14] * output.Raw[10]);
+	}
+	return output;
+}
+
+// transforms all 8 corners.
+NOINLINE BoxBounds ScalarMultiply(const Matrix4 &m, const BoxBounds &aabb)
+{
+	Vector4 min = aabb.GetMin(), max = aabb.GetMax();
+	Vector4 newMin(1e30f), newMax(-1e30f);
+
+	for (int i = 0; i < 8; i++)
+	{
+		Vector4 corner = ScalarMultiply(m, Vector4(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z, 1.0f));
+		newMin.x = std::min(newMin.x, corner.x); newMax.x = std::max(newMax.x, corner.x);
+		newMin.y = std::min(newMin.y, corner.y); newMax.y = std::max(newMax.y, corner.y);
+		newMin.z = std::min(newMin.z, corner.z); newMax.z = std::max(newMax.z, corner.z);
+	}
+	return BoxBounds(newMin, newMax);
+}
+
+NOINLINE Quaternion ScalarMultiply(Quaternion a, Quaternion b)
+{
+	return Quaternion(
+		a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+	);
+}
+
+NOINLINE Vector4 ScalarCross(Vector4 a, Vector4 b)
+{
+	return Vector4(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x, 1.0f);
+}
+
+bool Near(float a, float b)
+{
+	return std::abs(a - b) <= 1e-3f * (1.0f + std::abs(a));
+}
+
+bool Near(const Matrix4 &a, const Matrix4 &b)
+{
+	for (int i = 0; i < 16; i++)
+	{
+		if (!Near(a.Raw[i], b.Raw[i]))
+			return false;
+	}
+	return true;
+}
+
+bool Near(Vector4 a, Vector4 b)
+{
+	return Near(a.x, b.x) && Near(a.y, b.y) && Near(a.z, b.z) && Near(a.w, b.w);
+}
+
+void Report(const char *name, double scalarMs, double inlineMs)
+{
+	printf("%-22s scalar %8.3f ms, inline %8.3f ms (%.2fx)\n", name, scalarMs, inlineMs, scalarMs / inlineMs);
+}
+
+int main()
+{
+	const unsigned int count = 100000;
+	const unsigned int repeat = 20;
+
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> value(-10, 10);
+	std::uniform_real_distribution<float> size(0.5f, 20);
+
+	std::vector<Matrix4> matrices(count);
+	std::vector<AffineMatrix> affines(count);
+	std::vector<Vector4> positions(count), scales(count);
+	std::vector<Vector4> vectors(count);
+	std::vector<Quaternion> quats(count);
+	std::vector<BoxBounds> boxes;
+	boxes.reserve(count);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		Quaternion rotation(value(rng), value(rng), value(rng), value(rng));
+		rotation.Normalize();
+
+		positions[i] = Vector4(value(rng), value(rng), value(rng));
+		scales[i] = Vector4(size(rng), size(rng), size(rng));
+
+		matrices[i].Rotate(rotation);
+		matrices[i].AppendScale(scales[i]);
+		matrices[i].PrependTranslation(positions[i]);
+		affines[i] = AffineMatrix(matrices[i]);
+
+		vectors[i] = Vector4(value(rng), value(rng), value(rng), 1.0f);
+		quats[i] = rotation;
+
+		Vector4 min(value(rng), value(rng), value(rng), 1.0f);
+		boxes.push_back(BoxBounds(min, min + Vector4(size(rng), size(rng), size(rng), 0.0f)));
+	}
+
+	std::vector<Matrix4> matrixA(count), matrixB(count);
+	std::vector<AffineMatrix> affineB(count);
+	std::vector<Vector4> vectorA(count), vectorB(count);
+	std::vector<Quaternion> quatA(count), quatB(count);
+	std::vector<BoxBounds> boxA(count), boxB(count);
+
+	Clock::time_point start;
+	double scalarMs, inlineMs;
+	bool match = true;
+
+	// matrix * matrix
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			matrixA[i] = ScalarMultiply(matrices[i], matrices[count - 1 - i]);
+	scalarMs = ElapsedMs(start) / repeat;
+
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			matrixB[i] = matrices[i] * matrices[count - 1 - i];
+	inlineMs = ElapsedMs(start) / repeat;
+
+	Report("Matrix4 * Matrix4", scalarMs, inlineMs);
+	for (unsigned int i = 0; i < count; i++)
+		match = match && Near(matrixA[i], matrixB[i]);
+
+	// matrix * vector
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			vectorA[i] = ScalarMultiply(matrices[i], vectors[i]);
+	scalarMs = ElapsedMs(start) / repeat;
+
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			vectorB[i] = matrices[i].Multiply(vectors[i]);
+	inlineMs = ElapsedMs(start) / repeat;
+
+	Report("Matrix4 * Vector4", scalarMs, inlineMs);
+	for (unsigned int i = 0; i < count; i++)
+		match = match && Near(vectorA[i], vectorB[i]);
+
+	// inverse
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			matrixA[i] = ScalarInverse(matrices[i]);
+	scalarMs = ElapsedMs(start) / repeat;
+
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			matrixB[i] = matrices[i].Inverse();
+	inlineMs = ElapsedMs(start) / repeat;
+
+	Report("Matrix4::Inverse", scalarMs, inlineMs);
+	for (unsigned int i = 0; i < count; i++)
+		match = match && Near(matrixA[i], matrixB[i]);
+
+	// aabb transform, 8 corners vs arvo.
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			boxA[i] = ScalarMultiply(matrices[i], boxes[i]);
+	scalarMs = ElapsedMs(start) / repeat;
+
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			boxB[i] = matrices[i].Multiply(boxes[i]);
+	inlineMs = ElapsedMs(start) / repeat;
+
+	Report("Matrix4 * BoxBounds", scalarMs, inlineMs);
+	for (unsigned int i = 0; i < count; i++)
+		match = match && Near(boxA[i].GetMin(), boxB[i].GetMin()) && Near(boxA[i].GetMax(), boxB[i].GetMax());
+
+	// quaternion * quaternion
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			quatA[i] = ScalarMultiply(quats[i], quats[count - 1 - i]);
+	scalarMs = ElapsedMs(start) / repeat;
+
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			quatB[i] = quats[i] * quats[count - 1 - i];
+	inlineMs = ElapsedMs(start) / repeat;
+
+	Report("Quaternion * Quaternion", scalarMs, inlineMs);
+	for (unsigned int i = 0; i < count; i++)
+		match = match && quatA[i] == quatB[i];
+
+	// vector cross product
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			vectorA[i] = ScalarCross(vectors[i], vectors[count - 1 - i]);
+	scalarMs = ElapsedMs(start) / repeat;
+
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			vectorB[i] = vectors[i].CrossProduct(vectors[count - 1 - i]);
+	inlineMs = ElapsedMs(start) / repeat;
+
+	Report("Vector4::CrossProduct", scalarMs, inlineMs);
+	for (unsigned int i = 0; i < count; i++)
+		match = match && vectorA[i] == vectorB[i];
+
+	// affine * affine against matrix * matrix.
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			matrixA[i] = matrices[i] * matrices[count - 1 - i];
+	scalarMs = ElapsedMs(start) / repeat;
+
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			affineB[i] = affines[i] * affines[count - 1 - i];
+	inlineMs = ElapsedMs(start) / repeat;
+
+	printf("%-22s matrix %8.3f ms, affine %8.3f ms (%.2fx)\n", "Affine * Affine", scalarMs, inlineMs, scalarMs / inlineMs);
+	for (unsigned int i = 0; i < count; i++)
+		match = match && Near(matrixA[i], affineB[i].ToMatrix4());
+
+	// InverseTRS against Matrix4::Inverse.
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			matrixA[i] = matrices[i].Inverse();
+	scalarMs = ElapsedMs(start) / repeat;
+
+	start = Clock::now();
+	for (unsigned int r = 0; r < repeat; r++)
+		for (unsigned int i = 0; i < count; i++)
+			affineB[i].InverseTRS(positions[i], quats[i], scales[i]);
+	inlineMs = ElapsedMs(start) / repeat;
+
+	printf("%-22s matrix %8.3f ms, affine %8.3f ms (%.2fx)\n", "Affine InverseTRS", scalarMs, inlineMs, scalarMs / inlineMs);
+	for (unsigned int i = 0; i < count; i++)
+		match = match && Near(matrixA[i], affineB[i].ToMatrix4());
+
+#if defined(FURY_USE_AVX)
+	const char *path = "avx";
+#elif defined(FURY_USE_SSE)
+	const char *path = "sse";
+#else
+	const char *path = "scalar";
+#endif
+
+	printf("count: %u, path: %s\n", count, path);
+	printf("results %s\n", match ? "match" : "DIFFER");
+
+	return match ? 0 : 1;
+}
\ No newline at end of file
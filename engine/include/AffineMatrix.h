@@ -0,0 +1,248 @@
+#ifndef _FURY_AFFINE_MATRIX_H_
+#define _FURY_AFFINE_MATRIX_H_
+
+#include "Macros.h"
+#include "Matrix4.h"
+#include "Vector4.h"
+
+#if defined(FURY_USE_SSE)
+#include <emmintrin.h>
+#endif
+
+namespace fury
+{
+	class BoxBounds;
+
+	class Quaternion;
+
+	/**
+	 *	The upper 3 rows of an affine Matrix4, the last row is always 0, 0, 0, 1.
+	 *	Stored row by row, so each row is one sse register and position is in Raw[3, 7, 11].
+	 *	0	1	2	3
+	 *	4	5	6	7
+	 *	8	9	10	11
+	 *
+	 *	48 bytes instead of 64, and multiplies skip the constant row.
+	 *	Use it for world transforms, Matrix4 for projections.
+	 */
+	class FURY_API FURY_ALIGN16 AffineMatrix
+	{
+	public:
+
+		float Raw[12];
+
+		AffineMatrix();
+
+		AffineMatrix(const AffineMatrix &other);
+
+		// drops the last row, it should be 0, 0, 0, 1.
+		explicit AffineMatrix(const Matrix4 &matrix);
+
+		void Identity();
+
+		// translation * rotation * scale, the same matrix as
+		// Matrix4's Translate, AppendRotation, AppendScale.
+		void TRS(Vector4 position, Quaternion rotation, Vector4 scale);
+
+		// the inverse of TRS, built by transposing the rotation, rotation should be normalized.
+		// identity if any scale is 0.
+		void InverseTRS(Vector4 position, Quaternion rotation, Vector4 scale);
+
+		// identity if the matrix is singular.
+		AffineMatrix InverseAffine() const;
+
+		Vector4 GetTranslation() const;
+
+		Matrix4 ToMatrix4() const;
+
+		Vector4 Multiply(Vector4 data) const;
+
+		Quaternion Multiply(Quaternion data) const;
+
+		BoxBounds Multiply(const BoxBounds &data) const;
+
+		bool operator == (const AffineMatrix &other) const;
+
+		bool operator != (const AffineMatrix &other) const;
+
+		AffineMatrix &operator = (const AffineMatrix &other);
+
+		AffineMatrix operator * (const AffineMatrix &other) const;
+	};
+
+	inline AffineMatrix::AffineMatrix()
+	{
+		Identity();
+	}
+
+	inline AffineMatrix::AffineMatrix(const AffineMatrix &other)
+	{
+		*this = other;
+	}
+
+	inline void AffineMatrix::Identity()
+	{
+		Raw[0] = 1.0f; Raw[1] = 0.0f; Raw[2] = 0.0f; Raw[3] = 0.0f;
+		Raw[4] = 0.0f; Raw[5] = 1.0f; Raw[6] = 0.0f; Raw[7] = 0.0f;
+		Raw[8] = 0.0f; Raw[9] = 0.0f; Raw[10] = 1.0f; Raw[11] = 0.0f;
+	}
+
+	inline Vector4 AffineMatrix::GetTranslation() const
+	{
+		return Vector4(Raw[3], Raw[7], Raw[11], 1.0f);
+	}
+
+#if defined(FURY_USE_SSE)
+	inline AffineMatrix::AffineMatrix(const Matrix4 &matrix)
+	{
+		__m128 r0 = _mm_loadu_ps(matrix.Raw);
+		__m128 r1 = _mm_loadu_ps(matrix.Raw + 4);
+		__m128 r2 = _mm_loadu_ps(matrix.Raw + 8);
+		__m128 r3 = _mm_loadu_ps(matrix.Raw + 12);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		_mm_storeu_ps(Raw, r0);
+		_mm_storeu_ps(Raw + 4, r1);
+		_mm_storeu_ps(Raw + 8, r2);
+	}
+
+	inline Matrix4 AffineMatrix::ToMatrix4() const
+	{
+		__m128 c0 = _mm_loadu_ps(Raw);
+		__m128 c1 = _mm_loadu_ps(Raw + 4);
+		__m128 c2 = _mm_loadu_ps(Raw + 8);
+		__m128 c3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+		Matrix4 output;
+		_mm_storeu_ps(output.Raw, c0);
+		_mm_storeu_ps(output.Raw + 4, c1);
+		_mm_storeu_ps(output.Raw + 8, c2);
+		_mm_storeu_ps(output.Raw + 12, c3);
+		return output;
+	}
+
+	inline Vector4 AffineMatrix::Multiply(Vector4 data) const
+	{
+		// as columns, summed in the same order as Matrix4::Multiply.
+		__m128 c0 = _mm_loadu_ps(Raw);
+		__m128 c1 = _mm_loadu_ps(Raw + 4);
+		__m128 c2 = _mm_loadu_ps(Raw + 8);
+		__m128 c3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+		__m128 v = _mm_loadu_ps(&data.x);
+		__m128 output = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+		output = _mm_add_ps(output, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+		output = _mm_add_ps(output, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+		output = _mm_add_ps(output, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+
+		Vector4 vector;
+		_mm_storeu_ps(&vector.x, output);
+		return vector;
+	}
+
+	inline bool AffineMatrix::operator == (const AffineMatrix &other) const
+	{
+		__m128 equal = _mm_and_ps(
+			_mm_and_ps(_mm_cmpeq_ps(_mm_loadu_ps(Raw), _mm_loadu_ps(other.Raw)), _mm_cmpeq_ps(_mm_loadu_ps(Raw + 4), _mm_loadu_ps(other.Raw + 4))),
+			_mm_cmpeq_ps(_mm_loadu_ps(Raw + 8), _mm_loadu_ps(other.Raw + 8)));
+		return _mm_movemask_ps(equal) == 15;
+	}
+
+	inline AffineMatrix &AffineMatrix::operator = (const AffineMatrix &other)
+	{
+		_mm_storeu_ps(Raw, _mm_loadu_ps(other.Raw));
+		_mm_storeu_ps(Raw + 4, _mm_loadu_ps(other.Raw + 4));
+		_mm_storeu_ps(Raw + 8, _mm_loadu_ps(other.Raw + 8));
+		return *this;
+	}
+
+	inline AffineMatrix AffineMatrix::operator * (const AffineMatrix &other) const
+	{
+		// rows of other scaled by this row, plus this row's translation.
+		__m128 r0 = _mm_loadu_ps(other.Raw);
+		__m128 r1 = _mm_loadu_ps(other.Raw + 4);
+		__m128 r2 = _mm_loadu_ps(other.Raw + 8);
+		__m128 wMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+		AffineMatrix output;
+		for (int i = 0; i < 12; i += 4)
+		{
+			__m128 a = _mm_loadu_ps(Raw + i);
+			__m128 row = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), r0);
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), r1));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), r2));
+			row = _mm_add_ps(row, _mm_and_ps(a, wMask));
+			_mm_storeu_ps(output.Raw + i, row);
+		}
+		return output;
+	}
+#else
+	inline AffineMatrix::AffineMatrix(const Matrix4 &matrix)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			for (int j = 0; j < 4; j++)
+				Raw[i * 4 + j] = matrix.Raw[j * 4 + i];
+		}
+	}
+
+	inline Matrix4 AffineMatrix::ToMatrix4() const
+	{
+		Matrix4 output;
+		for (int i = 0; i < 3; i++)
+		{
+			for (int j = 0; j < 4; j++)
+				output.Raw[j * 4 + i] = Raw[i * 4 + j];
+		}
+		return output;
+	}
+
+	inline Vector4 AffineMatrix::Multiply(Vector4 data) const
+	{
+		return Vector4(
+			data.x * Raw[0] + data.y * Raw[1] + data.z * Raw[2] + data.w * Raw[3],
+			data.x * Raw[4] + data.y * Raw[5] + data.z * Raw[6] + data.w * Raw[7],
+			data.x * Raw[8] + data.y * Raw[9] + data.z * Raw[10] + data.w * Raw[11],
+			data.w
+		);
+	}
+
+	inline bool AffineMatrix::operator == (const AffineMatrix &other) const
+	{
+		for (int i = 0; i < 12; i++)
+		{
+			if (Raw[i] != other.Raw[i])
+				return false;
+		}
+		return true;
+	}
+
+	inline AffineMatrix &AffineMatrix::operator = (const AffineMatrix &other)
+	{
+		for (int i = 0; i < 12; i++)
+			Raw[i] = other.Raw[i];
+		return *this;
+	}
+
+	inline AffineMatrix AffineMatrix::operator * (const AffineMatrix &other) const
+	{
+		AffineMatrix output;
+		for (int i = 0; i < 12; i += 4)
+		{
+			for (int j = 0; j < 4; j++)
+				output.Raw[i + j] = Raw[i] * other.Raw[j] + Raw[i + 1] * other.Raw[j + 4] + Raw[i + 2] * other.Raw[j + 8];
+			output.Raw[i + 3] += Raw[i + 3];
+		}
+		return output;
+	}
+#endif
+
+	inline bool AffineMatrix::operator != (const AffineMatrix &other) const
+	{
+		return !(*this == other);
+	}
+}
+
+#endif // _FURY_AFFINE_MATRIX_H_
\ No newline at end of file
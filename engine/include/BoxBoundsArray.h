@@ -0,0 +1,45 @@
+#ifndef _FURY_BOXBOUNDS_ARRAY_H_
+#define _FURY_BOXBOUNDS_ARRAY_H_
+
+#include <vector>
+
+#include "Macros.h"
+
+namespace fury
+{
+	class BoxBounds;
+
+	// world space aabbs stored as separate center/extents arrays,
+	// so Collidable's batch tests can load several boxes at once.
+	class FURY_API BoxBoundsArray
+	{
+	public:
+
+		// extents used for infinite aabbs, always straddles a plane.
+		static const float InfiniteExtents;
+
+		std::vector<float> CenterX, CenterY, CenterZ;
+
+		std::vector<float> ExtentsX, ExtentsY, ExtentsZ;
+
+		unsigned int GetSize() const;
+
+		void Reserve(unsigned int size);
+
+		void Clear();
+
+		void Add(const BoxBounds &aabb);
+
+		void Set(unsigned int index, const BoxBounds &aabb);
+
+		BoxBounds GetAt(unsigned int index) const;
+
+		// erase and keep order.
+		void EraseAt(unsigned int index);
+
+		// move the last one to index, then pop back.
+		void RemoveAt(unsigned int index);
+	};
+}
+
+#endif // _FURY_BOXBOUNDS_ARRAY_H_
\ No newline at end of file
@@ -0,0 +1,162 @@
+#ifndef _FURY_BVH_SCENE_MANAGER_H_
+#define _FURY_BVH_SCENE_MANAGER_H_
+
+#include <vector>
+#include <memory>
+#include <typeindex>
+
+#include "BoxBoundsArray.h"
+#include "SceneManager.h"
+
+namespace fury
+{
+	class BoxBounds;
+
+	/**
+	 *	A bounding volume hierarchy, built top down with binned SAH.
+	 *
+	 *	Nodes live in one array in depth-first order, a node's left child is the next
+	 *	node, it's right child is the left child's skip. Scenenodes are sorted by leaf,
+	 *	so a node's subtree owns [objectBegin, objectEnd).
+	 *
+	 *	Moving scenenodes only refit the bounds bottom up before the next query,
+	 *	the tree is rebuilt when adding scenenodes, or when refits make the SAH cost
+	 *	worse than rebuildThreshold times the cost after the last build.
+	 *
+	 *	Like OcTree, it holds a shared_ptr to attached scenenodes.
+	 */
+	class FURY_API BvhSceneManager : public SceneManager
+	{
+	public:
+
+		typedef std::shared_ptr<BvhSceneManager> Ptr;
+
+		static Ptr Create(unsigned int maxLeafSize = 4, float rebuildThreshold = 1.5f);
+
+		static const unsigned int InvalidIndex;
+
+		// SAH bins per axis.
+		static const unsigned int BinCount = 16;
+
+		struct Node
+		{
+			float min[3];
+
+			float max[3];
+
+			// index past this node's subtree, a node is a leaf if it's skip is index + 1.
+			unsigned int skip;
+
+			unsigned int objectBegin;
+
+			unsigned int objectEnd;
+		};
+
+	protected:
+
+		struct BuildItem
+		{
+			unsigned int slot;
+
+			float min[3];
+
+			float max[3];
+
+			float center[3];
+		};
+
+		std::type_index m_TypeIndex;
+
+		unsigned int m_MaxLeafSize;
+
+		float m_RebuildThreshold;
+
+		// slot -> attached scenenode.
+		std::vector<std::shared_ptr<SceneNode>> m_SceneNodes;
+
+		std::vector<unsigned int> m_FreeSlots;
+
+		unsigned int m_SceneNodeCount = 0;
+
+		// slot -> object index, InvalidIndex for infinite scenenodes, valid when not dirty.
+		mutable std::vector<unsigned int> m_SlotObjects;
+
+		mutable std::vector<Node> m_Nodes;
+
+		// object -> slot of the scenenode, InvalidIndex if it's removed.
+		mutable std::vector<unsigned int> m_ObjectSlots;
+
+		// object -> world aabb, soa for batch culling.
+		mutable BoxBoundsArray m_ObjectBounds;
+
+		// infinite scenenodes are never culled, they're kept out of the tree.
+		mutable std::vector<unsigned int> m_InfiniteSlots;
+
+		mutable std::vector<BuildItem> m_BuildItems;
+
+		mutable unsigned int m_RemovedCount = 0;
+
+		mutable float m_BuildCost = 0.0f;
+
+		mutable float m_Cost = 0.0f;
+
+		mutable bool m_Dirty = true;
+
+		mutable bool m_NeedsRefit = false;
+
+	public:
+
+		BvhSceneManager(unsigned int maxLeafSize, float rebuildThreshold);
+
+		virtual ~BvhSceneManager();
+
+		virtual std::type_index GetTypeIndex() const;
+
+		virtual void AddSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void AddSceneNodeRecursively(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void RemoveSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void UpdateSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void WalkScene(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags = 0) const;
+
+		// visits nodes nearest entry first, infinite scenenodes are skipped.
+		virtual void WalkRay(const Ray &ray, float maxDistance, const RayFunc &rayFunc, unsigned int flags = 0) const;
+
+		virtual void Clear();
+
+		void SetRebuildThreshold(float threshold);
+
+		float GetRebuildThreshold() const;
+
+		unsigned int GetSceneNodeCount() const;
+
+		unsigned int GetNodeCount() const;
+
+		// SAH cost of the current tree, relative to the root's area.
+		float GetCost() const;
+
+		// rebuild or refit now if needed, instead of on the next query.
+		void Refresh() const;
+
+	protected:
+
+		void Rebuild() const;
+
+		// update node bounds bottom up, then the SAH cost.
+		void Refit() const;
+
+		// builds the subtree of m_BuildItems [begin, end), returns it's node index.
+		unsigned int BuildNode(unsigned int begin, unsigned int end) const;
+
+		void SetNodeBounds(Node &node, unsigned int begin, unsigned int end) const;
+
+		float ComputeCost() const;
+
+		float GetHalfArea(const float *min, const float *max) const;
+	};
+}
+
+#endif // _FURY_BVH_SCENE_MANAGER_H_
\ No newline at end of file
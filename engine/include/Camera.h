@@ -6,6 +6,7 @@
 #include "Component.h"
 #include "Matrix4.h"
 #include "Frustum.h"
+#include "Ray.h"
 
 namespace fury
 {
@@ -38,6 +39,8 @@ namespace fury
 
 		Component::Ptr Clone() const override;
 
+		unsigned int GetComponentFlags() const override;
+
 		void PerspectiveFov(float fov, float ratio, float near, float far);
 
 		void PerspectiveOffCenter(float left, float right, float bottom, float top, float near, float far);
@@ -74,6 +77,10 @@ namespace fury
 		// test the visiablity of a point.
 		bool IsVisible(Vector4 point) const;
 
+		// picking ray through a point on screen, x and y from -1 to 1, bottom left is -1, -1.
+		// starts at the near plane, in world space.
+		Ray GetRay(float x, float y) const;
+
 		// SceneNode::OnTransformChange callback.
 		void OnSceneNodeTransformChange(const std::shared_ptr<SceneNode> &sender);
 
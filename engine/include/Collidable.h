@@ -7,6 +7,8 @@ namespace fury
 {
 	class BoxBounds;
 
+	class BoxBoundsArray;
+
 	class SphereBounds;
 
 	class Vector4;
@@ -26,6 +28,13 @@ namespace fury
 		virtual bool IsInsideFast(const BoxBounds &aabb) const = 0;
 
 		virtual bool IsInsideFast(Vector4 point) const = 0;
+
+		// batch IsInside, writes one side for each aabb in [begin, end) to output.
+		virtual void IsInsideBatch(const BoxBoundsArray &aabbs, unsigned int begin, unsigned int end, Side *output) const;
+
+		// batch IsInsideFast, writes the indices of aabbs in [begin, end) that pass to output.
+		// returns the count of indices written, output should hold (end - begin) indices.
+		virtual unsigned int IsInsideFastBatch(const BoxBoundsArray &aabbs, unsigned int begin, unsigned int end, unsigned int *output) const;
 	};
 }
 
@@ -28,6 +28,9 @@ namespace fury
 
 		bool HasOwner() const;
 
+		// SceneNode::ComponentFlags this component adds to it's owner.
+		virtual unsigned int GetComponentFlags() const;
+
 	protected:
 
 		std::type_index m_TypeIndex;
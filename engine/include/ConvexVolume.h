@@ -0,0 +1,67 @@
+#ifndef _FURY_CONVEX_VOLUME_H_
+#define _FURY_CONVEX_VOLUME_H_
+
+#include <vector>
+
+#include "Collidable.h"
+#include "Plane.h"
+
+namespace fury
+{
+	class BoxBounds;
+
+	class BoxBoundsArray;
+
+	class Frustum;
+
+	class SphereBounds;
+
+	// a convex volume bounded by any number of planes, normals point inside.
+	class FURY_API ConvexVolume : public Collidable
+	{
+	protected:
+
+		std::vector<Plane> m_Planes;
+
+	public:
+
+		ConvexVolume() {}
+
+		// frustum swept along direction, see SetExtrudedFrustum.
+		ConvexVolume(const Frustum &frustum, Vector4 direction, const BoxBounds *clipBounds = nullptr);
+
+		// builds the volume of everything that can cast a shadow into frustum,
+		// when lit along direction: the frustum extruded backwards, towards the light.
+		// the volume is clipped to clipBounds if it's given and finite, usually the scene's bounds.
+		void SetExtrudedFrustum(const Frustum &frustum, Vector4 direction, const BoxBounds *clipBounds = nullptr);
+
+		void AddPlane(const Plane &plane);
+
+		// the 6 sides of aabb.
+		void AddPlanes(const BoxBounds &aabb);
+
+		void Clear();
+
+		unsigned int GetPlaneCount() const;
+
+		Plane GetPlaneAt(unsigned int index) const;
+
+		virtual Side IsInside(Vector4 point) const;
+
+		virtual Side IsInside(const BoxBounds &aabb) const;
+
+		virtual Side IsInside(const SphereBounds &bsphere) const;
+
+		virtual bool IsInsideFast(const SphereBounds &bsphere) const;
+
+		virtual bool IsInsideFast(const BoxBounds &aabb) const;
+
+		virtual bool IsInsideFast(Vector4 point) const;
+
+		virtual void IsInsideBatch(const BoxBoundsArray &aabbs, unsigned int begin, unsigned int end, Side *output) const;
+
+		virtual unsigned int IsInsideFastBatch(const BoxBoundsArray &aabbs, unsigned int begin, unsigned int end, unsigned int *output) const;
+	};
+}
+
+#endif // _FURY_CONVEX_VOLUME_H_
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef _FURY_CULLING_STATS_H_
+#define _FURY_CULLING_STATS_H_
+
+#include "Macros.h"
+
+namespace fury
+{
+	// counters of culling queries, see SceneManager::SetWalkStatsCounting.
+	// managers fill the tree counters they track, OcTree fills them all.
+	struct FURY_API CullingStats
+	{
+		// tree nodes whose scenenodes were tested or accepted.
+		unsigned int treeNodesVisited = 0;
+
+		// visited tree nodes fully inside the collider, their scenenodes skip tests.
+		unsigned int treeNodesInside = 0;
+
+		// tree node and scenenode aabbs tested against a collider.
+		unsigned int aabbTests = 0;
+
+		// only counted with Frustum::SetPlaneTestCounting on.
+		unsigned long long planeTests = 0;
+
+		unsigned int sceneNodesEmitted = 0;
+
+		// milliseconds.
+		float time = 0.0f;
+
+		CullingStats &operator += (const CullingStats &other)
+		{
+			treeNodesVisited += other.treeNodesVisited;
+			treeNodesInside += other.treeNodesInside;
+			aabbTests += other.aabbTests;
+			planeTests += other.planeTests;
+			sceneNodesEmitted += other.sceneNodesEmitted;
+			time += other.time;
+			return *this;
+		}
+
+		CullingStats &operator -= (const CullingStats &other)
+		{
+			treeNodesVisited -= other.treeNodesVisited;
+			treeNodesInside -= other.treeNodesInside;
+			aabbTests -= other.aabbTests;
+			planeTests -= other.planeTests;
+			sceneNodesEmitted -= other.sceneNodesEmitted;
+			time -= other.time;
+			return *this;
+		}
+	};
+}
+
+#endif // _FURY_CULLING_STATS_H_
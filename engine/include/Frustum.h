@@ -2,6 +2,7 @@
 #define _FURY_FRUSTUM_H_
 
 #include <array>
+#include <atomic>
 
 #include "Collidable.h"
 #include "Plane.h"
@@ -11,12 +12,23 @@ namespace fury
 {
 	class BoxBounds;
 
+	class BoxBoundsArray;
+
 	class SphereBounds;
 
 	class FURY_API Frustum : public Collidable
 	{
+	public:
+
+		// bit mask of all 6 planes.
+		static const unsigned char AllPlanes = 0x3f;
+
 	private:
 
+		static bool m_CountPlaneTests;
+
+		static std::atomic<unsigned long long> m_PlaneTestCount;
+
 		std::array<Vector4, 8> m_BaseCorners;
 
 		std::array<Vector4, 8> m_CurrentCorners;
@@ -52,6 +64,22 @@ namespace fury
 
 		virtual bool IsInsideFast(Vector4 point) const;
 
+		// temporal coherence version, for objects that are culled every frame.
+		// lastPlane is tested first and set to the rejecting plane on OUT.
+		// planes in parentMask, the ones a parent aabb is fully inside of, are skipped.
+		// mask comes in as last result's mask, planes it straddled are tested first,
+		// and goes out as the planes aabb is fully inside of, AllPlanes when IN.
+		Side IsInside(const BoxBounds &aabb, unsigned char &lastPlane, unsigned char parentMask, unsigned char &mask) const;
+
+		// temporal coherence version of IsInsideFast, see above.
+		bool IsInsideFast(const BoxBounds &aabb, unsigned char &lastPlane, unsigned char parentMask) const;
+
+		// simd version, tests 4 (sse) or 8 (avx) aabbs per iteration.
+		virtual void IsInsideBatch(const BoxBoundsArray &aabbs, unsigned int begin, unsigned int end, Side *output) const;
+
+		// simd version, tests 4 (sse) or 8 (avx) aabbs per iteration.
+		virtual unsigned int IsInsideFastBatch(const BoxBoundsArray &aabbs, unsigned int begin, unsigned int end, unsigned int *output) const;
+
 		// ntl, ntr, nbl, nbr, ftl, ftr, fbl, fbr
 		std::array<Vector4, 8> GetCurrentCorners() const;
 
@@ -60,6 +88,20 @@ namespace fury
 		Matrix4 GetTransformMatrix() const;
 
 		BoxBounds GetBoxBounds() const;
+
+		// counts aabb vs plane tests of all frustums, for profiling culling.
+		// batch tests count 6 per aabb.
+		static void SetPlaneTestCounting(bool enable);
+
+		static bool GetPlaneTestCounting();
+
+		static unsigned long long GetPlaneTestCount();
+
+		static void ResetPlaneTestCount();
+
+	private:
+
+		void CountPlaneTests(unsigned int count) const;
 	};
 }
 
@@ -1,36 +1,46 @@
 #ifndef _FURY_FURY_H_
 #define _FURY_FURY_H_
 
+#include "AffineMatrix.h"
 #include "AnimationClip.h"
 #include "AnimationPlayer.h"
 #include "AnimationUtil.h"
 #include "ArrayBuffers.h"
 #include "BoxBounds.h"
+#include "BoxBoundsArray.h"
 #include "Buffer.h"
+#include "BvhSceneManager.h"
 #include "Camera.h"
 #include "Component.h"
 #include "Color.h"
 #include "Collidable.h"
+#include "ConvexVolume.h"
+#include "CullingStats.h"
 #include "Engine.h"
 #include "Entity.h"
 #include "EntityUtil.h"
 #include "FileUtil.h"
 #include "FbxParser.h"
 #include "Frustum.h"
+#include "GridSceneManager.h"
 #include "InputUtil.h"
 #include "Joint.h"
 #include "Light.h"
+#include "LinearOcTree.h"
 #include "Log.h"
 #include "MathUtil.h"
 #include "Material.h"
 #include "Matrix4.h"
 #include "Mesh.h"
+#include "MeshBvh.h"
 #include "MeshRender.h"
 #include "MeshUtil.h"
 #include "OcTree.h"
 #include "OcTreeNode.h"
+#include "OcclusionCuller.h"
 #include "Plane.h"
 #include "Quaternion.h"
+#include "Ray.h"
 #include "Pass.h"
 #include "Pipeline.h"
 #include "PrelightPipeline.h"
@@ -42,9 +52,11 @@
 #include "Shader.h"
 #include "Singleton.h"
 #include "SphereBounds.h"
+#include "SplitSceneManager.h"
 #include "Texture.h"
 #include "ThreadUtil.h"
 #include "Transform.h"
+#include "TransformSystem.h"
 #include "TypeComparable.h"
 #include "Uniform.h"
 #include "Vector4.h"
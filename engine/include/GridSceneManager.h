@@ -0,0 +1,134 @@
+#ifndef _FURY_GRID_SCENE_MANAGER_H_
+#define _FURY_GRID_SCENE_MANAGER_H_
+
+#include <vector>
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+
+#include "BoxBoundsArray.h"
+#include "SceneManager.h"
+#include "Vector4.h"
+
+namespace fury
+{
+	class BoxBounds;
+
+	/**
+	 *	A uniform grid of cubic cells, hashed so only occupied cells are stored.
+	 *
+	 *	Made for many similar sized scenenodes spread evenly over the map, ie. crowds.
+	 *	A scenenode lives in the cell of it's aabb's center, cells are tested loosely,
+	 *	grown by the largest extents added since the last Clear.
+	 *
+	 *	Moving a scenenode updates it's bounds in place, or swaps it out of the old cell
+	 *	and appends it to the new one, both O(1).
+	 *
+	 *	WalkScene rasterizes the collider's aabb over cells, if the collider is a Frustum,
+	 *	BoxBounds or SphereBounds. it falls back to testing every occupied cell
+	 *	when the footprint covers more cells than are occupied, or the collider is unknown.
+	 *
+	 *	Like OcTree, it holds a shared_ptr to attached scenenodes.
+	 */
+	class FURY_API GridSceneManager : public SceneManager
+	{
+	public:
+
+		typedef std::shared_ptr<GridSceneManager> Ptr;
+
+		static Ptr Create(float cellSize = 10.0f);
+
+		static const unsigned int InvalidIndex;
+
+	protected:
+
+		struct Cell
+		{
+			int x, y, z;
+
+			std::vector<unsigned int> slots;
+
+			// world aabbs of slots, soa for batch culling.
+			BoxBoundsArray bounds;
+		};
+
+		std::type_index m_TypeIndex;
+
+		float m_CellSize;
+
+		// slot -> attached scenenode.
+		std::vector<std::shared_ptr<SceneNode>> m_SceneNodes;
+
+		std::vector<unsigned int> m_FreeSlots;
+
+		unsigned int m_SceneNodeCount = 0;
+
+		// slot -> cell index, InvalidIndex for infinite scenenodes.
+		std::vector<unsigned int> m_SlotCells;
+
+		// slot -> position in it's cell, or in m_InfiniteSlots.
+		std::vector<unsigned int> m_SlotPositions;
+
+		// cells are never freed until Clear, agents come back.
+		std::vector<Cell> m_Cells;
+
+		std::unordered_map<unsigned long long, unsigned int> m_CellMap;
+
+		// infinite scenenodes are never culled, they're kept out of the grid.
+		std::vector<unsigned int> m_InfiniteSlots;
+
+		// largest half size of any scenenode, how far they reach out of their cell.
+		Vector4 m_MaxExtents;
+
+	public:
+
+		GridSceneManager(float cellSize);
+
+		virtual ~GridSceneManager();
+
+		virtual std::type_index GetTypeIndex() const;
+
+		virtual void AddSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void AddSceneNodeRecursively(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void RemoveSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void UpdateSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void WalkScene(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags = 0) const;
+
+		virtual void Clear();
+
+		float GetCellSize() const;
+
+		unsigned int GetSceneNodeCount() const;
+
+		// cells that hold at least one scenenode.
+		unsigned int GetOccupiedCellCount() const;
+
+	protected:
+
+		// put slot into the cell of aabb, or the infinite list.
+		void Insert(unsigned int slot, const BoxBounds &aabb);
+
+		// take slot out of it's cell or the infinite list, O(1).
+		void Erase(unsigned int slot);
+
+		unsigned int GetCell(int x, int y, int z);
+
+		int GetCellCoord(float value) const;
+
+		// loose bounds of a cell, grown by m_MaxExtents.
+		BoxBounds GetCellBounds(const Cell &cell) const;
+
+		void WalkCell(const Collidable &collider, const Cell &cell, const FilterFunc &filterFunc) const;
+
+		// world aabb of the known colliders, false if it's unknown.
+		static bool GetColliderBounds(const Collidable &collider, BoxBounds &aabb);
+
+		static unsigned long long GetCellKey(int x, int y, int z);
+	};
+}
+
+#endif // _FURY_GRID_SCENE_MANAGER_H_
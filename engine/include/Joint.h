@@ -1,6 +1,7 @@
 #ifndef _FURY_JOINT_H_
 #define _FURY_JOINT_H_
 
+#include "AffineMatrix.h"
 #include "Entity.h"
 #include "Matrix4.h"
 #include "Quaternion.h"
@@ -31,13 +32,14 @@ namespace fury
 
 		std::weak_ptr<Joint> m_Parent;
 
-		Matrix4 m_LocalMatrix;
+		// affine, converted to Matrix4 by the getters.
+		AffineMatrix m_LocalMatrix;
 
-		Matrix4 m_CombinedMatrix;
+		AffineMatrix m_CombinedMatrix;
 
-		Matrix4 m_OffsetMatrix;
+		AffineMatrix m_OffsetMatrix;
 
-		Matrix4 m_FinalMatrix;
+		AffineMatrix m_FinalMatrix;
 
 		std::pair<Vector4, Vector4> m_Position;
 
@@ -53,6 +55,8 @@ namespace fury
 
 		void Update(const Matrix4 &matrix);
 
+		void Update(const AffineMatrix &matrix);
+
 		// update local matrix by interpolated TRS value pairs.
 		void Update(float dt);
 
@@ -47,6 +47,8 @@ namespace fury
 
 		Component::Ptr Clone() const override;
 
+		unsigned int GetComponentFlags() const override;
+
 		LightType GetType() const;
 
 		void SetType(LightType type);
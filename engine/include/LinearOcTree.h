@@ -0,0 +1,148 @@
+#ifndef _FURY_LINEAR_OCTREE_H_
+#define _FURY_LINEAR_OCTREE_H_
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <typeindex>
+
+#include "BoxBoundsArray.h"
+#include "SceneManager.h"
+#include "Vector4.h"
+
+namespace fury
+{
+	class BoxBounds;
+
+	/**
+	 *	A pointer free octree.
+	 *
+	 *	Cells live in one array in depth-first (morton) order, so a cell's subtree is
+	 *	the range [index, skip) and culling is a single forward pass that jumps over
+	 *	rejected subtrees, no stack and no shared_ptr copies.
+	 *
+	 *	Scenenodes are sorted by cell, a cell owns [objectBegin, objectEnd) and it's
+	 *	whole subtree owns [objectBegin, subtreeObjectEnd).
+	 *
+	 *	A scenenode that moves inside it's cell is updated in place,
+	 *	adding, or moving to another cell, rebuilds the arrays before the next query.
+	 *
+	 *	Like OcTree, it holds a shared_ptr to attached scenenodes.
+	 */
+	class FURY_API LinearOcTree : public SceneManager
+	{
+	public:
+
+		typedef std::shared_ptr<LinearOcTree> Ptr;
+
+		static Ptr Create(Vector4 min, Vector4 max, unsigned int maxDepth = 6);
+
+		static const unsigned int InvalidIndex;
+
+		// location codes use 3 bits per level.
+		static const unsigned int MaxDepthLimit;
+
+		struct Cell
+		{
+			float min[3];
+
+			float max[3];
+
+			// 1 followed by the cell's morton code, 1 is root.
+			uint64_t code;
+
+			unsigned int depth;
+
+			unsigned int parent;
+
+			// index past this cell's subtree, aka next sibling.
+			unsigned int skip;
+
+			unsigned int objectBegin;
+
+			unsigned int objectEnd;
+
+			unsigned int subtreeObjectEnd;
+		};
+
+	protected:
+
+		std::type_index m_TypeIndex;
+
+		Vector4 m_Min;
+
+		Vector4 m_Max;
+
+		unsigned int m_MaxDepth;
+
+		// slot -> attached scenenode.
+		std::vector<std::shared_ptr<SceneNode>> m_SceneNodes;
+
+		// slot -> location code of the cell it belongs to, 0 for free slots.
+		std::vector<uint64_t> m_SlotCodes;
+
+		std::vector<unsigned int> m_FreeSlots;
+
+		// slot -> object index, valid when not dirty.
+		mutable std::vector<unsigned int> m_SlotObjects;
+
+		mutable std::vector<Cell> m_Cells;
+
+		// object -> slot of the scenenode, InvalidIndex if it's removed.
+		mutable std::vector<unsigned int> m_ObjectSlots;
+
+		// object -> world aabb, soa for batch culling.
+		mutable BoxBoundsArray m_ObjectBounds;
+
+		mutable std::vector<std::pair<uint64_t, unsigned int>> m_SortBuffer;
+
+		mutable std::vector<unsigned int> m_CellStack;
+
+		mutable bool m_Dirty = true;
+
+	public:
+
+		LinearOcTree(Vector4 min, Vector4 max, unsigned int maxDepth);
+
+		virtual ~LinearOcTree();
+
+		virtual std::type_index GetTypeIndex() const;
+
+		virtual void AddSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void AddSceneNodeRecursively(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void RemoveSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void UpdateSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void WalkScene(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags = 0) const;
+
+		virtual void Reset(Vector4 min, Vector4 max, unsigned int maxDepth);
+
+		virtual void Clear();
+
+		unsigned int GetSceneNodeCount() const;
+
+		unsigned int GetCellCount() const;
+
+	protected:
+
+		// sort scenenodes by cell and rebuild cell array.
+		void Rebuild() const;
+
+		// location code of the deepest cell that contains the aabb.
+		uint64_t GetLocationCode(const BoxBounds &aabb) const;
+
+		unsigned int GetCodeDepth(uint64_t code) const;
+
+		void SetCellBounds(Cell &cell) const;
+
+		// spread lower 21 bits to every 3rd bit.
+		uint64_t SpreadBits(uint64_t value) const;
+
+		uint64_t CompactBits(uint64_t value) const;
+	};
+}
+
+#endif // _FURY_LINEAR_OCTREE_H_
\ No newline at end of file
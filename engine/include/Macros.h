@@ -38,4 +38,27 @@ do {} while (false)
 
 #define FURY_MIPMAP_LEVEL 5
 
+// simd code paths, define FURY_NO_SIMD to use the scalar fallbacks.
+#if !defined(FURY_NO_SIMD)
+
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define FURY_USE_SSE
+	#endif
+
+	#if defined(__AVX__)
+		#define FURY_USE_AVX
+	#endif
+
+#endif
+
+// 16 byte alignment for the math types, sse paths use unaligned loads so it's only a hint.
+// msvc can't pass over-aligned types by value on x86, and 2013 has no alignas.
+#if defined(FURY_USE_SSE) && !defined(_MSC_VER)
+	#define FURY_ALIGN16 alignas(16)
+#elif defined(FURY_USE_SSE) && defined(_M_X64)
+	#define FURY_ALIGN16 __declspec(align(16))
+#else
+	#define FURY_ALIGN16
+#endif
+
 #endif // _FURY_MACROS_H_
\ No newline at end of file
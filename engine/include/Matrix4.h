@@ -5,6 +5,11 @@
 #include <initializer_list>
 
 #include "Macros.h"
+#include "Vector4.h"
+
+#if defined(FURY_USE_SSE)
+#include <emmintrin.h>
+#endif
 
 namespace fury
 {
@@ -12,8 +17,6 @@ namespace fury
 
 	class Quaternion;
 
-	class Vector4;
-
 	class Plane;
 
 	/**
@@ -22,8 +25,11 @@ namespace fury
 	 *	1	5	9	13
 	 *	2	6	10	14
 	 *	3	7	11	15
+	 *
+	 *	each column is one sse register.
+	 *	hot operators are inline below, the rest lives in Matrix4.cpp.
 	 */
-	class FURY_API Matrix4
+	class FURY_API FURY_ALIGN16 Matrix4
 	{
 	public:
 
@@ -95,6 +101,119 @@ namespace fury
 		Matrix4 operator * (const Matrix4 &other) const;
 	};
 
+	inline Matrix4::Matrix4()
+	{
+		Identity();
+	}
+
+	inline Matrix4::Matrix4(const Matrix4 &other)
+	{
+		*this = other;
+	}
+
+	inline void Matrix4::Identity()
+	{
+		Raw[0] = 1.0f; Raw[4] = 0.0f; Raw[8] = 0.0f; Raw[12] = 0.0f;
+		Raw[1] = 0.0f; Raw[5] = 1.0f; Raw[9] = 0.0f; Raw[13] = 0.0f;
+		Raw[2] = 0.0f; Raw[6] = 0.0f; Raw[10] = 1.0f; Raw[14] = 0.0f;
+		Raw[3] = 0.0f; Raw[7] = 0.0f; Raw[11] = 0.0f; Raw[15] = 1.0f;
+	}
+
+#if defined(FURY_USE_SSE)
+	inline Vector4 Matrix4::Multiply(Vector4 data) const
+	{
+		// columns scaled by the components, summed in the same order as the scalar path.
+		__m128 v = _mm_loadu_ps(&data.x);
+		__m128 output = _mm_mul_ps(_mm_loadu_ps(Raw), _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+		output = _mm_add_ps(output, _mm_mul_ps(_mm_loadu_ps(Raw + 4), _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+		output = _mm_add_ps(output, _mm_mul_ps(_mm_loadu_ps(Raw + 8), _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+		output = _mm_add_ps(output, _mm_mul_ps(_mm_loadu_ps(Raw + 12), _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+
+		Vector4 vector;
+		_mm_storeu_ps(&vector.x, output);
+		return vector;
+	}
+
+	inline bool Matrix4::operator == (const Matrix4 &other) const
+	{
+		__m128 equal = _mm_and_ps(
+			_mm_and_ps(_mm_cmpeq_ps(_mm_loadu_ps(Raw), _mm_loadu_ps(other.Raw)), _mm_cmpeq_ps(_mm_loadu_ps(Raw + 4), _mm_loadu_ps(other.Raw + 4))),
+			_mm_and_ps(_mm_cmpeq_ps(_mm_loadu_ps(Raw + 8), _mm_loadu_ps(other.Raw + 8)), _mm_cmpeq_ps(_mm_loadu_ps(Raw + 12), _mm_loadu_ps(other.Raw + 12))));
+		return _mm_movemask_ps(equal) == 15;
+	}
+
+	inline Matrix4 &Matrix4::operator = (const Matrix4 &other)
+	{
+		_mm_storeu_ps(Raw, _mm_loadu_ps(other.Raw));
+		_mm_storeu_ps(Raw + 4, _mm_loadu_ps(other.Raw + 4));
+		_mm_storeu_ps(Raw + 8, _mm_loadu_ps(other.Raw + 8));
+		_mm_storeu_ps(Raw + 12, _mm_loadu_ps(other.Raw + 12));
+		return *this;
+	}
+
+	inline Matrix4 Matrix4::operator * (const Matrix4 &other) const
+	{
+		__m128 c0 = _mm_loadu_ps(Raw);
+		__m128 c1 = _mm_loadu_ps(Raw + 4);
+		__m128 c2 = _mm_loadu_ps(Raw + 8);
+		__m128 c3 = _mm_loadu_ps(Raw + 12);
+
+		Matrix4 output;
+		for (int i = 0; i < 16; i += 4)
+		{
+			__m128 column = _mm_mul_ps(c0, _mm_set1_ps(other.Raw[i]));
+			column = _mm_add_ps(column, _mm_mul_ps(c1, _mm_set1_ps(other.Raw[i + 1])));
+			column = _mm_add_ps(column, _mm_mul_ps(c2, _mm_set1_ps(other.Raw[i + 2])));
+			column = _mm_add_ps(column, _mm_mul_ps(c3, _mm_set1_ps(other.Raw[i + 3])));
+			_mm_storeu_ps(output.Raw + i, column);
+		}
+		return output;
+	}
+#else
+	inline Vector4 Matrix4::Multiply(Vector4 data) const
+	{
+		return Vector4(
+			data.x * Raw[0] + data.y * Raw[4] + data.z * Raw[8] + data.w * Raw[12],
+			data.x * Raw[1] + data.y * Raw[5] + data.z * Raw[9] + data.w * Raw[13],
+			data.x * Raw[2] + data.y * Raw[6] + data.z * Raw[10] + data.w * Raw[14],
+			data.x * Raw[3] + data.y * Raw[7] + data.z * Raw[11] + data.w * Raw[15]
+		);
+	}
+
+	inline bool Matrix4::operator == (const Matrix4 &other) const
+	{
+		for(int i = 0; i < 16; i++)
+		{
+			if(Raw[i] != other.Raw[i]) 
+				return false;
+		}
+		return true;
+	}
+
+	inline Matrix4 &Matrix4::operator = (const Matrix4 &other)
+	{
+		for(int i = 0; i < 16; i++)
+			Raw[i] = other.Raw[i];
+		return *this;
+	}
+
+	inline Matrix4 Matrix4::operator * (const Matrix4 &other) const
+	{
+		Matrix4 output;
+		for (int i = 0; i < 16; i += 4)
+		{
+			for (int j = 0; j < 4; j++)
+				output.Raw[i + j] = Raw[j] * other.Raw[i] + Raw[j + 4] * other.Raw[i + 1] + Raw[j + 8] * other.Raw[i + 2] + Raw[j + 12] * other.Raw[i + 3];
+		}
+		return output;
+	}
+#endif
+	
+	inline bool Matrix4::operator != (const Matrix4 &other) const
+	{
+		return !(*this == other);
+	}
+
 }
 
 #endif // _FURY_MATRIX4_H_
\ No newline at end of file
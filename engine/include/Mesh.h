@@ -48,6 +48,8 @@ namespace fury
 
 	class Joint;
 
+	class MeshBvh;
+
 	class FURY_API Mesh : public Entity, public Buffer
 	{
 	public:
@@ -76,6 +78,8 @@ namespace fury
 
 		bool m_CastShadows = false;
 
+		std::shared_ptr<MeshBvh> m_RayCastBvh;
+
 	public:
 
 		ArrayBufferf Positions;
@@ -126,6 +130,14 @@ namespace fury
 		bool GetCastShadows() const;
 
 		void SetCastShadows(bool state);
+
+		// triangle bvh for exact hits of SceneManager::RayCast, built from the raw data,
+		// so call it before DeleteRawData. skinned meshes are only tested by their aabb.
+		void BuildRayCastBvh(unsigned int maxLeafSize = 4);
+
+		void DeleteRayCastBvh();
+
+		std::shared_ptr<MeshBvh> GetRayCastBvh() const;
 	};
 }
 
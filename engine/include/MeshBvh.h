@@ -0,0 +1,85 @@
+#ifndef _FURY_MESH_BVH_H_
+#define _FURY_MESH_BVH_H_
+
+#include <vector>
+#include <memory>
+
+#include "Macros.h"
+
+namespace fury
+{
+	class Mesh;
+
+	class Ray;
+
+	/**
+	 *	A bvh over a mesh's triangles, for exact ray casts.
+	 *
+	 *	Built top down, splitting at the median center of the longest axis.
+	 *	Nodes use the same depth-first layout as BvhSceneManager, triangles are
+	 *	copied in leaf order, so it stays valid after Mesh::DeleteRawData.
+	 */
+	class FURY_API MeshBvh
+	{
+	public:
+
+		typedef std::shared_ptr<MeshBvh> Ptr;
+
+		static Ptr Create(const Mesh &mesh, unsigned int maxLeafSize = 4);
+
+		struct Node
+		{
+			float min[3];
+
+			float max[3];
+
+			// index past this node's subtree, a node is a leaf if it's skip is index + 1.
+			unsigned int skip;
+
+			unsigned int triangleBegin;
+
+			unsigned int triangleEnd;
+		};
+
+	protected:
+
+		struct BuildItem
+		{
+			unsigned int triangle;
+
+			float center[3];
+		};
+
+		unsigned int m_MaxLeafSize;
+
+		std::vector<Node> m_Nodes;
+
+		// 3 vertices of 3 floats per triangle, in leaf order.
+		std::vector<float> m_Vertices;
+
+		// leaf order -> triangle index in the mesh.
+		std::vector<unsigned int> m_Triangles;
+
+	public:
+
+		// uses the submeshes' indices, or the mesh's if it has no submeshes.
+		MeshBvh(const Mesh &mesh, unsigned int maxLeafSize);
+
+		// ray in the mesh's model space, nearest hit within maxDistance.
+		// triangle is the hit's index in the mesh's triangles, if not null.
+		bool RayCast(const Ray &ray, float maxDistance, float &distance, unsigned int *triangle = nullptr) const;
+
+		unsigned int GetTriangleCount() const;
+
+		unsigned int GetNodeCount() const;
+
+	protected:
+
+		void AddTriangles(const std::vector<float> &positions, const std::vector<unsigned int> &indices);
+
+		// builds the subtree of items [begin, end), returns it's node index.
+		unsigned int BuildNode(std::vector<BuildItem> &items, const std::vector<float> &vertices, unsigned int begin, unsigned int end);
+	};
+}
+
+#endif // _FURY_MESH_BVH_H_
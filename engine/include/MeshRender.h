@@ -1,6 +1,9 @@
 #ifndef _FURY_MESHRENDER_H_
 #define _FURY_MESHRENDER_H_
 
+#include <utility>
+#include <vector>
+
 #include "Component.h"
 
 namespace fury
@@ -17,18 +20,44 @@ namespace fury
 
 		static Ptr Create(const std::shared_ptr<Material> &material, const std::shared_ptr<Mesh> &mesh);
 
+		// a new id for SelectLod, each view keeps it's own lod per MeshRender.
+		static unsigned int CreateLodView();
+
 	protected:
 
+		struct Lod
+		{
+			std::weak_ptr<Mesh> mesh;
+
+			float distance;
+		};
+
+		static const unsigned int MaxLodViews = 8;
+
 		std::vector<std::weak_ptr<Material>> m_Materials;
 
 		std::weak_ptr<Mesh> m_Mesh;
 
+		bool m_Occluder = false;
+
+		std::weak_ptr<Mesh> m_OccluderMesh;
+
+		// coarser meshes, by distance.
+		std::vector<Lod> m_Lods;
+
+		float m_LodHysteresis = 0.1f;
+
+		// view id and the lod it picked last time, oldest first.
+		mutable std::vector<std::pair<unsigned int, unsigned int>> m_LodStates;
+
 	public:
 
 		MeshRender(const std::shared_ptr<Material> &material, const std::shared_ptr<Mesh> &mesh);
 
 		Component::Ptr Clone() const override;
 
+		unsigned int GetComponentFlags() const override;
+
 		void UpdateBuffer();
 
 		// if index exceeds material.size().
@@ -45,6 +74,37 @@ namespace fury
 
 		bool GetRenderable() const;
 
+		// occluders are drawn to OcclusionCuller's depth buffer, with occluderMesh if it's set,
+		// a simplified mesh that lies inside the rendered one, or with the rendered mesh.
+		void SetOccluder(bool occluder, const std::shared_ptr<Mesh> &occluderMesh = nullptr);
+
+		bool GetOccluder() const;
+
+		std::shared_ptr<Mesh> GetOccluderMesh() const;
+
+		// mesh is drawn from distance on, instead of the finer ones.
+		// it has to have as many submeshes as the mesh, they share materials.
+		void AddLod(const std::shared_ptr<Mesh> &mesh, float distance);
+
+		void RemoveAllLods();
+
+		// lod 0 is the mesh, lods added follow by distance.
+		unsigned int GetLodCount() const;
+
+		// GetMesh for lod 0, or if the lod's mesh is gone.
+		std::shared_ptr<Mesh> GetLodMesh(unsigned int lod) const;
+
+		float GetLodDistance(unsigned int lod) const;
+
+		// switching back to a finer lod waits until it's this fraction
+		// closer than the distance, so lods don't flicker at the threshold.
+		void SetLodHysteresis(float fraction);
+
+		float GetLodHysteresis() const;
+
+		// lod to draw at distance for view, remembers it for the view's next call.
+		unsigned int SelectLod(unsigned int view, float distance) const;
+
 	protected:
 
 		virtual void OnAttaching(const std::shared_ptr<SceneNode> &node) override;
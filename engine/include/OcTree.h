@@ -5,15 +5,21 @@
 #include <memory>
 #include <typeindex>
 
+#include "BoxBounds.h"
 #include "Color.h"
 #include "SceneManager.h"
 #include "Vector4.h"
 
 namespace fury
 {
+	class Frustum;
+
 	class OcTreeNode;
 
 	// OcTree holds a shared_ptr to attached scenenodes.
+	// With looseness > 1, it's a loose octree: cells' bounds are scaled by looseness,
+	// a scenenode goes to the cell it's center falls in, as deep as it still fits,
+	// so small moving scenenodes rarely change cells.
 	// When you need to destory a scenenode.
 	// Call node.RemoveFromOcTree(true) + node.RemoveFromParent() + node.reset().
 	// You'll destory this node and all it's childs.
@@ -23,7 +29,21 @@ namespace fury
 
 		typedef std::shared_ptr<OcTree> Ptr;
 
-		static Ptr Create(Vector4 min, Vector4 max, unsigned int maxDepth = 6);
+		static Ptr Create(Vector4 min, Vector4 max, unsigned int maxDepth = 6, float looseness = 1.0f);
+
+		struct MemoryStats
+		{
+			unsigned int treeNodeCount;
+
+			// tree nodes with no scenenodes below them.
+			unsigned int emptyTreeNodeCount;
+
+			// tree nodes and the arrays they own.
+			size_t bytes;
+
+			// tree nodes per depth, root is depth 0.
+			std::vector<unsigned int> depthHistogram;
+		};
 
 	protected:
 
@@ -33,9 +53,82 @@ namespace fury
 
 		unsigned int m_MaxDepth;
 
+		float m_Looseness;
+
+		// below this many scenenodes, WalkSceneParallel walks on the calling thread.
+		unsigned int m_ParallelThreshold = 4096;
+
+		bool m_CoherentCulling = false;
+
+		// RemoveSceneNode calls Prune after emptying this many tree nodes, 0 turns it off.
+		unsigned int m_PruneThreshold = 64;
+
+		unsigned int m_EmptiedCount = 0;
+
+		// SceneNode::GetComponentFlagsVersion the flags kept in tree nodes are from.
+		mutable unsigned int m_FlagsVersion = 0;
+
+		// planes the node is fully inside of, Frustum::AllPlanes if it's inside.
+		typedef std::pair<unsigned char, const OcTreeNode*> TreeNodePair;
+
+		typedef std::vector<const std::shared_ptr<SceneNode>*> VisibleList;
+
+		struct WalkTask
+		{
+			std::vector<TreeNodePair> pairs;
+
+			VisibleList visibles;
+
+			CullingStats stats;
+		};
+
+		struct MultiWalkPair
+		{
+			// views the node is visible to.
+			unsigned int active;
+
+			// views the node is fully inside of.
+			unsigned int inside;
+
+			const OcTreeNode *treeNode;
+		};
+
+		// one per subtree of a parallel walk, reused between walks.
+		mutable std::vector<WalkTask> m_WalkTasks;
+
+		// reused by FlushUpdates.
+		SceneNodes m_FlushNodes;
+
+		std::vector<std::pair<unsigned int, unsigned int>> m_FlushOrder;
+
+		// bump allocator for the tree nodes of one Build task, see OcTree.cpp.
+		class BuildPool;
+
+		struct BuildItem
+		{
+			const std::shared_ptr<SceneNode> *sceneNode;
+
+			BoxBounds aabb;
+
+			unsigned int flags;
+
+			// 0 if it stays in the tree node, child index + 1 otherwise.
+			unsigned int bucket;
+		};
+
+		// items [begin, end) all go below treeNode.
+		struct BuildRange
+		{
+			std::shared_ptr<OcTreeNode> treeNode;
+
+			unsigned int depth;
+
+			unsigned int begin, end;
+		};
+
 	public:
 
-		OcTree(Vector4 min, Vector4 max, unsigned int maxDepth);
+		OcTree(Vector4 min, Vector4 max, unsigned int maxDepth, float looseness = 1.0f);
 
 		~OcTree();
 
@@ -45,23 +138,64 @@ namespace fury
 
 		virtual void AddSceneNodeRecursively(const std::shared_ptr<SceneNode> &sceneNode);
 
+		// clears the tree, then adds sceneNodes top down, to the same cells AddSceneNode would pick.
+		// subtrees are built on ThreadUtil's workers, their tree nodes come from one pool per subtree.
+		void Build(const SceneNodes &sceneNodes);
+
 		virtual void RemoveSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
 
+		// a scenenode that still fits it's cell stays there,
+		// only it's cached aabb is refreshed.
 		virtual void UpdateSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
 
-		virtual void GetRenderQuery(const Collidable &collider, const std::shared_ptr<RenderQuery> &renderQuery) const;
+		// scenenodes that leave their cells are removed first,
+		// then added in morton order of their centers, so neighbours go down the same path.
+		virtual void FlushUpdates();
+
+		virtual void UpdateSceneNodeFlags(const SceneNode &sceneNode);
+
+		// flags are tested on the copy kept next to each scenenode's aabb.
+		virtual void WalkScene(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags = 0) const;
+
+		// splits the top levels into subtrees, culls them on ThreadUtil's workers,
+		// then calls filterFunc with each subtree's results in tree order.
+		// only one parallel walk per octree at a time.
+		virtual void WalkSceneParallel(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags = 0) const;
+
+		virtual void WalkSceneMulti(const Colliders &colliders, const MultiFilterFunc &filterFunc, unsigned int flags = 0) const;
+
+		// visits cells and scenenodes nearest entry first, slab testing loose aabbs.
+		virtual void WalkRay(const Ray &ray, float maxDistance, const RayFunc &rayFunc, unsigned int flags = 0) const;
+
+		void SetParallelThreshold(unsigned int sceneNodeCount);
+
+		unsigned int GetParallelThreshold() const;
 
-		virtual void GetVisibleSceneNodes(const Collidable &collider, SceneNodes &sceneNodes) const;
+		float GetLooseness() const;
 
-		virtual void GetVisibleRenderables(const Collidable &collider, SceneNodes &renderables) const;
+		// when culling with a Frustum, test nodes and scenenodes one at a time,
+		// starting with the plane that rejected them last time, and skip planes
+		// a parent node is fully inside of. worth it when cameras move smoothly,
+		// measure with Frustum::SetPlaneTestCounting.
+		void SetCoherentCulling(bool enable);
 
-		virtual void GetVisibleShadowCasters(const Collidable &collider, SceneNodes &renderables) const;
+		bool GetCoherentCulling() const;
 
-		virtual void GetVisibleLights(const Collidable &collider, SceneNodes &lights) const;
+		void SetPruneThreshold(unsigned int treeNodeCount);
 
-		virtual void GetVisibleRenderableAndLights(const Collidable &collider, SceneNodes &renderables, SceneNodes &lights) const;
+		unsigned int GetPruneThreshold() const;
 
-		virtual void WalkScene(const Collidable &collider, const FilterFunc &filterFunc) const;
+		// frees subtrees that were already empty at the last Prune and still are,
+		// marks the ones that just became empty. so cells that empty and refill
+		// from frame to frame are kept, while abandoned branches go after two calls.
+		void Prune();
+
+		// frees all empty subtrees, then reallocates the tree nodes from one pool
+		// in depth first order, with their arrays trimmed to size.
+		// tree node pointers taken before this are stale after it.
+		void Compact();
+
+		MemoryStats GetMemoryStats() const;
 
 		virtual void Reset(Vector4 min, Vector4 max, unsigned int maxDepth);
 
@@ -71,6 +205,40 @@ namespace fury
 
 		void AddSceneNode(const std::shared_ptr<SceneNode> &sceneNode, const std::shared_ptr<OcTreeNode> &treeNode, unsigned int depth);
 
+		// adds range's scenenodes that stay in it's tree node, pushes a range per child for the rest.
+		void BuildTreeNode(const BuildRange &range, std::vector<BuildItem> &items, std::vector<BuildItem> &scratch, 
+			const std::shared_ptr<BuildPool> &pool, std::vector<BuildRange> &childRanges);
+
+		// builds range's whole subtree.
+		void BuildSubTree(const BuildRange &range, std::vector<BuildItem> &items, std::vector<BuildItem> &scratch, 
+			const std::shared_ptr<BuildPool> &pool);
+
+		// copy treeNode's non-empty subtree from pool, scenenodes move to the copy.
+		std::shared_ptr<OcTreeNode> CompactTreeNode(OcTreeNode &treeNode, const std::shared_ptr<OcTreeNode> &parent, 
+			const std::shared_ptr<BuildPool> &pool);
+
+		// refresh sceneNode's cached aabb if it still fits it's cell.
+		bool UpdateInPlace(const std::shared_ptr<SceneNode> &sceneNode);
+
+		// 10 bits per axis morton code of point, relative to root's aabb.
+		unsigned int GetMortonCode(Vector4 point) const;
+
+		// re-read all scenenodes' flags if a shared mesh or material changed since last time.
+		void RefreshSceneNodeFlags() const;
+
+		// collider as a Frustum if coherent culling is on, otherwise nullptr.
+		const Frustum *GetCoherentFrustum(const Collidable &collider) const;
+
+		// test root, returns false if it's not visible.
+		bool WalkRoot(const Collidable &collider, const Frustum *coherent, TreeNodePair &pair) const;
+
+		// cull pair's own scenenodes with any of flags into visibles, push it's visible childs to pairs.
+		void WalkTreeNode(const Collidable &collider, const Frustum *coherent, unsigned int flags, TreeNodePair pair, 
+			VisibleList &visibles, std::vector<TreeNodePair> &pairs, CullingStats &stats) const;
+
+		// walk until task.pairs is empty.
+		void WalkTreeNodes(const Collidable &collider, const Frustum *coherent, unsigned int flags, WalkTask &task) const;
+
 	};
 }
 
@@ -1,6 +1,7 @@
 #ifndef _FURY_OCTREENODE_H_
 #define _FURY_OCTREENODE_H_
 
+#include "BoxBoundsArray.h"
 #include "SceneNode.h"
 
 namespace fury
@@ -35,16 +36,40 @@ namespace fury
 
 		BoxBounds m_AABB;
 
+		// m_AABB scaled by the octree's looseness, scenenodes stay inside it.
+		BoxBounds m_LooseAABB;
+
 		OcTree& m_Manager;
 
 		OcTreeNode::Ptr m_Childs[8];
 
 		std::vector<std::shared_ptr<SceneNode>> m_SceneNodes;
 
+		// world aabbs of m_SceneNodes, same order.
+		BoxBoundsArray m_SceneNodeBounds;
+
+		// SceneNode::ComponentFlags of m_SceneNodes, same order.
+		mutable std::vector<unsigned int> m_SceneNodeFlags;
+
+		// loose aabbs of all 8 childs, created or not.
+		BoxBoundsArray m_ChildBounds;
+
+		// coherent culling hints, see OcTree::SetCoherentCulling.
+		// last plane that rejected each of m_SceneNodes, same order.
+		mutable std::vector<unsigned char> m_SceneNodePlanes;
+
+		mutable unsigned char m_LastPlane = 0;
+
+		// planes this node was fully inside of last time.
+		mutable unsigned char m_InsideMask = 0;
+
 		OcTreeNode::Ptr m_Parent;
 
 		bool m_IsLeaf;
 
+		// found empty by the last OcTree::Prune, freed by the next one if it's still empty.
+		bool m_PruneCandidate = false;
+
 		unsigned int m_TotalSceneNodeCount;
 
 	public:
@@ -58,6 +83,8 @@ namespace fury
 
 		BoxBounds GetAABB() const;
 
+		BoxBounds GetLooseAABB() const;
+
 		OcTree &GetManager() const;
 
 		bool IsTwiceSize(BoxBounds other) const;
@@ -66,6 +93,19 @@ namespace fury
 
 		OcTreeNode::Ptr GetFitNode(BoxBounds other);
 
+		// the child other's center falls in, if other fits in it's loose aabb.
+		// returns nullptr if it doesn't.
+		OcTreeNode::Ptr GetLooseFitNode(BoxBounds other);
+
+		// index of the child GetFitNode would pick, -1 if other stays in this node.
+		int GetFitChildIndex(const BoxBounds &other) const;
+
+		// index of the child GetLooseFitNode would pick, -1 if other fits none.
+		int GetLooseFitChildIndex(const BoxBounds &other) const;
+
+		// if other is inside this node's loose aabb.
+		bool CanHold(const BoxBounds &other) const;
+
 		std::shared_ptr<OcTreeNode> GetChildAt(unsigned int index) const;
 
 		unsigned int GetSceneNodeCount() const;
@@ -74,14 +114,25 @@ namespace fury
 
 		unsigned int GetTotalSceneNodeCount() const;
 
+		// bytes of this node and the arrays it owns, not counting it's childs.
+		size_t GetMemoryBytes() const;
+
 		void Clear();
 
 		void AddSceneNode(const std::shared_ptr<SceneNode> &node);
 
+		// swaps with the last scenenode, so it's O(1).
 		void RemoveSceneNode(const std::shared_ptr<SceneNode> &node);
 
+		// refresh node's cached world aabb.
+		void UpdateSceneNode(const std::shared_ptr<SceneNode> &node);
+
 	protected:
 
+		BoxBounds GetChildAABB(unsigned int index) const;
+
+		BoxBounds GetLooseAABB(const BoxBounds &aabb) const;
+
 		void IncreaseSceneNodeCount();
 
 		void DecreaseSceneNodeCount();
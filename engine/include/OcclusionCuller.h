@@ -0,0 +1,117 @@
+#ifndef _FURY_OCCLUSION_CULLER_H_
+#define _FURY_OCCLUSION_CULLER_H_
+
+#include <memory>
+#include <vector>
+
+#include "Macros.h"
+#include "Matrix4.h"
+
+namespace fury
+{
+	class BoxBounds;
+
+	class Mesh;
+
+	class RenderQuery;
+
+	class SceneNode;
+
+	/**
+	 *	Software occlusion culling, runs on the cpu only.
+	 *
+	 *	Occluders (see MeshRender::SetOccluder) are rasterized into a low resolution
+	 *	depth buffer, then a max depth pyramid (hi-z) is built from it, and aabbs are
+	 *	tested against the level where their screen rect covers at most 2x2 texels.
+	 *
+	 *	Depth is ndc z, 1 is the far plane. Aabbs that cross the near plane are
+	 *	always visible.
+	 */
+	class FURY_API OcclusionCuller
+	{
+	public:
+
+		typedef std::shared_ptr<OcclusionCuller> Ptr;
+
+		static Ptr Create(unsigned int width = 256, unsigned int height = 128);
+
+	protected:
+
+		// a multiple of 4, rows are rasterized 4 pixels at a time.
+		unsigned int m_Width;
+
+		unsigned int m_Height;
+
+		Matrix4 m_ViewProjMatrix;
+
+		// level 0 is the depth buffer, each texel of level n + 1 is the max of 2x2 in level n.
+		std::vector<std::vector<float>> m_Levels;
+
+		std::vector<unsigned int> m_LevelWidths;
+
+		std::vector<unsigned int> m_LevelHeights;
+
+		// an occluder's vertices in clip space, reused between occluders.
+		std::vector<Vector4> m_ClipVertices;
+
+		// nodes Cull removed, sorted, reused between frames.
+		std::vector<const SceneNode*> m_Occluded;
+
+		unsigned int m_OccluderCount = 0;
+
+		unsigned int m_TriangleCount = 0;
+
+		unsigned int m_CulledCount = 0;
+
+	public:
+
+		OcclusionCuller(unsigned int width, unsigned int height);
+
+		// clears the depth buffer, viewProjMatrix takes world space to clip space.
+		void Begin(const Matrix4 &viewProjMatrix);
+
+		void Begin(const std::shared_ptr<SceneNode> &camNode);
+
+		// rasterize the node's MeshRender occluder mesh.
+		void AddOccluder(const std::shared_ptr<SceneNode> &node);
+
+		void AddOccluder(const std::shared_ptr<Mesh> &mesh, const Matrix4 &worldMatrix);
+
+		// builds the hi-z, call it after adding occluders, before testing.
+		void End();
+
+		bool IsVisible(const BoxBounds &aabb) const;
+
+		// rasterize the query's occluders, then remove what they hide from it.
+		// call it before RenderQuery::Sort.
+		void Cull(const std::shared_ptr<SceneNode> &camNode, const std::shared_ptr<RenderQuery> &renderQuery);
+
+		unsigned int GetWidth() const;
+
+		unsigned int GetHeight() const;
+
+		// level 0 is the depth buffer itself.
+		const std::vector<float> &GetDepthLevel(unsigned int level = 0) const;
+
+		unsigned int GetLevelCount() const;
+
+		// stats of the last frame.
+		unsigned int GetOccluderCount() const;
+
+		unsigned int GetTriangleCount() const;
+
+		unsigned int GetCulledCount() const;
+
+	protected:
+
+		// clip against the near plane, then rasterize.
+		void DrawTriangle(const Vector4 &v0, const Vector4 &v1, const Vector4 &v2);
+
+		// vertices in screen space, z is depth.
+		void RasterizeTriangle(Vector4 v0, Vector4 v1, Vector4 v2);
+
+		void BuildHiZ();
+	};
+}
+
+#endif // _FURY_OCCLUSION_CULLER_H_
\ No newline at end of file
@@ -5,10 +5,14 @@
 #include <unordered_map>
 #include <string>
 #include <vector>
+#include <utility>
 #include <initializer_list>
 
+#include "ConvexVolume.h"
+#include "Frustum.h"
 #include "Pipeline.h"
 #include "Matrix4.h"
+#include "SphereBounds.h"
 
 namespace fury
 {
@@ -16,10 +20,18 @@ namespace fury
 
 	class Shader;
 
+	class Material;
+
+	class Mesh;
+
+	class MeshRender;
+
 	class Pass;
 
 	class RenderQuery;
 
+	class OcclusionCuller;
+
 	struct RenderUnit;
 
 	class FURY_API PrelightPipeline : public Pipeline
@@ -36,24 +48,115 @@ namespace fury
 
 		std::shared_ptr<Shader> m_CurrentShader;
 
+		// state left bound by DrawUnit, units are sorted so neighbours often share it.
+		std::shared_ptr<Shader> m_BoundShader;
+
+		const Material *m_BoundMaterial = nullptr;
+
 		std::shared_ptr<Pass> m_SharedPass;
 		
 		Matrix4 m_BiasMatrix;
 
+		std::shared_ptr<OcclusionCuller> m_OcclusionCuller;
+
+		// what a camera keeps across frames.
+		struct CameraView
+		{
+			std::shared_ptr<RenderQuery> query;
+
+			// shadow maps drawn for the camera pick their own lods, see MeshRender::CreateLodView.
+			unsigned int shadowLodView;
+		};
+
+		// one view per camera name, reused every frame.
+		std::unordered_map<std::string, CameraView> m_CameraViews;
+
+		// per frame scratch buffers, cleared after each frame but keeping their capacity.
+		std::vector<std::shared_ptr<SceneNode>> m_CamNodes;
+
+		std::vector<std::shared_ptr<RenderQuery>> m_CamQueries;
+
+		std::vector<Frustum> m_CamFrustums;
+
+		std::vector<const Collidable*> m_CamColliders;
+
+		// shadow casters of this frame, culled in one walk over all shadow views.
+		// views are sorted by light node, for binary search.
+		std::vector<std::pair<const SceneNode*, unsigned int>> m_LightShadowViews;
+
+		// directional lights have a view per camera, keyed by light and camera node.
+		std::vector<std::pair<std::pair<const SceneNode*, const SceneNode*>, unsigned int>> m_DirShadowViews;
+
+		std::vector<std::vector<std::shared_ptr<SceneNode>>> m_ShadowCasters;
+
+		// m_ShadowCasters' capacities before the walk, to count what it grew.
+		std::vector<size_t> m_ShadowCasterCapacities;
+
+		// shapes of the shadow views, only the first views of each are used in a frame.
+		std::vector<ConvexVolume> m_CasterVolumes;
+
+		std::vector<SphereBounds> m_LightSpheres;
+
+		std::vector<Frustum> m_LightFrustums;
+
+		std::vector<const Collidable*> m_ShadowColliders;
+
+		std::vector<bool> m_CastersOnly;
+
+		// times one of the scratch buffers had to grow, queries count their own.
+		unsigned int m_AllocationCount = 0;
+
+		float m_LodScale = 1.0f;
+
+		float m_ShadowLodScale = 2.0f;
+
+		// shadow lod view of the current camera.
+		unsigned int m_CurrentShadowLodView = 0;
+
 	public:
 
 		PrelightPipeline(const std::string &name);
 
 		virtual void Execute(const std::shared_ptr<SceneManager> &sceneManager) override;
 
+		// culls each camera's query with it's occluders before sorting, null to turn it off.
+		void SetOcclusionCuller(const std::shared_ptr<OcclusionCuller> &culler);
+
+		std::shared_ptr<OcclusionCuller> GetOcclusionCuller() const;
+
+		// camera distances are scaled by this to pick MeshRender lods, > 1 for coarser.
+		void SetLodScale(float scale);
+
+		float GetLodScale() const;
+
+		// same for shadow casters, from the camera the shadow is drawn for.
+		// shadows hide detail, so they default to twice the distance.
+		void SetShadowLodScale(float scale);
+
+		float GetShadowLodScale() const;
+
+		// times the pipeline's scratch buffers or it's camera queries had to grow or be created.
+		// stays put in steady state, scene managers, shaders and textures aren't counted.
+		unsigned int GetAllocationCount() const;
+
+		void ResetAllocationCount();
+
 	protected:
 
 		void DrawUnit(const std::shared_ptr<Pass> &pass, const RenderUnit &unit);
 
+		// unbinds what DrawUnit left bound, call it after the last unit of a pass.
+		void EndDrawUnits();
+
 		void DrawLight(const std::shared_ptr<SceneManager> &sceneManager, const std::shared_ptr<Pass> &pass, const std::shared_ptr<SceneNode> &node);
 
 		void DrawQuad(const std::shared_ptr<Pass> &pass);
 
+		void CullShadowCasters(const std::shared_ptr<SceneManager> &sceneManager);
+
+		// casters from CullShadowCasters, null if the light wasn't culled this frame.
+		const std::vector<std::shared_ptr<SceneNode>> *FindShadowCasters(const std::shared_ptr<SceneNode> &lightNode, const std::shared_ptr<SceneNode> &camNode) const;
+
 		std::pair<std::shared_ptr<Texture>, Matrix4> DrawShadowMap(const std::shared_ptr<SceneManager> &sceneManager, const std::shared_ptr<Pass> &pass, const std::shared_ptr<SceneNode> &node);
 
 		std::pair<std::shared_ptr<Texture>, Matrix4> DrawDirLightShadowMap(const std::shared_ptr<SceneManager> &sceneManager, const std::shared_ptr<Pass> &pass, const std::shared_ptr<SceneNode> &node);
@@ -62,7 +165,10 @@ namespace fury
 
 		std::pair<std::shared_ptr<Texture>, Matrix4> DrawSpotLightShadowMap(const std::shared_ptr<SceneManager> &sceneManager, const std::shared_ptr<Pass> &pass, const std::shared_ptr<SceneNode> &node);
 
-		void DrawDebug(std::unordered_map<std::string, std::shared_ptr<RenderQuery>> &queries);
+		// lod mesh of a caster for the current camera's shadow maps.
+		std::shared_ptr<Mesh> GetShadowCasterMesh(const SceneNode &caster, const MeshRender &render) const;
+
+		void DrawDebug();
 	};
 }
 
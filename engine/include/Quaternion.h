@@ -3,11 +3,16 @@
 
 #include "Macros.h"
 
+#if defined(FURY_USE_SSE)
+#include <emmintrin.h>
+#endif
+
 namespace fury
 {
 	class Vector4;
 
-	class FURY_API Quaternion
+	// aligned like Vector4, hot operators are inline below.
+	class FURY_API FURY_ALIGN16 Quaternion
 	{
 	public:
 		
@@ -41,6 +46,62 @@ namespace fury
 		
 		Quaternion operator * (Quaternion other) const;
 	};
+
+	inline float Quaternion::DotProduct(Quaternion other) const
+	{
+		return w * other.w + x * other.x + y * other.y + z * other.z;
+	}
+
+	inline Quaternion Quaternion::Conjugate() const
+	{
+		return Quaternion(-x, -y, -z, w);
+	}
+
+	inline bool Quaternion::operator == (Quaternion other) const
+	{
+		return x == other.x && y == other.y && z == other.z && w == other.w;
+	}
+	
+	inline bool Quaternion::operator != (Quaternion other) const
+	{
+		return x != other.x || y != other.y || z != other.z || w != other.w;
+	}
+
+	inline Quaternion &Quaternion::operator = (Quaternion other)
+	{
+		x = other.x; y = other.y; z = other.z; w = other.w;
+		return *this;
+	}
+	
+	inline Quaternion Quaternion::operator * (Quaternion other) const
+	{
+#if defined(FURY_USE_SSE)
+		// w * other + x * (ow, -oz, oy, -ox) + y * (oz, ow, -ox, -oy) + z * (-oy, ox, ow, -oz),
+		// summed in the same order as the scalar path.
+		__m128 a = _mm_loadu_ps(&x);
+		__m128 b = _mm_loadu_ps(&other.x);
+
+		__m128 bx = _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3)), _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f));
+		__m128 by = _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2)), _mm_set_ps(-0.0f, -0.0f, 0.0f, 0.0f));
+		__m128 bz = _mm_xor_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1)), _mm_set_ps(-0.0f, 0.0f, 0.0f, -0.0f));
+
+		__m128 output = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)), b);
+		output = _mm_add_ps(output, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), bx));
+		output = _mm_add_ps(output, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), by));
+		output = _mm_add_ps(output, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), bz));
+
+		Quaternion quat;
+		_mm_storeu_ps(&quat.x, output);
+		return quat;
+#else
+		return Quaternion(
+			w * other.x + x * other.w + y * other.z - z * other.y, 
+			w * other.y - x * other.z + y * other.w + z * other.x, 
+			w * other.z + x * other.y - y * other.x + z * other.w, 
+			w * other.w - x * other.x - y * other.y - z * other.z
+		);
+#endif
+	}
 }
 
 #endif // _FURY_QUATERNION_H_
\ No newline at end of file
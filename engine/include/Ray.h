@@ -0,0 +1,54 @@
+#ifndef _FURY_RAY_H_
+#define _FURY_RAY_H_
+
+#include "Vector4.h"
+
+namespace fury
+{
+	class BoxBounds;
+
+	class Matrix4;
+
+	// a half line, distances along it are in units of it's direction's length.
+	class FURY_API Ray
+	{
+	protected:
+
+		Vector4 m_Origin;
+
+		Vector4 m_Direction;
+
+		// 1 / direction per axis, for slab tests.
+		Vector4 m_InvDirection;
+
+	public:
+
+		Ray();
+
+		// direction is normalized, so distances are world distances.
+		Ray(Vector4 origin, Vector4 direction);
+
+		// direction is kept as is.
+		void SetOriginAndDirection(Vector4 origin, Vector4 direction);
+
+		Vector4 GetOrigin() const;
+
+		Vector4 GetDirection() const;
+
+		Vector4 GetPoint(float distance) const;
+
+		// slab test, entry is where the ray enters aabb, 0 if it starts inside.
+		bool Intersects(const BoxBounds &aabb, float maxDistance, float &entry) const;
+
+		// same as above, on raw min/max.
+		bool Intersects(const float *min, const float *max, float maxDistance, float &entry) const;
+
+		// double sided triangle test.
+		bool Intersects(Vector4 v0, Vector4 v1, Vector4 v2, float maxDistance, float &distance) const;
+
+		// direction isn't normalized, so distances stay the same after a scaling matrix.
+		Ray Transform(const Matrix4 &matrix) const;
+	};
+}
+
+#endif // _FURY_RAY_H_
@@ -1,9 +1,11 @@
 #ifndef _FURY_RENDERQUERY_H_
 #define _FURY_RENDERQUERY_H_
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
+#include "CullingStats.h"
 #include "Vector4.h"
 
 namespace fury
@@ -14,24 +16,22 @@ namespace fury
 
 	class Mesh;
 
+	// a plain record, cheap to copy and sort.
+	// the scene keeps node, mesh and material alive while the query is used,
+	// don't keep units across frames.
 	struct FURY_API RenderUnit
 	{
-		std::shared_ptr<SceneNode> node;
+		SceneNode *node;
 
-		std::shared_ptr<Mesh> mesh;
+		Mesh *mesh;
 
-		std::shared_ptr<Material> material;
+		Material *material;
 
-		int subMesh = 0;
+		// -1 draws the whole mesh.
+		int subMesh;
 
-		RenderUnit(const std::shared_ptr<SceneNode> &node, const std::shared_ptr<Mesh> &mesh,
-			const std::shared_ptr<Material> &material, int subMesh)
-		{
-			this->node = node;
-			this->mesh = mesh;
-			this->material = material;
-			this->subMesh = subMesh;
-		}
+		// state and depth packed for RenderQuery::Sort, see RenderQuery::GetSortKey.
+		uint64_t sortKey;
 	};
 
 	class FURY_API RenderQuery
@@ -42,6 +42,8 @@ namespace fury
 
 		static Ptr Create();
 
+		RenderQuery();
+
 		std::vector<RenderUnit> opaqueUnits;
 
 		std::vector<RenderUnit> transparentUnits;
@@ -50,13 +52,71 @@ namespace fury
 
 		std::vector<std::shared_ptr<SceneNode>> lightNodes;
 
+		// how the query was culled, filled by SceneManager::GetRenderQuery.
+		CullingStats cullingStats;
+
 		void AddRenderable(const std::shared_ptr<SceneNode> &node);
 
 		void AddLight(const std::shared_ptr<SceneNode> &node);
 
+		// AddRenderable picks MeshRender lods by the distance from position, times scale,
+		// so scale > 1 picks coarser lods. without a lod view it always draws lod 0.
+		void SetLodView(Vector4 position, float scale = 1.0f);
+
+		void RemoveLodView();
+
+		// sorts both lists by their units' sort keys.
+		// opaque units are grouped by shader, material and mesh, then front to back.
+		// transparent units are back to front, then grouped by state.
 		void Sort(Vector4 camPos);
 
+		// keeps the capacity, so a query reused every frame stops allocating.
 		void Clear();
+
+		// times one of the query's buffers had to grow, stays put in steady state.
+		// only counts the query's own buffers, PrelightPipeline::GetAllocationCount sums them with it's scratch.
+		// node lists hold shared_ptrs, filling them costs refcounts, not allocations.
+		unsigned int GetAllocationCount() const;
+
+		void ResetAllocationCount();
+
+		// opaque key: shader 8 | material 16 | mesh 16 | depth 24, high bits first.
+		// transparent key: inverted depth 24 | shader 8 | material 16 | mesh 16.
+		static uint64_t GetSortKey(const RenderUnit &unit, const Vector4 &camPos, bool opaque);
+
+	protected:
+
+		struct SortItem
+		{
+			uint64_t key;
+
+			unsigned int index;
+		};
+
+		// scratch buffers of Sort, kept to avoid allocating every frame.
+		std::vector<SortItem> m_SortItems;
+
+		std::vector<SortItem> m_SortBuffer;
+
+		std::vector<RenderUnit> m_SortedUnits;
+
+		unsigned int m_AllocationCount = 0;
+
+		// see MeshRender::CreateLodView.
+		unsigned int m_LodView;
+
+		bool m_HasLodView = false;
+
+		Vector4 m_LodPosition;
+
+		float m_LodScale = 1.0f;
+
+		void AddUnit(std::vector<RenderUnit> &units, SceneNode *node, Mesh *mesh, Material *material, int subMesh);
+
+		void SortUnits(std::vector<RenderUnit> &units, const Vector4 &camPos, bool opaque);
+
+		// lsd radix sort by key, 8 bits per pass, stable.
+		void RadixSort(std::vector<SortItem> &items, std::vector<SortItem> &buffer);
 	};
 }
 
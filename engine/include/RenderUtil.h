@@ -9,6 +9,7 @@
 
 #include "ArrayBuffers.h"
 #include "Color.h"
+#include "CullingStats.h"
 #include "Singleton.h"
 #include "Signal.h"
 #include "EnumUtil.h"
@@ -57,6 +58,10 @@ namespace fury
 
 		unsigned int m_LightCount = 0;
 
+		CullingStats m_CullingStats;
+
+		float m_SortTime = 0.0f;
+
 		sf::Clock m_FrameClock;
 
 		bool m_DrawingLine = false;
@@ -119,6 +124,16 @@ namespace fury
 		void IncreaseLightCount(unsigned int count = 1);
 
 		unsigned int GetLightCount();
+
+		// sum of the frame's render queries' RenderQuery::cullingStats.
+		void IncreaseCullingStats(const CullingStats &stats);
+
+		const CullingStats &GetCullingStats();
+
+		// milliseconds spent sorting render queries this frame.
+		void IncreaseSortTime(float time);
+
+		float GetSortTime();
 	};
 }
 
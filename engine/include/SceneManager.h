@@ -1,16 +1,20 @@
 #ifndef _FURY_SCENE_MANAGER_H_
 #define _FURY_SCENE_MANAGER_H_
 
+#include <cfloat>
 #include <vector>
 #include <memory>
 #include <functional>
 
+#include "CullingStats.h"
 #include "Macros.h"
 
 namespace fury
 {
 	class Collidable;
 
+	class Ray;
+
 	class RenderQuery;
 
 	class SceneNode;
@@ -25,6 +29,27 @@ namespace fury
 
 		typedef std::function<void(const std::shared_ptr<SceneNode>&)> FilterFunc;
 
+		typedef std::vector<const Collidable*> Colliders;
+
+		// viewMask has bit i set if the scenenode is visible to colliders[i].
+		typedef std::function<void(const std::shared_ptr<SceneNode>&, unsigned int viewMask)> MultiFilterFunc;
+
+		// max colliders of one WalkSceneMulti, the multi view queries below take any count.
+		static const unsigned int MaxViews = 32;
+
+		struct RayHit
+		{
+			std::shared_ptr<SceneNode> sceneNode;
+
+			float distance;
+		};
+
+		typedef std::vector<RayHit> RayHits;
+
+		// called with a scenenode the ray enters within the max distance, and where it enters it's aabb.
+		// returns the max distance for the rest of the walk, so closest hit queries can stop early.
+		typedef std::function<float(const std::shared_ptr<SceneNode>&, float entry)> RayFunc;
+
 	public:
 
 		virtual void AddSceneNode(const std::shared_ptr<SceneNode> &sceneNode) = 0;
@@ -35,21 +60,114 @@ namespace fury
 
 		virtual void UpdateSceneNode(const std::shared_ptr<SceneNode> &sceneNode) = 0;
 
-		virtual void GetRenderQuery(const Collidable &collider, const std::shared_ptr<RenderQuery> &renderQuery) const = 0;
+		// with deferred updates, scenenodes that moved are queued,
+		// once per node, until FlushUpdates. PrelightPipeline flushes before culling,
+		// call it yourself before querying elsewhere. turning it off flushes.
+		virtual void SetDeferredUpdates(bool deferred);
+
+		bool GetDeferredUpdates() const;
+
+		// scenenodes call this when their world aabb changes.
+		void QueueUpdate(const std::shared_ptr<SceneNode> &sceneNode);
+
+		// apply queued updates.
+		virtual void FlushUpdates();
+
+		// scenenodes call this when their component flags change,
+		// for managers that keep a copy of them.
+		virtual void UpdateSceneNodeFlags(const SceneNode &sceneNode);
+
+		// with counting on, walks add their tree counters to GetWalkStats.
+		// counters aren't synchronized, don't walk one manager from several threads while counting.
+		virtual void SetWalkStatsCounting(bool enable);
+
+		bool GetWalkStatsCounting() const;
+
+		// tree counters of walks since the last ResetWalkStats.
+		virtual CullingStats GetWalkStats() const;
+
+		virtual void ResetWalkStats();
+
+		// the queries below are implemented on top of WalkScene,
+		// override them if your manager can do better.
+
+		// fills renderQuery's cullingStats, tree counters only while counting walk stats.
+		virtual void GetRenderQuery(const Collidable &collider, const std::shared_ptr<RenderQuery> &renderQuery) const;
+
+		virtual void GetVisibleSceneNodes(const Collidable &collider, SceneNodes &visibleNodes) const;
 
-		virtual void GetVisibleSceneNodes(const Collidable &collider, SceneNodes &visibleNodes) const = 0;
+		virtual void GetVisibleRenderables(const Collidable &collider, SceneNodes &renderables) const;
 
-		virtual void GetVisibleRenderables(const Collidable &collider, SceneNodes &renderables) const = 0;
+		virtual void GetVisibleShadowCasters(const Collidable &collider, SceneNodes &renderables) const;
 
-		virtual void GetVisibleShadowCasters(const Collidable &collider, SceneNodes &renderables) const = 0;
+		virtual void GetVisibleLights(const Collidable &collider, SceneNodes &lights) const;
 
-		virtual void GetVisibleLights(const Collidable &collider, SceneNodes &lights) const = 0;
+		virtual void GetVisibleRenderableAndLights(const Collidable &collider, SceneNodes &renderables, SceneNodes &lights) const;
 
-		virtual void GetVisibleRenderableAndLights(const Collidable &collider, SceneNodes &renderables, SceneNodes &lights) const = 0;
+		// multi view versions, one walk for all colliders, one result per collider.
 
-		virtual void WalkScene(const Collidable &collider, const FilterFunc &filterFunc) const = 0;
+		// the shared walk's counters go to the first query's cullingStats,
+		// so adding up all queries counts it once.
+		virtual void GetRenderQueries(const Colliders &colliders, const std::vector<std::shared_ptr<RenderQuery>> &renderQueries) const;
+
+		virtual void GetVisibleRenderables(const Colliders &colliders, std::vector<SceneNodes> &renderables) const;
+
+		virtual void GetVisibleShadowCasters(const Colliders &colliders, std::vector<SceneNodes> &renderables) const;
+
+		// nearest scenenode the ray hits within maxDistance. scenenodes whose mesh has a
+		// ray cast bvh (see Mesh::BuildRayCastBvh) are hit by their triangles, others by their aabb.
+		// infinite scenenodes are never hit.
+		bool RayCast(const Ray &ray, RayHit &hit, float maxDistance = FLT_MAX, unsigned int flags = 0) const;
+
+		// all hits within maxDistance, nearest first.
+		void RayCastAll(const Ray &ray, RayHits &hits, float maxDistance = FLT_MAX, unsigned int flags = 0) const;
+
+		// calls rayFunc with scenenodes whose aabb the ray enters, nearest entry first,
+		// skipping everything past the distance rayFunc returns. by default it's a WalkScene
+		// over the ray's aabb, sorted by entry, override it if your manager can do better.
+		virtual void WalkRay(const Ray &ray, float maxDistance, const RayFunc &rayFunc, unsigned int flags = 0) const;
+
+		// with flags, only scenenodes that have any of SceneNode::ComponentFlags are walked, 0 walks all.
+		virtual void WalkScene(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags = 0) const = 0;
+
+		// culls on ThreadUtil's workers, filterFunc is still called on the calling thread,
+		// in an order that doesn't depend on scheduling. falls back to WalkScene by default.
+		virtual void WalkSceneParallel(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags = 0) const;
+
+		// walks once for up to MaxViews colliders, each node is only tested against
+		// the colliders it's parent is visible to. falls back to a WalkScene per collider,
+		// in which case filterFunc might be called more than once per scenenode.
+		virtual void WalkSceneMulti(const Colliders &colliders, const MultiFilterFunc &filterFunc, unsigned int flags = 0) const;
 
 		virtual void Clear() = 0;
+
+	protected:
+
+		bool m_DeferredUpdates = false;
+
+		SceneNodes m_PendingUpdates;
+
+		bool m_CountWalkStats = false;
+
+		mutable CullingStats m_WalkStats;
+
+		// WalkSceneMulti for every MaxViews colliders, filterFunc gets the index of
+		// the first collider of the walk, and the view mask relative to it.
+		void WalkSceneViews(const Colliders &colliders, 
+			const std::function<void(const std::shared_ptr<SceneNode>&, unsigned int firstView, unsigned int viewMask)> &filterFunc,
+			unsigned int flags) const;
+
+		// moves queued scenenodes that are still attached to this manager to sceneNodes.
+		void TakePendingUpdates(SceneNodes &sceneNodes);
+
+		// link a sceneNode back to the manager it's attached to.
+		// index is up to the manager, ie. a slot in it's own storage.
+		static void SetSceneManager(SceneNode &sceneNode, SceneManager *manager, unsigned int index = 0);
+
+		static unsigned int GetSceneManagerIndex(const SceneNode &sceneNode);
+
+		// where the ray hits sceneNode, given it entered it's aabb at entry.
+		static bool GetRayHit(const Ray &ray, const SceneNode &sceneNode, float entry, float maxDistance, float &distance);
 	};
 }
 
@@ -5,6 +5,7 @@
 #include <typeinfo>
 #include <vector>
 
+#include "AffineMatrix.h"
 #include "BoxBounds.h"
 #include "Entity.h"
 #include "Quaternion.h"
@@ -18,42 +19,106 @@ namespace fury
 
 	class OcTreeNode;
 
+	class SceneManager;
+
+	class TransformSystem;
+
 	// To destory a scenenode.
 	// Call node.RemoveFromParent + node.RemoveFromOcTree(true) + node.reset.
 	// This node together with all it's childs will be destoried.
 	class FURY_API SceneNode : public Entity, public std::enable_shared_from_this<SceneNode>
 	{
+		friend class OcTree;
+
 		friend class OcTreeNode;
 
+		friend class SceneManager;
+
+		friend class TransformSystem;
+
 	public:
 
 		typedef std::shared_ptr<SceneNode> Ptr;
 
 		static Ptr Create(const std::string &name);
 
+		// what this node's components are, cached so culling can filter without looking them up.
+		enum ComponentFlags : unsigned int
+		{
+			LIGHT			= 0x0001,
+			// a light that casts shadows.
+			SHADOW_LIGHT	= 0x0002,
+			RENDERABLE		= 0x0004,
+			// a renderable whose mesh casts shadows.
+			SHADOW_CASTER	= 0x0008,
+			// a renderable with a non opaque material.
+			TRANSLUCENT		= 0x0010,
+			OCCLUDER		= 0x0020,
+			CAMERA			= 0x0040
+		};
+
 	protected:
 
 		std::weak_ptr<OcTreeNode> m_OcTreeNode;
 
+		// scene manager this node is attached to.
+		SceneManager *m_SceneManager = nullptr;
+
+		// manager specific index, ie. a slot in manager's storage.
+		unsigned int m_SceneManagerIndex = 0;
+
+		// if it's in the manager's pending updates.
+		bool m_UpdateQueued = false;
+
+		bool m_Static = false;
+
+		// transform system this node is a handle into, see TransformSystem.
+		// while it's set, the transform members below aren't used.
+		TransformSystem *m_TransformSystem = nullptr;
+
+		unsigned int m_TransformIndex = 0;
+
 		std::weak_ptr<SceneNode> m_Parent;
 
 		std::vector<Ptr> m_Childs;
 
 		std::unordered_map<std::type_index, std::shared_ptr<Component>> m_Components;
 
+		mutable unsigned int m_ComponentFlags = 0;
+
+		mutable unsigned int m_ComponentFlagsVersion = 0;
+
+		// bumped when a shared mesh or material changes.
+		static unsigned int m_SharedFlagsVersion;
+
 		BoxBounds m_ModelAABB;
 
-		BoxBounds m_LocalAABB;
+		// what's derived from local trs is computed when it's asked for,
+		// inverse matrices only by their own getters.
+
+		mutable BoxBounds m_LocalAABB;
+
+		mutable BoxBounds m_WorldAABB;
 
-		BoxBounds m_WorldAABB;
+		// local trs changed, local matrix is out of date.
+		mutable bool m_TransformDirty;
 
-		bool m_TransformDirty;
+		// world matrix, trs and aabbs are out of date, so are all the childs'.
+		mutable bool m_WorldDirty = true;
 
-		Vector4 m_WorldPosition;
+		mutable bool m_InvertWorldDirty = true;
 
-		Vector4 m_WorldScale;
+		// OnTransformChange is pending, it's emitted by the next Recompose.
+		bool m_TransformChanged = true;
 
-		Quaternion m_WorldRotation;
+		// a descendant has a pending OnTransformChange.
+		bool m_ChildChanged = false;
+
+		mutable Vector4 m_WorldPosition;
+
+		mutable Vector4 m_WorldScale;
+
+		mutable Quaternion m_WorldRotation;
 
 		Vector4 m_LocalPosition;
 
@@ -61,13 +126,12 @@ namespace fury
 
 		Quaternion m_LocalRotation;
 
-		Matrix4 m_LocalMatrix;
+		// affine, converted to Matrix4 by the getters.
+		mutable AffineMatrix m_LocalMatrix;
 
-		Matrix4 m_InvertLocalMatrix;
+		mutable AffineMatrix m_WorldMatrix;
 
-		Matrix4 m_WorldMatrix;
-
-		Matrix4 m_InvertWorldMatrix;
+		mutable AffineMatrix m_InvertWorldMatrix;
 
 	public:
 
@@ -80,10 +144,22 @@ namespace fury
 		// copies components and translations.
 		Ptr Clone(const std::string &name) const;
 
-		// remove this sceneNode from attached ocTree.
+		// remove this sceneNode from attached ocTree (or any other scene manager).
 		// set recursively to true will call this on child nodes.
 		void RemoveFromOcTree(bool recursively = false);
 
+		// the scene manager this node is attached to, nullptr if none.
+		SceneManager *GetSceneManager() const;
+
+		// a hint that this node never moves, see SplitSceneManager.
+		// managers read it when the node is added, add it again after changing it.
+		void SetStatic(bool value);
+
+		bool GetStatic() const;
+
+		// the transform system this node is attached to, nullptr if none.
+		TransformSystem *GetTransformSystem() const;
+
 		void SetModelAABB(const BoxBounds &aabb);
 
 		BoxBounds GetModelAABB() const;
@@ -96,6 +172,10 @@ namespace fury
 		// Transforms
 		//////////////////////////////////
 
+		// transform setters only mark this node and it's childs dirty, getters compute what they return.
+		// Recompose updates the scene manager and emits OnTransformChange of this node and it's descendants
+		// that changed since the last one, force marks them all changed first.
+		// attached to a TransformSystem, this only marks the node dirty for it's next Update.
 		void Recompose(bool force = false);
 
 		Matrix4 GetLocalMatrix() const;
@@ -106,6 +186,9 @@ namespace fury
 
 		Matrix4 GetInvertWorldMatrix() const;
 
+		// world matrix without the constant last row, cheaper to multiply.
+		AffineMatrix GetAffineWorldMatrix() const;
+
 		Vector4 GetWorldPosition() const;
 
 		Quaternion GetWorldRoattion() const;
@@ -190,11 +273,31 @@ namespace fury
 
 		void RemoveAllComponents(bool destructing = false);
 
+		unsigned int GetComponentFlags() const;
+
+		// components call this when what they are changes.
+		void UpdateComponentFlags();
+
+		// meshes and materials are shared, when one of them changes
+		// all nodes refresh their flags the next time they're asked.
+		static void InvalidateComponentFlags();
+
+		static unsigned int GetComponentFlagsVersion();
+
 	protected:
 
 		void SetOcTreeNode(const std::shared_ptr<OcTreeNode> &ocTreeNode);
 
 		void SetParent(const Ptr &parent);
+
+		// world transform of this subtree changed.
+		void MarkDirty();
+
+		void MarkSubTreeDirty();
+
+		void UpdateLocalMatrix() const;
+
+		void UpdateWorldTransform() const;
 	};
 
 	template<class ComponentType>
@@ -89,10 +89,16 @@ namespace fury
 
 		void BindMaterial(const std::shared_ptr<Material> &material);
 
+		void BindMaterial(const Material *material);
+
 		void BindMesh(const std::shared_ptr<Mesh> &mesh);
 
+		void BindMesh(Mesh *mesh);
+
 		void BindSubMesh(const std::shared_ptr<Mesh> &mesh, unsigned int index);
 
+		void BindSubMesh(Mesh *mesh, unsigned int index);
+
 		void BindMatrix(const std::string &name, const Matrix4 &matrix);
 
 		void BindMatrix(const std::string &name, const float *raw);
@@ -133,7 +139,7 @@ namespace fury
 
 	protected:
 
-		void BindMeshData(const std::shared_ptr<Mesh> &mesh);
+		void BindMeshData(Mesh *mesh);
 
 		int GetUniformLocation(const std::string &name) const;
 
@@ -144,4 +150,4 @@ namespace fury
 	};
 }
 
-#endif // _FURY_SHADER_H_
\ No newline at end of file
+#endif // _FURY_SHADER_H_
\ No newline at end of file
@@ -0,0 +1,92 @@
+#ifndef _FURY_SPLIT_SCENE_MANAGER_H_
+#define _FURY_SPLIT_SCENE_MANAGER_H_
+
+#include <memory>
+#include <typeindex>
+
+#include "SceneManager.h"
+
+namespace fury
+{
+	class BvhSceneManager;
+
+	/**
+	 *	Keeps static scenenodes (SceneNode::GetStatic) apart from moving ones.
+	 *
+	 *	Static scenenodes go to a BvhSceneManager that's built once, call Freeze
+	 *	after loading to build it up front. The rest go to the dynamic manager,
+	 *	so their churn never touches the static half. Queries walk both halves.
+	 *
+	 *	Scenenodes are attached to the half that holds them,
+	 *	so their GetSceneManager is that half, not this manager.
+	 */
+	class FURY_API SplitSceneManager : public SceneManager
+	{
+	public:
+
+		typedef std::shared_ptr<SplitSceneManager> Ptr;
+
+		static Ptr Create(const std::shared_ptr<SceneManager> &dynamicManager);
+
+	protected:
+
+		std::type_index m_TypeIndex;
+
+		std::shared_ptr<BvhSceneManager> m_StaticManager;
+
+		std::shared_ptr<SceneManager> m_DynamicManager;
+
+	public:
+
+		SplitSceneManager(const std::shared_ptr<SceneManager> &dynamicManager);
+
+		virtual ~SplitSceneManager();
+
+		virtual std::type_index GetTypeIndex() const;
+
+		virtual void AddSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void AddSceneNodeRecursively(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void RemoveSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void UpdateSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		virtual void SetDeferredUpdates(bool deferred);
+
+		virtual void FlushUpdates();
+
+		// walks happen in the halves, their counters are summed.
+		virtual void SetWalkStatsCounting(bool enable);
+
+		virtual CullingStats GetWalkStats() const;
+
+		virtual void ResetWalkStats();
+
+		virtual void WalkScene(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags = 0) const;
+
+		virtual void WalkSceneParallel(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags = 0) const;
+
+		virtual void WalkSceneMulti(const Colliders &colliders, const MultiFilterFunc &filterFunc, unsigned int flags = 0) const;
+
+		// static half first, then the dynamic half up to the distance it left off,
+		// so scenenodes are nearest first within each half only.
+		virtual void WalkRay(const Ray &ray, float maxDistance, const RayFunc &rayFunc, unsigned int flags = 0) const;
+
+		virtual void Clear();
+
+		// build the static half now instead of on the first query.
+		void Freeze();
+
+		std::shared_ptr<BvhSceneManager> GetStaticManager() const;
+
+		std::shared_ptr<SceneManager> GetDynamicManager() const;
+
+	protected:
+
+		// if sceneNode is attached to one of the halves.
+		bool Holds(const SceneNode &sceneNode) const;
+	};
+}
+
+#endif // _FURY_SPLIT_SCENE_MANAGER_H_
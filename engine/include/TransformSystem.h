@@ -0,0 +1,181 @@
+#ifndef _FURY_TRANSFORM_SYSTEM_H_
+#define _FURY_TRANSFORM_SYSTEM_H_
+
+#include <memory>
+#include <vector>
+
+#include "AffineMatrix.h"
+#include "BoxBounds.h"
+#include "BoxBoundsArray.h"
+#include "Quaternion.h"
+#include "Vector4.h"
+
+namespace fury
+{
+	class SceneNode;
+
+	/**
+	 *	Optional storage for the transforms of whole scenenode hierarchies.
+	 *
+	 *	Local trs, matrices and world aabbs of attached scenenodes live in arrays,
+	 *	sorted so a parent always comes before it's childs, and each subtree is a contiguous range.
+	 *	Update recomputes every dirty entry and it's descendants in one linear pass over them,
+	 *	instead of recursive Recompose calls chasing parent and child pointers.
+	 *
+	 *	An attached scenenode is a handle into the system, it's transform setters
+	 *	and getters read and write the arrays. Recompose only marks it dirty,
+	 *	world matrices, aabbs and OnTransformChange are updated by the next Update.
+	 *
+	 *	Attaching a scenenode attaches all it's childs, and childs added later.
+	 *	If it's parent isn't attached, it's world matrix is read from the parent when it's updated.
+	 *	Hierarchy changes are applied by re-sorting the arrays in the next Update.
+	 *
+	 *	UpdateParallel splits the arrays into runs of whole root subtrees, updated on ThreadUtil's workers,
+	 *	made for scenes of many independent hierarchies. a single large hierarchy is updated by one worker.
+	 */
+	class FURY_API TransformSystem
+	{
+		friend class SceneNode;
+
+	public:
+
+		typedef std::shared_ptr<TransformSystem> Ptr;
+
+		static Ptr Create();
+
+		static const unsigned int InvalidIndex;
+
+	protected:
+
+		// a run of whole root subtrees, updated by one worker.
+		struct UpdateTask
+		{
+			unsigned int begin, end;
+
+			std::vector<unsigned int> changed;
+		};
+
+		std::vector<SceneNode*> m_SceneNodes;
+
+		// index of each entry's parent, InvalidIndex for roots.
+		std::vector<unsigned int> m_Parents;
+
+		std::vector<Vector4> m_LocalPositions;
+
+		std::vector<Quaternion> m_LocalRotations;
+
+		std::vector<Vector4> m_LocalScales;
+
+		std::vector<AffineMatrix> m_LocalMatrices;
+
+		std::vector<AffineMatrix> m_WorldMatrices;
+
+		// computed when they're asked for.
+		mutable std::vector<AffineMatrix> m_InvertWorldMatrices;
+
+		mutable std::vector<unsigned char> m_InvertWorldDirty;
+
+		std::vector<BoxBounds> m_ModelAABBs;
+
+		BoxBoundsArray m_WorldAABBs;
+
+		// local trs changed since the last Update.
+		std::vector<unsigned char> m_Dirty;
+
+		// recomputed by the current Update, read by descendants during it.
+		std::vector<unsigned char> m_Changed;
+
+		// notified after the pass, held so callbacks can't destroy them under us.
+		std::vector<std::shared_ptr<SceneNode>> m_ChangedNodes;
+
+		// first entry of each root subtree.
+		std::vector<unsigned int> m_RootIndices;
+
+		// reused by Update and UpdateParallel.
+		std::vector<UpdateTask> m_UpdateTasks;
+
+		unsigned int m_ParallelThreshold = 4096;
+
+		unsigned int m_ChangedCount = 0;
+
+		unsigned int m_DirtyCount = 0;
+
+		// hierarchy changed, entries are re-sorted in the next Update.
+		bool m_OrderDirty = false;
+
+	public:
+
+		TransformSystem() {}
+
+		virtual ~TransformSystem();
+
+		// attach sceneNode and all it's childs, detaching them from any other system.
+		void AddSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		// detach sceneNode and all it's childs, they keep their last updated transforms.
+		// pending changes are left to their parent's Recompose, or recomposed right away if it stays attached.
+		void RemoveSceneNode(const std::shared_ptr<SceneNode> &sceneNode);
+
+		// recompute dirty entries and their descendants, then emit OnTransformChange
+		// and update scene managers of the ones that changed, parents first.
+		// detached childs of changed entries are marked dirty and recomposed after their parent.
+		void Update();
+
+		// same as Update, but entries are recomputed on ThreadUtil's workers.
+		// scene manager updates and OnTransformChange still run on the calling thread, in Update's order.
+		// falls back to Update for fewer scenenodes than the parallel threshold, or if it's not called on the main thread.
+		void UpdateParallel();
+
+		void SetParallelThreshold(unsigned int sceneNodeCount);
+
+		unsigned int GetParallelThreshold() const;
+
+		// detach all scenenodes.
+		void Clear();
+
+		unsigned int GetSceneNodeCount() const;
+
+		// entries recomputed by the last Update.
+		unsigned int GetChangedCount() const;
+
+		// world aabbs of all entries in update order, for batch culling.
+		const BoxBoundsArray &GetWorldAABBs() const;
+
+		const AffineMatrix &GetInvertWorldMatrix(unsigned int index) const;
+
+	protected:
+
+		void Attach(SceneNode &sceneNode);
+
+		// removes one entry, childs stay attached as roots.
+		void Detach(SceneNode &sceneNode);
+
+		// sceneNode's parent changed.
+		void Reparent(SceneNode &sceneNode);
+
+		void SetDirty(unsigned int index);
+
+		void SetLocalPosition(unsigned int index, Vector4 position);
+
+		void SetLocalRotation(unsigned int index, Quaternion rotation);
+
+		void SetLocalScale(unsigned int index, Vector4 scale);
+
+		void SetModelAABB(unsigned int index, const BoxBounds &aabb);
+
+		// preorder of all hierarchies, parents before childs.
+		void Sort();
+
+		void SortSubTree(SceneNode &sceneNode, unsigned int parent, std::vector<unsigned int> &order, std::vector<unsigned int> &parents) const;
+
+		// entries of task's range, which only reference parents inside it.
+		void UpdateRange(UpdateTask &task);
+
+		// notify what taskCount tasks changed.
+		void EndUpdate(unsigned int taskCount);
+
+		void UpdateEntry(unsigned int index);
+	};
+}
+
+#endif // _FURY_TRANSFORM_SYSTEM_H_
\ No newline at end of file
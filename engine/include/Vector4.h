@@ -1,15 +1,24 @@
 #ifndef _FURY_VECTOR4_H_
 #define _FURY_VECTOR4_H_
 
+#include <cmath>
+
 #include "Macros.h"
 
+#if defined(FURY_USE_SSE)
+#include <emmintrin.h>
+#endif
+
 namespace fury
 {
 	/**
 	 *	When you need a Vector4 with special w.
 	 *	Call Vector4(yourVector, yourW) to create one to make sure it's w is correct.
+	 *
+	 *	FURY_ALIGN16 keeps it on one cache line where the compiler supports it.
+	 *	hot operators are inline below, the rest lives in Vector4.cpp.
 	 */
-	class FURY_API Vector4
+	class FURY_API FURY_ALIGN16 Vector4
 	{
 	public:
 
@@ -97,6 +106,194 @@ namespace fury
 		Vector4 operator / (const float other) const;
 		
 	};
+
+	inline float Vector4::Length() const
+	{
+		return std::sqrt(SquareLength());
+	}
+
+	inline float Vector4::SquareLength() const
+	{
+		return *this * *this;
+	}
+
+	inline Vector4 Vector4::CrossProduct(Vector4 other) const
+	{
+#if defined(FURY_USE_SSE)
+		__m128 a = _mm_loadu_ps(&x);
+		__m128 b = _mm_loadu_ps(&other.x);
+		__m128 ayzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 azxy = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+		__m128 byzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 bzxy = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+
+		Vector4 output;
+		_mm_storeu_ps(&output.x, _mm_sub_ps(_mm_mul_ps(ayzx, bzxy), _mm_mul_ps(azxy, byzx)));
+		output.w = 1.0f;
+		return output;
+#else
+		return Vector4(
+			y * other.z - z * other.y, 
+			z * other.x - x * other.z, 
+			x * other.y - y * other.x, 
+			1.0f
+		);
+#endif
+	}
+
+#if defined(FURY_USE_SSE)
+	// xyz lanes of a compare mask, w is ignored like the scalar operators.
+	#define FURY_VECTOR4_CMP(cmp, a, b) (_mm_movemask_ps(cmp(_mm_loadu_ps(&(a).x), _mm_loadu_ps(&(b).x))) & 7)
+
+	inline bool Vector4::operator == (Vector4 other) const
+	{
+		return FURY_VECTOR4_CMP(_mm_cmpeq_ps, *this, other) == 7;
+	}
+
+	inline bool Vector4::operator != (Vector4 other) const
+	{
+		return FURY_VECTOR4_CMP(_mm_cmpneq_ps, *this, other) != 0;
+	}
+
+	inline bool Vector4::operator < (Vector4 other) const
+	{
+		return FURY_VECTOR4_CMP(_mm_cmplt_ps, *this, other) == 7;
+	}
+
+	inline bool Vector4::operator <= (Vector4 other) const
+	{
+		return FURY_VECTOR4_CMP(_mm_cmple_ps, *this, other) == 7;
+	}
+
+	inline bool Vector4::operator > (Vector4 other) const
+	{
+		return FURY_VECTOR4_CMP(_mm_cmpgt_ps, *this, other) == 7;
+	}
+
+	inline bool Vector4::operator >= (Vector4 other) const
+	{
+		return FURY_VECTOR4_CMP(_mm_cmpge_ps, *this, other) == 7;
+	}
+
+	#undef FURY_VECTOR4_CMP
+#else
+	inline bool Vector4::operator == (Vector4 other) const 
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+	
+	inline bool Vector4::operator != (Vector4 other) const 
+	{
+		return x != other.x || y != other.y || z != other.z;
+	}
+
+	inline bool Vector4::operator < (Vector4 other) const
+	{
+		return x < other.x && y < other.y && z < other.z;
+	}
+
+	inline bool Vector4::operator <= (Vector4 other) const
+	{
+		return x <= other.x && y <= other.y && z <= other.z;
+	}
+
+	inline bool Vector4::operator > (Vector4 other) const
+	{
+		return x > other.x && y > other.y && z > other.z;
+	}
+
+	inline bool Vector4::operator >= (Vector4 other) const
+	{
+		return x >= other.x && y >= other.y && z >= other.z;
+	}
+#endif
+
+	inline Vector4 &Vector4::operator = (Vector4 other) 
+	{
+		x = other.x; y = other.y; z = other.z;
+		return *this;
+	}
+
+#if defined(FURY_USE_SSE)
+	inline Vector4 Vector4::operator - () const 
+	{
+		Vector4 output;
+		_mm_storeu_ps(&output.x, _mm_xor_ps(_mm_loadu_ps(&x), _mm_set1_ps(-0.0f)));
+		output.w = 1.0f;
+		return output;
+	}
+	
+	inline Vector4 Vector4::operator + (Vector4 other) const 
+	{
+		Vector4 output;
+		_mm_storeu_ps(&output.x, _mm_add_ps(_mm_loadu_ps(&x), _mm_loadu_ps(&other.x)));
+		output.w = 1.0f;
+		return output;
+	}
+	
+	inline Vector4 Vector4::operator - (Vector4 other) const 
+	{
+		Vector4 output;
+		_mm_storeu_ps(&output.x, _mm_sub_ps(_mm_loadu_ps(&x), _mm_loadu_ps(&other.x)));
+		output.w = 1.0f;
+		return output;
+	}
+
+	inline float Vector4::operator * (Vector4 other) const 
+	{
+		// same summation order as the scalar path, (x + y) + z.
+		__m128 product = _mm_mul_ps(_mm_loadu_ps(&x), _mm_loadu_ps(&other.x));
+		__m128 sum = _mm_add_ss(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1)));
+		return _mm_cvtss_f32(_mm_add_ss(sum, _mm_movehl_ps(product, product)));
+	}
+	
+	inline Vector4 Vector4::operator * (const float other) const
+	{
+		Vector4 output;
+		_mm_storeu_ps(&output.x, _mm_mul_ps(_mm_loadu_ps(&x), _mm_set1_ps(other)));
+		output.w = 1.0f;
+		return output;
+	}
+
+	inline Vector4 Vector4::operator / (const float other) const 
+	{
+		Vector4 output;
+		_mm_storeu_ps(&output.x, _mm_mul_ps(_mm_loadu_ps(&x), _mm_set1_ps(1.0f / other)));
+		output.w = 1.0f;
+		return output;
+	}
+#else
+	inline Vector4 Vector4::operator - () const 
+	{
+		return Vector4(-x, -y, -z, 1.0f);
+	}
+	
+	inline Vector4 Vector4::operator + (Vector4 other) const 
+	{
+		return Vector4(x + other.x, y + other.y, z + other.z, 1.0f);
+	}
+	
+	inline Vector4 Vector4::operator - (Vector4 other) const 
+	{
+		return Vector4(x - other.x, y - other.y, z - other.z, 1.0f);
+	}
+
+	inline float Vector4::operator * (Vector4 other) const 
+	{
+		return x * other.x + y * other.y + z * other.z;
+	}
+	
+	inline Vector4 Vector4::operator * (const float other) const
+	{
+		return Vector4(x * other, y * other, z * other, 1.0f);
+	}
+
+	inline Vector4 Vector4::operator / (const float other) const 
+	{
+		float i = 1.0f / other;
+		return Vector4(x * i, y * i, z * i, 1.0f);
+	}
+#endif
 }
 
 #endif // _FURY_VECTOR4_H_
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "AffineMatrix.h"
+#include "BoxBounds.h"
+#include "MathUtil.h"
+#include "Quaternion.h"
+
+namespace fury
+{
+	void AffineMatrix::TRS(Vector4 position, Quaternion rotation, Vector4 scale)
+	{
+		float ww = 2.0f * rotation.w;
+		float xx = 2.0f * rotation.x;
+		float yy = 2.0f * rotation.y;
+		float zz = 2.0f * rotation.z;
+
+		Raw[0] = (1.0f - yy * rotation.y - zz * rotation.z) * scale.x;
+		Raw[1] = (xx * rotation.y - ww * rotation.z) * scale.y;
+		Raw[2] = (xx * rotation.z + ww * rotation.y) * scale.z;
+		Raw[3] = position.x;
+
+		Raw[4] = (xx * rotation.y + ww * rotation.z) * scale.x;
+		Raw[5] = (1.0f - xx * rotation.x - zz * rotation.z) * scale.y;
+		Raw[6] = (yy * rotation.z - ww * rotation.x) * scale.z;
+		Raw[7] = position.y;
+
+		Raw[8] = (xx * rotation.z - ww * rotation.y) * scale.x;
+		Raw[9] = (yy * rotation.z + ww * rotation.x) * scale.y;
+		Raw[10] = (1.0f - xx * rotation.x - yy * rotation.y) * scale.z;
+		Raw[11] = position.z;
+	}
+
+	void AffineMatrix::InverseTRS(Vector4 position, Quaternion rotation, Vector4 scale)
+	{
+		if (scale.x == 0.0f || scale.y == 0.0f || scale.z == 0.0f)
+		{
+			Identity();
+			return;
+		}
+
+		float ww = 2.0f * rotation.w;
+		float xx = 2.0f * rotation.x;
+		float yy = 2.0f * rotation.y;
+		float zz = 2.0f * rotation.z;
+
+		// (T * R * S)^-1 = S^-1 * R^t * -T, row i is rotation's column i over scale i.
+		float ix = 1.0f / scale.x;
+		float iy = 1.0f / scale.y;
+		float iz = 1.0f / scale.z;
+
+		Raw[0] = (1.0f - yy * rotation.y - zz * rotation.z) * ix;
+		Raw[1] = (xx * rotation.y + ww * rotation.z) * ix;
+		Raw[2] = (xx * rotation.z - ww * rotation.y) * ix;
+
+		Raw[4] = (xx * rotation.y - ww * rotation.z) * iy;
+		Raw[5] = (1.0f - xx * rotation.x - zz * rotation.z) * iy;
+		Raw[6] = (yy * rotation.z + ww * rotation.x) * iy;
+
+		Raw[8] = (xx * rotation.z + ww * rotation.y) * iz;
+		Raw[9] = (yy * rotation.z - ww * rotation.x) * iz;
+		Raw[10] = (1.0f - xx * rotation.x - yy * rotation.y) * iz;
+
+		Raw[3] = -(position.x * Raw[0] + position.y * Raw[1] + position.z * Raw[2]);
+		Raw[7] = -(position.x * Raw[4] + position.y * Raw[5] + position.z * Raw[6]);
+		Raw[11] = -(position.x * Raw[8] + position.y * Raw[9] + position.z * Raw[10]);
+	}
+
+	AffineMatrix AffineMatrix::InverseAffine() const
+	{
+		AffineMatrix output;
+
+#if defined(FURY_USE_SSE)
+		// columns of the inverted 3x3 are the cross products of it's rows, over the determinant.
+		__m128 r0 = _mm_loadu_ps(Raw);
+		__m128 r1 = _mm_loadu_ps(Raw + 4);
+		__m128 r2 = _mm_loadu_ps(Raw + 8);
+
+		__m128 r0yzx = _mm_shuffle_ps(r0, r0, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 r0zxy = _mm_shuffle_ps(r0, r0, _MM_SHUFFLE(3, 1, 0, 2));
+		__m128 r1yzx = _mm_shuffle_ps(r1, r1, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 r1zxy = _mm_shuffle_ps(r1, r1, _MM_SHUFFLE(3, 1, 0, 2));
+		__m128 r2yzx = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 r2zxy = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 1, 0, 2));
+
+		__m128 c0 = _mm_sub_ps(_mm_mul_ps(r1yzx, r2zxy), _mm_mul_ps(r1zxy, r2yzx));
+		__m128 c1 = _mm_sub_ps(_mm_mul_ps(r2yzx, r0zxy), _mm_mul_ps(r2zxy, r0yzx));
+		__m128 c2 = _mm_sub_ps(_mm_mul_ps(r0yzx, r1zxy), _mm_mul_ps(r0zxy, r1yzx));
+
+		__m128 dot = _mm_mul_ps(r0, c0);
+		float det = _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(1, 1, 1, 1))), _mm_movehl_ps(dot, dot)));
+		if (det != 0)
+		{
+			__m128 det2 = _mm_set1_ps(1.0f / det);
+			c0 = _mm_mul_ps(c0, det2);
+			c1 = _mm_mul_ps(c1, det2);
+			c2 = _mm_mul_ps(c2, det2);
+
+			__m128 t = _mm_mul_ps(c0, _mm_shuffle_ps(r0, r0, _MM_SHUFFLE(3, 3, 3, 3)));
+			t = _mm_add_ps(t, _mm_mul_ps(c1, _mm_shuffle_ps(r1, r1, _MM_SHUFFLE(3, 3, 3, 3))));
+			t = _mm_add_ps(t, _mm_mul_ps(c2, _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 3, 3, 3))));
+			t = _mm_xor_ps(t, _mm_set1_ps(-0.0f));
+
+			// back to rows, the translation becomes the w lanes.
+			_MM_TRANSPOSE4_PS(c0, c1, c2, t);
+			_mm_storeu_ps(output.Raw, c0);
+			_mm_storeu_ps(output.Raw + 4, c1);
+			_mm_storeu_ps(output.Raw + 8, c2);
+		}
+#else
+		float det = Raw[0] * (Raw[5] * Raw[10] - Raw[6] * Raw[9])
+					+ Raw[1] * (Raw[6] * Raw[8] - Raw[4] * Raw[10])
+					+ Raw[2] * (Raw[4] * Raw[9] - Raw[5] * Raw[8]);
+		if (det != 0)
+		{
+			float det2 = 1.0f / det;
+			output.Raw[0] = (Raw[5] * Raw[10] - Raw[6] * Raw[9]) * det2;
+			output.Raw[1] = (Raw[9] * Raw[2] - Raw[10] * Raw[1]) * det2;
+			output.Raw[2] = (Raw[1] * Raw[6] - Raw[2] * Raw[5]) * det2;
+			output.Raw[4] = (Raw[6] * Raw[8] - Raw[4] * Raw[10]) * det2;
+			output.Raw[5] = (Raw[10] * Raw[0] - Raw[8] * Raw[2]) * det2;
+			output.Raw[6] = (Raw[2] * Raw[4] - Raw[0] * Raw[6]) * det2;
+			output.Raw[8] = (Raw[4] * Raw[9] - Raw[5] * Raw[8]) * det2;
+			output.Raw[9] = (Raw[8] * Raw[1] - Raw[9] * Raw[0]) * det2;
+			output.Raw[10] = (Raw[0] * Raw[5] - Raw[1] * Raw[4]) * det2;
+			output.Raw[3] = -(output.Raw[0] * Raw[3] + output.Raw[1] * Raw[7] + output.Raw[2] * Raw[11]);
+			output.Raw[7] = -(output.Raw[4] * Raw[3] + output.Raw[5] * Raw[7] + output.Raw[6] * Raw[11]);
+			output.Raw[11] = -(output.Raw[8] * Raw[3] + output.Raw[9] * Raw[7] + output.Raw[10] * Raw[11]);
+		}
+#endif
+
+		return output;
+	}
+
+	Quaternion AffineMatrix::Multiply(Quaternion data) const
+	{
+		Vector4 axis = MathUtil::QuatToAxisRad(data);
+		float radian = axis.w;
+		axis.w = 0.0f;
+
+		axis = Multiply(axis);
+
+		return MathUtil::AxisRadToQuat(axis, radian);
+	}
+
+	BoxBounds AffineMatrix::Multiply(const BoxBounds &aabb) const
+	{
+		// arvo's method, see Matrix4::Multiply(const BoxBounds &).
+		Vector4 min = aabb.GetMin();
+		Vector4 max = aabb.GetMax();
+
+#if defined(FURY_USE_SSE)
+		__m128 c0 = _mm_loadu_ps(Raw);
+		__m128 c1 = _mm_loadu_ps(Raw + 4);
+		__m128 c2 = _mm_loadu_ps(Raw + 8);
+		__m128 c3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+		__m128 vMin = _mm_loadu_ps(&min.x);
+		__m128 vMax = _mm_loadu_ps(&max.x);
+		__m128 newMin = c3;
+		__m128 newMax = c3;
+
+		__m128 a = _mm_mul_ps(c0, _mm_shuffle_ps(vMin, vMin, _MM_SHUFFLE(0, 0, 0, 0)));
+		__m128 b = _mm_mul_ps(c0, _mm_shuffle_ps(vMax, vMax, _MM_SHUFFLE(0, 0, 0, 0)));
+		newMin = _mm_add_ps(newMin, _mm_min_ps(a, b));
+		newMax = _mm_add_ps(newMax, _mm_max_ps(a, b));
+
+		a = _mm_mul_ps(c1, _mm_shuffle_ps(vMin, vMin, _MM_SHUFFLE(1, 1, 1, 1)));
+		b = _mm_mul_ps(c1, _mm_shuffle_ps(vMax, vMax, _MM_SHUFFLE(1, 1, 1, 1)));
+		newMin = _mm_add_ps(newMin, _mm_min_ps(a, b));
+		newMax = _mm_add_ps(newMax, _mm_max_ps(a, b));
+
+		a = _mm_mul_ps(c2, _mm_shuffle_ps(vMin, vMin, _MM_SHUFFLE(2, 2, 2, 2)));
+		b = _mm_mul_ps(c2, _mm_shuffle_ps(vMax, vMax, _MM_SHUFFLE(2, 2, 2, 2)));
+		newMin = _mm_add_ps(newMin, _mm_min_ps(a, b));
+		newMax = _mm_add_ps(newMax, _mm_max_ps(a, b));
+
+		_mm_storeu_ps(&min.x, newMin);
+		_mm_storeu_ps(&max.x, newMax);
+		min.w = max.w = 1.0f;
+#else
+		float newMin[3] = { Raw[3], Raw[7], Raw[11] };
+		float newMax[3] = { Raw[3], Raw[7], Raw[11] };
+		const float vMin[3] = { min.x, min.y, min.z };
+		const float vMax[3] = { max.x, max.y, max.z };
+
+		for (int i = 0; i < 3; i++)
+		{
+			for (int j = 0; j < 3; j++)
+			{
+				float a = Raw[i * 4 + j] * vMin[j];
+				float b = Raw[i * 4 + j] * vMax[j];
+				newMin[i] += a < b ? a : b;
+				newMax[i] += a < b ? b : a;
+			}
+		}
+
+		min = Vector4(newMin[0], newMin[1], newMin[2], 1.0f);
+		max = Vector4(newMax[0], newMax[1], newMax[2], 1.0f);
+#endif
+
+		return BoxBounds(min, max);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "BoxBounds.h"
+#include "BoxBoundsArray.h"
+
+namespace fury
+{
+	const float BoxBoundsArray::InfiniteExtents = 1e30f;
+
+	unsigned int BoxBoundsArray::GetSize() const
+	{
+		return CenterX.size();
+	}
+
+	void BoxBoundsArray::Reserve(unsigned int size)
+	{
+		CenterX.reserve(size);
+		CenterY.reserve(size);
+		CenterZ.reserve(size);
+		ExtentsX.reserve(size);
+		ExtentsY.reserve(size);
+		ExtentsZ.reserve(size);
+	}
+
+	void BoxBoundsArray::Clear()
+	{
+		CenterX.clear();
+		CenterY.clear();
+		CenterZ.clear();
+		ExtentsX.clear();
+		ExtentsY.clear();
+		ExtentsZ.clear();
+	}
+
+	void BoxBoundsArray::Add(const BoxBounds &aabb)
+	{
+		CenterX.push_back(0.0f);
+		CenterY.push_back(0.0f);
+		CenterZ.push_back(0.0f);
+		ExtentsX.push_back(0.0f);
+		ExtentsY.push_back(0.0f);
+		ExtentsZ.push_back(0.0f);
+
+		Set(CenterX.size() - 1, aabb);
+	}
+
+	void BoxBoundsArray::Set(unsigned int index, const BoxBounds &aabb)
+	{
+		if (aabb.GetInfinite())
+		{
+			CenterX[index] = CenterY[index] = CenterZ[index] = 0.0f;
+			ExtentsX[index] = ExtentsY[index] = ExtentsZ[index] = InfiniteExtents;
+		}
+		else
+		{
+			Vector4 center = aabb.GetCenter();
+			Vector4 extents = aabb.GetExtents();
+
+			CenterX[index] = center.x;
+			CenterY[index] = center.y;
+			CenterZ[index] = center.z;
+			ExtentsX[index] = extents.x;
+			ExtentsY[index] = extents.y;
+			ExtentsZ[index] = extents.z;
+		}
+	}
+
+	BoxBounds BoxBoundsArray::GetAt(unsigned int index) const
+	{
+		if (ExtentsX[index] == InfiniteExtents)
+		{
+			BoxBounds aabb;
+			aabb.SetInfinite(true);
+			return aabb;
+		}
+
+		Vector4 center(CenterX[index], CenterY[index], CenterZ[index]);
+		Vector4 extents(ExtentsX[index], ExtentsY[index], ExtentsZ[index]);
+		return BoxBounds(center - extents, center + extents);
+	}
+
+	void BoxBoundsArray::EraseAt(unsigned int index)
+	{
+		CenterX.erase(CenterX.begin() + index);
+		CenterY.erase(CenterY.begin() + index);
+		CenterZ.erase(CenterZ.begin() + index);
+		ExtentsX.erase(ExtentsX.begin() + index);
+		ExtentsY.erase(ExtentsY.begin() + index);
+		ExtentsZ.erase(ExtentsZ.begin() + index);
+	}
+
+	void BoxBoundsArray::RemoveAt(unsigned int index)
+	{
+		unsigned int last = CenterX.size() - 1;
+
+		CenterX[index] = CenterX[last];
+		CenterY[index] = CenterY[last];
+		CenterZ[index] = CenterZ[last];
+		ExtentsX[index] = ExtentsX[last];
+		ExtentsY[index] = ExtentsY[last];
+		ExtentsZ[index] = ExtentsZ[last];
+
+		CenterX.pop_back();
+		CenterY.pop_back();
+		CenterZ.pop_back();
+		ExtentsX.pop_back();
+		ExtentsY.pop_back();
+		ExtentsZ.pop_back();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,659 @@
+#include <algorithm>
+#include <cfloat>
+
+#include "BoxBounds.h"
+#include "BvhSceneManager.h"
+#include "Collidable.h"
+#include "Ray.h"
+#include "SceneNode.h"
+#include "Log.h"
+
+namespace fury
+{
+	const unsigned int BvhSceneManager::InvalidIndex = 0xffffffff;
+
+	const unsigned int BvhSceneManager::BinCount;
+
+	BvhSceneManager::Ptr BvhSceneManager::Create(unsigned int maxLeafSize, float rebuildThreshold)
+	{
+		return std::make_shared<BvhSceneManager>(maxLeafSize, rebuildThreshold);
+	}
+
+	BvhSceneManager::BvhSceneManager(unsigned int maxLeafSize, float rebuildThreshold) :
+		m_TypeIndex(typeid(BvhSceneManager)), m_MaxLeafSize(std::max(maxLeafSize, 1u)),
+		m_RebuildThreshold(rebuildThreshold)
+	{
+
+	}
+
+	BvhSceneManager::~BvhSceneManager()
+	{
+		Clear();
+		FURYD << "BvhSceneManager::~BvhSceneManager";
+	}
+
+	std::type_index BvhSceneManager::GetTypeIndex() const
+	{
+		return m_TypeIndex;
+	}
+
+	void BvhSceneManager::AddSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		auto manager = sceneNode->GetSceneManager();
+		if (manager == this)
+		{
+			UpdateSceneNode(sceneNode);
+			return;
+		}
+		else if (manager != nullptr)
+		{
+			manager->RemoveSceneNode(sceneNode);
+		}
+
+		unsigned int slot;
+		if (m_FreeSlots.empty())
+		{
+			slot = m_SceneNodes.size();
+			m_SceneNodes.push_back(sceneNode);
+		}
+		else
+		{
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+			m_SceneNodes[slot] = sceneNode;
+		}
+
+		SetSceneManager(*sceneNode, this, slot);
+		m_SceneNodeCount++;
+
+		m_Dirty = true;
+	}
+
+	void BvhSceneManager::AddSceneNodeRecursively(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		AddSceneNode(sceneNode);
+
+		for (unsigned int i = 0; i < sceneNode->GetChildCount(); i++)
+			AddSceneNodeRecursively(sceneNode->GetChildAt(i));
+	}
+
+	void BvhSceneManager::RemoveSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		if (sceneNode->GetSceneManager() != this)
+			return;
+
+		unsigned int slot = GetSceneManagerIndex(*sceneNode);
+
+		// leave a hole in the sorted objects, no need to rebuild.
+		if (!m_Dirty)
+		{
+			unsigned int object = m_SlotObjects[slot];
+			if (object == InvalidIndex)
+			{
+				m_InfiniteSlots.erase(std::find(m_InfiniteSlots.begin(), m_InfiniteSlots.end(), slot));
+			}
+			else
+			{
+				m_ObjectSlots[object] = InvalidIndex;
+				m_RemovedCount++;
+			}
+		}
+
+		SetSceneManager(*sceneNode, nullptr);
+
+		m_FreeSlots.push_back(slot);
+		m_SceneNodeCount--;
+
+		// sceneNode might be a reference to the slot itself.
+		m_SceneNodes[slot].reset();
+	}
+
+	void BvhSceneManager::UpdateSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		if (sceneNode->GetSceneManager() != this || m_Dirty)
+			return;
+
+		unsigned int object = m_SlotObjects[GetSceneManagerIndex(*sceneNode)];
+		BoxBounds aabb = sceneNode->GetWorldAABB();
+
+		if (object == InvalidIndex || aabb.GetInfinite())
+		{
+			// becoming finite or infinite moves it in or out of the tree.
+			if (object != InvalidIndex || !aabb.GetInfinite())
+				m_Dirty = true;
+		}
+		else
+		{
+			m_ObjectBounds.Set(object, aabb);
+			m_NeedsRefit = true;
+		}
+	}
+
+	void BvhSceneManager::WalkScene(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags) const
+	{
+		if (flags != 0)
+		{
+			WalkScene(collider, [&](const SceneNode::Ptr &sceneNode)
+			{
+				if (sceneNode->GetComponentFlags() & flags)
+					filterFunc(sceneNode);
+			});
+			return;
+		}
+
+		Refresh();
+
+		for (auto slot : m_InfiniteSlots)
+			filterFunc(m_SceneNodes[slot]);
+
+		const unsigned int batchSize = 64;
+		unsigned int visibles[batchSize];
+
+		unsigned int nodeCount = m_Nodes.size();
+		unsigned int index = 0;
+
+		while (index < nodeCount)
+		{
+			const Node &node = m_Nodes[index];
+
+			Side side = collider.IsInside(BoxBounds(
+				Vector4(node.min[0], node.min[1], node.min[2]),
+				Vector4(node.max[0], node.max[1], node.max[2])));
+
+			if (side == Side::OUT)
+			{
+				index = node.skip;
+			}
+			else if (side == Side::IN)
+			{
+				// the whole subtree is visible.
+				for (unsigned int i = node.objectBegin; i < node.objectEnd; i++)
+				{
+					unsigned int slot = m_ObjectSlots[i];
+					if (slot != InvalidIndex)
+						filterFunc(m_SceneNodes[slot]);
+				}
+				index = node.skip;
+			}
+			else if (node.skip == index + 1)
+			{
+				// test leaf's objects, a batch at a time.
+				for (unsigned int begin = node.objectBegin; begin < node.objectEnd; begin += batchSize)
+				{
+					unsigned int end = std::min(begin + batchSize, node.objectEnd);
+					unsigned int count = collider.IsInsideFastBatch(m_ObjectBounds, begin, end, visibles);
+					for (unsigned int i = 0; i < count; i++)
+					{
+						unsigned int slot = m_ObjectSlots[visibles[i]];
+						if (slot != InvalidIndex)
+							filterFunc(m_SceneNodes[slot]);
+					}
+				}
+				index++;
+			}
+			else
+			{
+				// step into left child.
+				index++;
+			}
+		}
+	}
+
+	void BvhSceneManager::WalkRay(const Ray &ray, float maxDistance, const RayFunc &rayFunc, unsigned int flags) const
+	{
+		Refresh();
+
+		if (m_Nodes.empty())
+			return;
+
+		// nodes and objects share one heap by entry distance, objects come out nearest first.
+		struct RayItem
+		{
+			float entry;
+
+			unsigned int index;
+
+			bool isObject;
+
+			bool operator < (const RayItem &other) const
+			{
+				return entry > other.entry;
+			}
+		};
+
+		std::vector<RayItem> heap;
+
+		float entry;
+		if (!ray.Intersects(m_Nodes[0].min, m_Nodes[0].max, maxDistance, entry))
+			return;
+
+		heap.push_back({ entry, 0, false });
+
+		while (!heap.empty())
+		{
+			std::pop_heap(heap.begin(), heap.end());
+			RayItem item = heap.back();
+			heap.pop_back();
+
+			if (item.entry > maxDistance)
+				break;
+
+			if (item.isObject)
+			{
+				maxDistance = rayFunc(m_SceneNodes[m_ObjectSlots[item.index]], item.entry);
+				continue;
+			}
+
+			const Node &node = m_Nodes[item.index];
+
+			if (node.skip == item.index + 1)
+			{
+				for (unsigned int i = node.objectBegin; i < node.objectEnd; i++)
+				{
+					unsigned int slot = m_ObjectSlots[i];
+					if (slot == InvalidIndex)
+						continue;
+
+					if (flags != 0 && !(m_SceneNodes[slot]->GetComponentFlags() & flags))
+						continue;
+
+					if (ray.Intersects(m_ObjectBounds.GetAt(i), maxDistance, entry))
+					{
+						heap.push_back({ entry, i, true });
+						std::push_heap(heap.begin(), heap.end());
+					}
+				}
+				continue;
+			}
+
+			unsigned int childs[2] = { item.index + 1, m_Nodes[item.index + 1].skip };
+			for (auto child : childs)
+			{
+				if (ray.Intersects(m_Nodes[child].min, m_Nodes[child].max, maxDistance, entry))
+				{
+					heap.push_back({ entry, child, false });
+					std::push_heap(heap.begin(), heap.end());
+				}
+			}
+		}
+	}
+
+	void BvhSceneManager::Clear()
+	{
+		for (auto &sceneNode : m_SceneNodes)
+		{
+			if (sceneNode != nullptr)
+				SetSceneManager(*sceneNode, nullptr);
+		}
+
+		m_SceneNodes.clear();
+		m_FreeSlots.clear();
+		m_SceneNodeCount = 0;
+
+		m_SlotObjects.clear();
+		m_Nodes.clear();
+		m_ObjectSlots.clear();
+		m_ObjectBounds.Clear();
+		m_InfiniteSlots.clear();
+		m_RemovedCount = 0;
+
+		m_Dirty = true;
+		m_NeedsRefit = false;
+	}
+
+	void BvhSceneManager::SetRebuildThreshold(float threshold)
+	{
+		m_RebuildThreshold = threshold;
+	}
+
+	float BvhSceneManager::GetRebuildThreshold() const
+	{
+		return m_RebuildThreshold;
+	}
+
+	unsigned int BvhSceneManager::GetSceneNodeCount() const
+	{
+		return m_SceneNodeCount;
+	}
+
+	unsigned int BvhSceneManager::GetNodeCount() const
+	{
+		Refresh();
+		return m_Nodes.size();
+	}
+
+	float BvhSceneManager::GetCost() const
+	{
+		Refresh();
+		return m_Cost;
+	}
+
+	void BvhSceneManager::Refresh() const
+	{
+		// rebuild when a quarter of the objects are holes.
+		if (m_Dirty || m_RemovedCount * 4 > m_ObjectSlots.size())
+		{
+			Rebuild();
+		}
+		else if (m_NeedsRefit)
+		{
+			Refit();
+
+			if (m_Cost > m_BuildCost * m_RebuildThreshold)
+				Rebuild();
+		}
+	}
+
+	void BvhSceneManager::Rebuild() const
+	{
+		unsigned int slotCount = m_SceneNodes.size();
+
+		m_BuildItems.clear();
+		m_InfiniteSlots.clear();
+		m_SlotObjects.assign(slotCount, InvalidIndex);
+
+		for (unsigned int slot = 0; slot < slotCount; slot++)
+		{
+			if (m_SceneNodes[slot] == nullptr)
+				continue;
+
+			BoxBounds aabb = m_SceneNodes[slot]->GetWorldAABB();
+			if (aabb.GetInfinite())
+			{
+				m_InfiniteSlots.push_back(slot);
+				continue;
+			}
+
+			Vector4 min = aabb.GetMin();
+			Vector4 max = aabb.GetMax();
+
+			BuildItem item;
+			item.slot = slot;
+			item.min[0] = min.x;
+			item.min[1] = min.y;
+			item.min[2] = min.z;
+			item.max[0] = max.x;
+			item.max[1] = max.y;
+			item.max[2] = max.z;
+
+			for (int i = 0; i < 3; i++)
+				item.center[i] = (item.min[i] + item.max[i]) * 0.5f;
+
+			m_BuildItems.push_back(item);
+		}
+
+		m_Nodes.clear();
+		m_ObjectSlots.clear();
+		m_ObjectBounds.Clear();
+		m_ObjectBounds.Reserve(m_BuildItems.size());
+
+		if (!m_BuildItems.empty())
+			BuildNode(0, m_BuildItems.size());
+
+		m_RemovedCount = 0;
+		m_Dirty = false;
+		m_NeedsRefit = false;
+
+		m_BuildCost = m_Cost = ComputeCost();
+	}
+
+	void BvhSceneManager::Refit() const
+	{
+		// childs come after their parent, so a backward pass sees childs first.
+		for (int index = (int)m_Nodes.size() - 1; index >= 0; index--)
+		{
+			Node &node = m_Nodes[index];
+
+			for (int i = 0; i < 3; i++)
+			{
+				node.min[i] = FLT_MAX;
+				node.max[i] = -FLT_MAX;
+			}
+
+			if (node.skip == (unsigned int)index + 1)
+			{
+				// removed objects keep their last bounds, they're gone after next rebuild.
+				for (unsigned int i = node.objectBegin; i < node.objectEnd; i++)
+				{
+					node.min[0] = std::min(node.min[0], m_ObjectBounds.CenterX[i] - m_ObjectBounds.ExtentsX[i]);
+					node.min[1] = std::min(node.min[1], m_ObjectBounds.CenterY[i] - m_ObjectBounds.ExtentsY[i]);
+					node.min[2] = std::min(node.min[2], m_ObjectBounds.CenterZ[i] - m_ObjectBounds.ExtentsZ[i]);
+					node.max[0] = std::max(node.max[0], m_ObjectBounds.CenterX[i] + m_ObjectBounds.ExtentsX[i]);
+					node.max[1] = std::max(node.max[1], m_ObjectBounds.CenterY[i] + m_ObjectBounds.ExtentsY[i]);
+					node.max[2] = std::max(node.max[2], m_ObjectBounds.CenterZ[i] + m_ObjectBounds.ExtentsZ[i]);
+				}
+			}
+			else
+			{
+				const Node &left = m_Nodes[index + 1];
+				const Node &right = m_Nodes[left.skip];
+
+				for (int i = 0; i < 3; i++)
+				{
+					node.min[i] = std::min(left.min[i], right.min[i]);
+					node.max[i] = std::max(left.max[i], right.max[i]);
+				}
+			}
+		}
+
+		m_Cost = ComputeCost();
+		m_NeedsRefit = false;
+	}
+
+	unsigned int BvhSceneManager::BuildNode(unsigned int begin, unsigned int end) const
+	{
+		unsigned int index = m_Nodes.size();
+		m_Nodes.push_back(Node());
+		SetNodeBounds(m_Nodes[index], begin, end);
+
+		unsigned int count = end - begin;
+		unsigned int mid = begin;
+
+		if (count > m_MaxLeafSize)
+		{
+			float centerMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+			float centerMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+			for (unsigned int i = begin; i < end; i++)
+			{
+				for (int axis = 0; axis < 3; axis++)
+				{
+					centerMin[axis] = std::min(centerMin[axis], m_BuildItems[i].center[axis]);
+					centerMax[axis] = std::max(centerMax[axis], m_BuildItems[i].center[axis]);
+				}
+			}
+
+			// find the cheapest split between bins, cost is area * count of both sides.
+			float bestCost = FLT_MAX;
+			int bestAxis = -1;
+			unsigned int bestBin = 0;
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				float extent = centerMax[axis] - centerMin[axis];
+				if (extent <= 0.0f)
+					continue;
+
+				unsigned int binCounts[BinCount] = { 0 };
+				float binMin[BinCount][3], binMax[BinCount][3];
+
+				for (unsigned int bin = 0; bin < BinCount; bin++)
+				{
+					for (int i = 0; i < 3; i++)
+					{
+						binMin[bin][i] = FLT_MAX;
+						binMax[bin][i] = -FLT_MAX;
+					}
+				}
+
+				float scale = BinCount / extent;
+				for (unsigned int i = begin; i < end; i++)
+				{
+					const BuildItem &item = m_BuildItems[i];
+					unsigned int bin = std::min((unsigned int)((item.center[axis] - centerMin[axis]) * scale), BinCount - 1);
+
+					binCounts[bin]++;
+					for (int k = 0; k < 3; k++)
+					{
+						binMin[bin][k] = std::min(binMin[bin][k], item.min[k]);
+						binMax[bin][k] = std::max(binMax[bin][k], item.max[k]);
+					}
+				}
+
+				// sweep from the right to get the right side's cost of each split.
+				float rightCosts[BinCount];
+				float sideMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+				float sideMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+				unsigned int sideCount = 0;
+
+				for (unsigned int bin = BinCount - 1; bin > 0; bin--)
+				{
+					sideCount += binCounts[bin];
+					for (int k = 0; k < 3; k++)
+					{
+						sideMin[k] = std::min(sideMin[k], binMin[bin][k]);
+						sideMax[k] = std::max(sideMax[k], binMax[bin][k]);
+					}
+					rightCosts[bin - 1] = sideCount > 0 ? GetHalfArea(sideMin, sideMax) * sideCount : 0.0f;
+				}
+
+				// then from the left, split after bin.
+				for (int k = 0; k < 3; k++)
+				{
+					sideMin[k] = FLT_MAX;
+					sideMax[k] = -FLT_MAX;
+				}
+				sideCount = 0;
+
+				for (unsigned int bin = 0; bin < BinCount - 1; bin++)
+				{
+					sideCount += binCounts[bin];
+					for (int k = 0; k < 3; k++)
+					{
+						sideMin[k] = std::min(sideMin[k], binMin[bin][k]);
+						sideMax[k] = std::max(sideMax[k], binMax[bin][k]);
+					}
+
+					if (sideCount == 0 || sideCount == count)
+						continue;
+
+					float cost = GetHalfArea(sideMin, sideMax) * sideCount + rightCosts[bin];
+					if (cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestBin = bin;
+					}
+				}
+			}
+
+			if (bestAxis >= 0)
+			{
+				float extent = centerMax[bestAxis] - centerMin[bestAxis];
+				float scale = BinCount / extent;
+				float axisMin = centerMin[bestAxis];
+
+				auto it = std::partition(m_BuildItems.begin() + begin, m_BuildItems.begin() + end,
+					[&](const BuildItem &item) -> bool
+				{
+					return std::min((unsigned int)((item.center[bestAxis] - axisMin) * scale), BinCount - 1) <= bestBin;
+				});
+
+				mid = it - m_BuildItems.begin();
+			}
+
+			// all centers at the same point, split by count.
+			if (mid == begin || mid == end)
+				mid = begin + count / 2;
+		}
+
+		if (mid == begin)
+		{
+			Node &node = m_Nodes[index];
+			node.skip = index + 1;
+			node.objectBegin = m_ObjectSlots.size();
+
+			for (unsigned int i = begin; i < end; i++)
+			{
+				const BuildItem &item = m_BuildItems[i];
+
+				m_SlotObjects[item.slot] = m_ObjectSlots.size();
+				m_ObjectSlots.push_back(item.slot);
+				m_ObjectBounds.Add(BoxBounds(
+					Vector4(item.min[0], item.min[1], item.min[2]),
+					Vector4(item.max[0], item.max[1], item.max[2])));
+			}
+
+			node.objectEnd = m_ObjectSlots.size();
+		}
+		else
+		{
+			unsigned int objectBegin = m_ObjectSlots.size();
+
+			BuildNode(begin, mid);
+			BuildNode(mid, end);
+
+			// m_Nodes might have been reallocated.
+			Node &node = m_Nodes[index];
+			node.skip = m_Nodes.size();
+			node.objectBegin = objectBegin;
+			node.objectEnd = m_ObjectSlots.size();
+		}
+
+		return index;
+	}
+
+	void BvhSceneManager::SetNodeBounds(Node &node, unsigned int begin, unsigned int end) const
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			node.min[i] = FLT_MAX;
+			node.max[i] = -FLT_MAX;
+		}
+
+		for (unsigned int index = begin; index < end; index++)
+		{
+			const BuildItem &item = m_BuildItems[index];
+			for (int i = 0; i < 3; i++)
+			{
+				node.min[i] = std::min(node.min[i], item.min[i]);
+				node.max[i] = std::max(node.max[i], item.max[i]);
+			}
+		}
+	}
+
+	float BvhSceneManager::ComputeCost() const
+	{
+		if (m_Nodes.empty())
+			return 0.0f;
+
+		float rootArea = GetHalfArea(m_Nodes[0].min, m_Nodes[0].max);
+		if (rootArea <= 0.0f)
+			return 0.0f;
+
+		// one unit per node visit, one per object test.
+		float cost = 0.0f;
+		unsigned int nodeCount = m_Nodes.size();
+
+		for (unsigned int index = 0; index < nodeCount; index++)
+		{
+			const Node &node = m_Nodes[index];
+			float area = GetHalfArea(node.min, node.max);
+
+			if (node.skip == index + 1)
+				cost += area * (node.objectEnd - node.objectBegin);
+			else
+				cost += area;
+		}
+
+		return cost / rootArea;
+	}
+
+	float BvhSceneManager::GetHalfArea(const float *min, const float *max) const
+	{
+		float x = max[0] - min[0];
+		float y = max[1] - min[1];
+		float z = max[2] - min[2];
+		return x * y + y * z + z * x;
+	}
+}
\ No newline at end of file
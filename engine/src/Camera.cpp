@@ -14,6 +14,11 @@ namespace fury
 		m_TypeIndex = typeid(Camera);
 	}
 
+	unsigned int Camera::GetComponentFlags() const
+	{
+		return SceneNode::CAMERA;
+	}
+
 	Component::Ptr Camera::Clone() const
 	{
 		auto ptr = Camera::Create();
@@ -58,7 +63,7 @@ namespace fury
 
 	void Camera::OrthoOffCenter(float left, float right, float bottom, float top, float near, float far)
 	{
-		m_Perspective = true;
+		m_Perspective = false;
 
 		m_ProjectionParams[0] = left;
 		m_ProjectionParams[1] = right;
@@ -129,6 +134,21 @@ namespace fury
 		m_Frustum.Transform(matrix);
 	}
 
+	Ray Camera::GetRay(float x, float y) const
+	{
+		float near = m_ProjectionParams[4];
+		Vector4 point(
+			m_ProjectionParams[0] + (m_ProjectionParams[1] - m_ProjectionParams[0]) * (x + 1.0f) * 0.5f,
+			m_ProjectionParams[2] + (m_ProjectionParams[3] - m_ProjectionParams[2]) * (y + 1.0f) * 0.5f,
+			-near, 1.0f);
+
+		// view space, the camera looks down -z.
+		Vector4 direction = m_Perspective ? Vector4(point, 0.0f) : Vector4(0.0f, 0.0f, -1.0f, 0.0f);
+
+		Matrix4 matrix = m_Frustum.GetTransformMatrix();
+		return Ray(matrix.Multiply(point), matrix.Multiply(direction));
+	}
+
 	bool Camera::IsVisible(const BoxBounds &aabb) const
 	{
 		return m_Frustum.IsInsideFast(aabb);
@@ -0,0 +1,23 @@
+#include "BoxBounds.h"
+#include "BoxBoundsArray.h"
+#include "Collidable.h"
+
+namespace fury
+{
+	void Collidable::IsInsideBatch(const BoxBoundsArray &aabbs, unsigned int begin, unsigned int end, Side *output) const
+	{
+		for (unsigned int i = begin; i < end; i++)
+			output[i - begin] = IsInside(aabbs.GetAt(i));
+	}
+
+	unsigned int Collidable::IsInsideFastBatch(const BoxBoundsArray &aabbs, unsigned int begin, unsigned int end, unsigned int *output) const
+	{
+		unsigned int count = 0;
+		for (unsigned int i = begin; i < end; i++)
+		{
+			if (IsInsideFast(aabbs.GetAt(i)))
+				output[count++] = i;
+		}
+		return count;
+	}
+}
\ No newline at end of file
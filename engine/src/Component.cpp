@@ -23,6 +23,11 @@ namespace fury
 		return !m_Owner.expired();
 	}
 
+	unsigned int Component::GetComponentFlags() const
+	{
+		return 0;
+	}
+
 	void Component::OnAttaching(const std::shared_ptr<SceneNode> &node)
 	{
 		if (m_Owner.expired())
@@ -0,0 +1,264 @@
+#include <cmath>
+
+#include "BoxBounds.h"
+#include "BoxBoundsArray.h"
+#include "ConvexVolume.h"
+#include "Frustum.h"
+#include "SphereBounds.h"
+
+namespace fury
+{
+	ConvexVolume::ConvexVolume(const Frustum &frustum, Vector4 direction, const BoxBounds *clipBounds)
+	{
+		SetExtrudedFrustum(frustum, direction, clipBounds);
+	}
+
+	void ConvexVolume::SetExtrudedFrustum(const Frustum &frustum, Vector4 direction, const BoxBounds *clipBounds)
+	{
+		// ntl, ntr, nbl, nbr, ftl, ftr, fbl, fbr
+		static const int faces[6][3] = 
+		{
+			{ 0, 1, 3 }, // near
+			{ 4, 5, 7 }, // far
+			{ 0, 2, 6 }, // left
+			{ 1, 3, 7 }, // right
+			{ 0, 1, 5 }, // top
+			{ 2, 3, 7 }, // bottom
+		};
+
+		// corner a, corner b, face, face
+		static const int edges[12][4] = 
+		{
+			{ 0, 1, 0, 4 }, { 2, 3, 0, 5 }, { 0, 2, 0, 2 }, { 1, 3, 0, 3 },
+			{ 4, 5, 1, 4 }, { 6, 7, 1, 5 }, { 4, 6, 1, 2 }, { 5, 7, 1, 3 },
+			{ 0, 4, 2, 4 }, { 1, 5, 3, 4 }, { 2, 6, 2, 5 }, { 3, 7, 3, 5 },
+		};
+
+		m_Planes.clear();
+
+		auto corners = frustum.GetCurrentCorners();
+
+		Vector4 centroid(0.0f);
+		for (const auto &corner : corners)
+			centroid = centroid + corner;
+		centroid = centroid / 8.0f;
+
+		direction = Vector4(direction, 0.0f).Normalized();
+
+		// flips plane to face centroid, so it works with any corner winding.
+		auto facing = [&](Plane plane)
+		{
+			if (plane.GetDistance(centroid) < 0.0f)
+			{
+				Vector4 normal = -plane.GetNormal();
+				return Plane(normal.x, normal.y, normal.z, -plane.GetDistance());
+			}
+			return plane;
+		};
+
+		// faces turned away from the light bound the sweep, the others open up towards the light.
+		bool kept[6];
+		for (int i = 0; i < 6; i++)
+		{
+			Plane plane = facing(Plane(corners[faces[i][0]], corners[faces[i][1]], corners[faces[i][2]]));
+			kept[i] = plane.GetNormal() * direction <= 0.0f;
+			if (kept[i])
+				m_Planes.push_back(plane);
+		}
+
+		// silhouette edges, between a kept and an opened face, are swept along the light.
+		for (int i = 0; i < 12; i++)
+		{
+			if (kept[edges[i][2]] == kept[edges[i][3]])
+				continue;
+
+			Vector4 start = corners[edges[i][0]];
+			Vector4 normal = (corners[edges[i][1]] - start).CrossProduct(direction);
+			if (normal.SquareLength() < 1e-12f)
+				continue;
+
+			m_Planes.push_back(facing(Plane(normal.Normalized(), start)));
+		}
+
+		if (clipBounds != nullptr && !clipBounds->GetInfinite())
+			AddPlanes(*clipBounds);
+	}
+
+	void ConvexVolume::AddPlane(const Plane &plane)
+	{
+		m_Planes.push_back(plane);
+	}
+
+	void ConvexVolume::AddPlanes(const BoxBounds &aabb)
+	{
+		Vector4 min = aabb.GetMin();
+		Vector4 max = aabb.GetMax();
+
+		m_Planes.push_back(Plane(Vector4(1.0f, 0.0f, 0.0f, 0.0f), min));
+		m_Planes.push_back(Plane(Vector4(-1.0f, 0.0f, 0.0f, 0.0f), max));
+		m_Planes.push_back(Plane(Vector4(0.0f, 1.0f, 0.0f, 0.0f), min));
+		m_Planes.push_back(Plane(Vector4(0.0f, -1.0f, 0.0f, 0.0f), max));
+		m_Planes.push_back(Plane(Vector4(0.0f, 0.0f, 1.0f, 0.0f), min));
+		m_Planes.push_back(Plane(Vector4(0.0f, 0.0f, -1.0f, 0.0f), max));
+	}
+
+	void ConvexVolume::Clear()
+	{
+		m_Planes.clear();
+	}
+
+	unsigned int ConvexVolume::GetPlaneCount() const
+	{
+		return m_Planes.size();
+	}
+
+	Plane ConvexVolume::GetPlaneAt(unsigned int index) const
+	{
+		return m_Planes[index];
+	}
+
+	Side ConvexVolume::IsInside(Vector4 point) const
+	{
+		bool straddle = false;
+
+		for (const auto &plane : m_Planes)
+		{
+			Side side = plane.IsInside(point);
+			if (side == Side::OUT)
+				return Side::OUT;
+			else if (side == Side::STRADDLE)
+				straddle = true;
+		}
+
+		return straddle ? Side::STRADDLE : Side::IN;
+	}
+
+	Side ConvexVolume::IsInside(const BoxBounds &aabb) const
+	{
+		if (aabb.GetInfinite())
+			return Side::IN;
+
+		bool straddle = false;
+
+		for (const auto &plane : m_Planes)
+		{
+			Side side = plane.IsInside(aabb);
+			if (side == Side::OUT)
+				return Side::OUT;
+			else if (side == Side::STRADDLE)
+				straddle = true;
+		}
+
+		return straddle ? Side::STRADDLE : Side::IN;
+	}
+
+	Side ConvexVolume::IsInside(const SphereBounds &bsphere) const
+	{
+		if (bsphere.GetInfinite())
+			return Side::IN;
+
+		bool straddle = false;
+
+		for (const auto &plane : m_Planes)
+		{
+			Side side = plane.IsInside(bsphere);
+			if (side == Side::OUT)
+				return Side::OUT;
+			else if (side == Side::STRADDLE)
+				straddle = true;
+		}
+
+		return straddle ? Side::STRADDLE : Side::IN;
+	}
+
+	bool ConvexVolume::IsInsideFast(const SphereBounds &bsphere) const
+	{
+		if (bsphere.GetInfinite())
+			return true;
+
+		// a sphere is out only when it's completely behind a plane.
+		for (const auto &plane : m_Planes)
+		{
+			if (plane.GetDistance(bsphere.GetCenter()) < -bsphere.GetRadius())
+				return false;
+		}
+
+		return true;
+	}
+
+	bool ConvexVolume::IsInsideFast(const BoxBounds &aabb) const
+	{
+		if (aabb.GetInfinite())
+			return true;
+
+		for (const auto &plane : m_Planes)
+		{
+			if (!plane.IsInsideFast(aabb))
+				return false;
+		}
+
+		return true;
+	}
+
+	bool ConvexVolume::IsInsideFast(Vector4 point) const
+	{
+		for (const auto &plane : m_Planes)
+		{
+			if (!plane.IsInsideFast(point))
+				return false;
+		}
+
+		return true;
+	}
+
+	void ConvexVolume::IsInsideBatch(const BoxBoundsArray &aabbs, unsigned int begin, unsigned int end, Side *output) const
+	{
+		for (unsigned int i = begin; i < end; i++)
+		{
+			Side side = Side::IN;
+			for (const auto &plane : m_Planes)
+			{
+				Vector4 normal = plane.GetNormal();
+
+				float dist = normal.x * aabbs.CenterX[i] + normal.y * aabbs.CenterY[i] + normal.z * aabbs.CenterZ[i] + plane.GetDistance();
+				float radius = std::abs(normal.x) * aabbs.ExtentsX[i] + std::abs(normal.y) * aabbs.ExtentsY[i] + std::abs(normal.z) * aabbs.ExtentsZ[i];
+
+				if (dist + radius < 0.0f)
+				{
+					side = Side::OUT;
+					break;
+				}
+				else if (dist - radius < 0.0f)
+				{
+					side = Side::STRADDLE;
+				}
+			}
+			output[i - begin] = side;
+		}
+	}
+
+	unsigned int ConvexVolume::IsInsideFastBatch(const BoxBoundsArray &aabbs, unsigned int begin, unsigned int end, unsigned int *output) const
+	{
+		unsigned int count = 0;
+		for (unsigned int i = begin; i < end; i++)
+		{
+			bool inside = true;
+			for (const auto &plane : m_Planes)
+			{
+				Vector4 normal = plane.GetNormal();
+
+				float dist = normal.x * aabbs.CenterX[i] + normal.y * aabbs.CenterY[i] + normal.z * aabbs.CenterZ[i] + plane.GetDistance();
+				float radius = std::abs(normal.x) * aabbs.ExtentsX[i] + std::abs(normal.y) * aabbs.ExtentsY[i] + std::abs(normal.z) * aabbs.ExtentsZ[i];
+
+				if (dist + radius < 0.0f)
+				{
+					inside = false;
+					break;
+				}
+			}
+			if (inside)
+				output[count++] = i;
+		}
+		return count;
+	}
+}
\ No newline at end of file
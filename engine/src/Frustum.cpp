@@ -1,14 +1,27 @@
 #include <cmath>
 
 #include "BoxBounds.h"
+#include "BoxBoundsArray.h"
 #include "Frustum.h"
 #include "Matrix4.h"
 #include "Plane.h"
 #include "SphereBounds.h"
 #include "Vector4.h"
 
+#if defined(FURY_USE_AVX)
+#include <immintrin.h>
+#elif defined(FURY_USE_SSE)
+#include <emmintrin.h>
+#endif
+
 namespace fury
 {
+	const unsigned char Frustum::AllPlanes;
+
+	bool Frustum::m_CountPlaneTests = false;
+
+	std::atomic<unsigned long long> Frustum::m_PlaneTestCount(0);
+
 	Frustum::Frustum(const Frustum &other)
 	{
 		m_BaseCorners = other.m_BaseCorners;
@@ -108,14 +121,105 @@ namespace fury
 		{
 			Side side = m_Planes[i].IsInside(aabb);
 			if (side == Side::OUT)
+			{
+				CountPlaneTests(i + 1);
 				return Side::OUT;
+			}
 			else if (side == Side::STRADDLE)
+			{
 				straddle = true;
+			}
 		}
 
+		CountPlaneTests(6);
 		return straddle ? Side::STRADDLE : Side::IN;
 	}
 
+	Side Frustum::IsInside(const BoxBounds &aabb, unsigned char &lastPlane, unsigned char parentMask, unsigned char &mask) const
+	{
+		if (aabb.GetInfinite())
+		{
+			mask = AllPlanes;
+			return Side::IN;
+		}
+
+		// lastPlane, then planes it wasn't inside of, then the rest.
+		unsigned char order[6];
+		unsigned int count = 0;
+
+		order[count++] = lastPlane;
+		for (unsigned char i = 0; i < 6; i++)
+			if (i != lastPlane && !(mask & (1 << i)))
+				order[count++] = i;
+		for (unsigned char i = 0; i < 6; i++)
+			if (i != lastPlane && (mask & (1 << i)))
+				order[count++] = i;
+
+		unsigned char insideMask = parentMask;
+		unsigned int tests = 0;
+
+		for (unsigned int k = 0; k < 6; k++)
+		{
+			unsigned char i = order[k];
+			if (parentMask & (1 << i))
+				continue;
+
+			tests++;
+
+			Side side = m_Planes[i].IsInside(aabb);
+			if (side == Side::OUT)
+			{
+				lastPlane = i;
+				CountPlaneTests(tests);
+				return Side::OUT;
+			}
+			else if (side == Side::IN)
+			{
+				insideMask |= 1 << i;
+			}
+		}
+
+		CountPlaneTests(tests);
+
+		mask = insideMask;
+		return mask == AllPlanes ? Side::IN : Side::STRADDLE;
+	}
+
+	bool Frustum::IsInsideFast(const BoxBounds &aabb, unsigned char &lastPlane, unsigned char parentMask) const
+	{
+		if (aabb.GetInfinite())
+			return true;
+
+		unsigned int tests = 0;
+
+		if (!(parentMask & (1 << lastPlane)))
+		{
+			tests++;
+			if (!m_Planes[lastPlane].IsInsideFast(aabb))
+			{
+				CountPlaneTests(tests);
+				return false;
+			}
+		}
+
+		for (unsigned char i = 0; i < 6; i++)
+		{
+			if (i == lastPlane || (parentMask & (1 << i)))
+				continue;
+
+			tests++;
+			if (!m_Planes[i].IsInsideFast(aabb))
+			{
+				lastPlane = i;
+				CountPlaneTests(tests);
+				return false;
+			}
+		}
+
+		CountPlaneTests(tests);
+		return true;
+	}
+
 	Side Frustum::IsInside(Vector4 point) const
 	{
 		bool straddle = false;
@@ -150,9 +254,15 @@ namespace fury
 			return true;
 
 		for (int i = 0; i < 6; i++)
+		{
 			if (!m_Planes[i].IsInsideFast(aabb))
+			{
+				CountPlaneTests(i + 1);
 				return false;
+			}
+		}
 
+		CountPlaneTests(6);
 		return true;
 	}
 
@@ -165,6 +275,232 @@ namespace fury
 		return true;
 	}
 
+	void Frustum::IsInsideBatch(const BoxBoundsArray &aabbs, unsigned int begin, unsigned int end, Side *output) const
+	{
+		CountPlaneTests((end - begin) * 6);
+
+		// a box is out if center's distance < -radius, and straddles if it's < radius.
+		// where radius is the box's extents projected to the plane's normal.
+		float nx[6], ny[6], nz[6], ax[6], ay[6], az[6], d[6];
+		for (int p = 0; p < 6; p++)
+		{
+			Vector4 normal = m_Planes[p].GetNormal();
+			nx[p] = normal.x;
+			ny[p] = normal.y;
+			nz[p] = normal.z;
+			ax[p] = std::fabs(normal.x);
+			ay[p] = std::fabs(normal.y);
+			az[p] = std::fabs(normal.z);
+			d[p] = m_Planes[p].GetDistance();
+		}
+
+		const float *centerX = aabbs.CenterX.data();
+		const float *centerY = aabbs.CenterY.data();
+		const float *centerZ = aabbs.CenterZ.data();
+		const float *extentsX = aabbs.ExtentsX.data();
+		const float *extentsY = aabbs.ExtentsY.data();
+		const float *extentsZ = aabbs.ExtentsZ.data();
+
+		unsigned int i = begin;
+
+#if defined(FURY_USE_AVX)
+		for (; i + 8 <= end; i += 8)
+		{
+			__m256 cx = _mm256_loadu_ps(centerX + i);
+			__m256 cy = _mm256_loadu_ps(centerY + i);
+			__m256 cz = _mm256_loadu_ps(centerZ + i);
+			__m256 ex = _mm256_loadu_ps(extentsX + i);
+			__m256 ey = _mm256_loadu_ps(extentsY + i);
+			__m256 ez = _mm256_loadu_ps(extentsZ + i);
+
+			__m256 zero = _mm256_setzero_ps();
+			__m256 outside = zero;
+			__m256 straddle = zero;
+
+			for (int p = 0; p < 6; p++)
+			{
+				__m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(nx[p]), cx),
+					_mm256_mul_ps(_mm256_set1_ps(ny[p]), cy)), _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(nz[p]), cz),
+					_mm256_set1_ps(d[p])));
+				__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(ax[p]), ex),
+					_mm256_mul_ps(_mm256_set1_ps(ay[p]), ey)), _mm256_mul_ps(_mm256_set1_ps(az[p]), ez));
+
+				outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(dist, radius), zero, _CMP_LT_OQ));
+				straddle = _mm256_or_ps(straddle, _mm256_cmp_ps(_mm256_sub_ps(dist, radius), zero, _CMP_LT_OQ));
+			}
+
+			int outMask = _mm256_movemask_ps(outside);
+			int straddleMask = _mm256_movemask_ps(straddle);
+
+			for (int b = 0; b < 8; b++)
+				output[i - begin + b] = ((outMask >> b) & 1) ? Side::OUT : (((straddleMask >> b) & 1) ? Side::STRADDLE : Side::IN);
+		}
+#elif defined(FURY_USE_SSE)
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 cx = _mm_loadu_ps(centerX + i);
+			__m128 cy = _mm_loadu_ps(centerY + i);
+			__m128 cz = _mm_loadu_ps(centerZ + i);
+			__m128 ex = _mm_loadu_ps(extentsX + i);
+			__m128 ey = _mm_loadu_ps(extentsY + i);
+			__m128 ez = _mm_loadu_ps(extentsZ + i);
+
+			__m128 zero = _mm_setzero_ps();
+			__m128 outside = zero;
+			__m128 straddle = zero;
+
+			for (int p = 0; p < 6; p++)
+			{
+				__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(nx[p]), cx),
+					_mm_mul_ps(_mm_set1_ps(ny[p]), cy)), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(nz[p]), cz),
+					_mm_set1_ps(d[p])));
+				__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(ax[p]), ex),
+					_mm_mul_ps(_mm_set1_ps(ay[p]), ey)), _mm_mul_ps(_mm_set1_ps(az[p]), ez));
+
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, radius), zero));
+				straddle = _mm_or_ps(straddle, _mm_cmplt_ps(_mm_sub_ps(dist, radius), zero));
+			}
+
+			int outMask = _mm_movemask_ps(outside);
+			int straddleMask = _mm_movemask_ps(straddle);
+
+			for (int b = 0; b < 4; b++)
+				output[i - begin + b] = ((outMask >> b) & 1) ? Side::OUT : (((straddleMask >> b) & 1) ? Side::STRADDLE : Side::IN);
+		}
+#endif
+
+		for (; i < end; i++)
+		{
+			Side side = Side::IN;
+			for (int p = 0; p < 6; p++)
+			{
+				float dist = nx[p] * centerX[i] + ny[p] * centerY[i] + (nz[p] * centerZ[i] + d[p]);
+				float radius = ax[p] * extentsX[i] + ay[p] * extentsY[i] + az[p] * extentsZ[i];
+
+				if (dist + radius < 0.0f)
+				{
+					side = Side::OUT;
+					break;
+				}
+				else if (dist - radius < 0.0f)
+				{
+					side = Side::STRADDLE;
+				}
+			}
+			output[i - begin] = side;
+		}
+	}
+
+	unsigned int Frustum::IsInsideFastBatch(const BoxBoundsArray &aabbs, unsigned int begin, unsigned int end, unsigned int *output) const
+	{
+		CountPlaneTests((end - begin) * 6);
+
+		float nx[6], ny[6], nz[6], ax[6], ay[6], az[6], d[6];
+		for (int p = 0; p < 6; p++)
+		{
+			Vector4 normal = m_Planes[p].GetNormal();
+			nx[p] = normal.x;
+			ny[p] = normal.y;
+			nz[p] = normal.z;
+			ax[p] = std::fabs(normal.x);
+			ay[p] = std::fabs(normal.y);
+			az[p] = std::fabs(normal.z);
+			d[p] = m_Planes[p].GetDistance();
+		}
+
+		const float *centerX = aabbs.CenterX.data();
+		const float *centerY = aabbs.CenterY.data();
+		const float *centerZ = aabbs.CenterZ.data();
+		const float *extentsX = aabbs.ExtentsX.data();
+		const float *extentsY = aabbs.ExtentsY.data();
+		const float *extentsZ = aabbs.ExtentsZ.data();
+
+		unsigned int count = 0;
+		unsigned int i = begin;
+
+#if defined(FURY_USE_AVX)
+		for (; i + 8 <= end; i += 8)
+		{
+			__m256 cx = _mm256_loadu_ps(centerX + i);
+			__m256 cy = _mm256_loadu_ps(centerY + i);
+			__m256 cz = _mm256_loadu_ps(centerZ + i);
+			__m256 ex = _mm256_loadu_ps(extentsX + i);
+			__m256 ey = _mm256_loadu_ps(extentsY + i);
+			__m256 ez = _mm256_loadu_ps(extentsZ + i);
+
+			__m256 zero = _mm256_setzero_ps();
+			__m256 outside = zero;
+
+			for (int p = 0; p < 6; p++)
+			{
+				__m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(nx[p]), cx),
+					_mm256_mul_ps(_mm256_set1_ps(ny[p]), cy)), _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(nz[p]), cz),
+					_mm256_set1_ps(d[p])));
+				__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(ax[p]), ex),
+					_mm256_mul_ps(_mm256_set1_ps(ay[p]), ey)), _mm256_mul_ps(_mm256_set1_ps(az[p]), ez));
+
+				outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(dist, radius), zero, _CMP_LT_OQ));
+			}
+
+			// compact the visible indices without branching.
+			int visibleMask = ~_mm256_movemask_ps(outside);
+			for (int b = 0; b < 8; b++)
+			{
+				output[count] = i + b;
+				count += (visibleMask >> b) & 1;
+			}
+		}
+#elif defined(FURY_USE_SSE)
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 cx = _mm_loadu_ps(centerX + i);
+			__m128 cy = _mm_loadu_ps(centerY + i);
+			__m128 cz = _mm_loadu_ps(centerZ + i);
+			__m128 ex = _mm_loadu_ps(extentsX + i);
+			__m128 ey = _mm_loadu_ps(extentsY + i);
+			__m128 ez = _mm_loadu_ps(extentsZ + i);
+
+			__m128 zero = _mm_setzero_ps();
+			__m128 outside = zero;
+
+			for (int p = 0; p < 6; p++)
+			{
+				__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(nx[p]), cx),
+					_mm_mul_ps(_mm_set1_ps(ny[p]), cy)), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(nz[p]), cz),
+					_mm_set1_ps(d[p])));
+				__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(ax[p]), ex),
+					_mm_mul_ps(_mm_set1_ps(ay[p]), ey)), _mm_mul_ps(_mm_set1_ps(az[p]), ez));
+
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, radius), zero));
+			}
+
+			// compact the visible indices without branching.
+			int visibleMask = ~_mm_movemask_ps(outside);
+			for (int b = 0; b < 4; b++)
+			{
+				output[count] = i + b;
+				count += (visibleMask >> b) & 1;
+			}
+		}
+#endif
+
+		for (; i < end; i++)
+		{
+			bool visible = true;
+			for (int p = 0; p < 6 && visible; p++)
+			{
+				float dist = nx[p] * centerX[i] + ny[p] * centerY[i] + (nz[p] * centerZ[i] + d[p]);
+				float radius = ax[p] * extentsX[i] + ay[p] * extentsY[i] + az[p] * extentsZ[i];
+				visible = dist + radius >= 0.0f;
+			}
+
+			output[count] = i;
+			count += visible ? 1 : 0;
+		}
+
+		return count;
+	}
+
 	std::array<Vector4, 8> Frustum::GetCurrentCorners() const
 	{
 		return m_CurrentCorners;
@@ -187,4 +523,30 @@ namespace fury
 			aabb.Encapsulate(ptn);
 		return aabb;
 	}
+
+	void Frustum::SetPlaneTestCounting(bool enable)
+	{
+		m_CountPlaneTests = enable;
+	}
+
+	bool Frustum::GetPlaneTestCounting()
+	{
+		return m_CountPlaneTests;
+	}
+
+	unsigned long long Frustum::GetPlaneTestCount()
+	{
+		return m_PlaneTestCount.load();
+	}
+
+	void Frustum::ResetPlaneTestCount()
+	{
+		m_PlaneTestCount = 0;
+	}
+
+	void Frustum::CountPlaneTests(unsigned int count) const
+	{
+		if (m_CountPlaneTests)
+			m_PlaneTestCount.fetch_add(count, std::memory_order_relaxed);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <cmath>
+
+#include "BoxBounds.h"
+#include "Frustum.h"
+#include "GridSceneManager.h"
+#include "SceneNode.h"
+#include "SphereBounds.h"
+#include "Log.h"
+
+namespace fury
+{
+	const unsigned int GridSceneManager::InvalidIndex = 0xffffffff;
+
+	GridSceneManager::Ptr GridSceneManager::Create(float cellSize)
+	{
+		return std::make_shared<GridSceneManager>(cellSize);
+	}
+
+	GridSceneManager::GridSceneManager(float cellSize) :
+		m_TypeIndex(typeid(GridSceneManager)), m_CellSize(cellSize > 0.0f ? cellSize : 1.0f), m_MaxExtents(0.0f)
+	{
+
+	}
+
+	GridSceneManager::~GridSceneManager()
+	{
+		Clear();
+		FURYD << "GridSceneManager::~GridSceneManager";
+	}
+
+	std::type_index GridSceneManager::GetTypeIndex() const
+	{
+		return m_TypeIndex;
+	}
+
+	void GridSceneManager::AddSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		auto manager = sceneNode->GetSceneManager();
+		if (manager == this)
+		{
+			UpdateSceneNode(sceneNode);
+			return;
+		}
+		else if (manager != nullptr)
+		{
+			manager->RemoveSceneNode(sceneNode);
+		}
+
+		unsigned int slot;
+		if (m_FreeSlots.empty())
+		{
+			slot = m_SceneNodes.size();
+			m_SceneNodes.push_back(sceneNode);
+			m_SlotCells.push_back(InvalidIndex);
+			m_SlotPositions.push_back(InvalidIndex);
+		}
+		else
+		{
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+			m_SceneNodes[slot] = sceneNode;
+		}
+
+		SetSceneManager(*sceneNode, this, slot);
+		m_SceneNodeCount++;
+
+		Insert(slot, sceneNode->GetWorldAABB());
+	}
+
+	void GridSceneManager::AddSceneNodeRecursively(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		AddSceneNode(sceneNode);
+
+		for (unsigned int i = 0; i < sceneNode->GetChildCount(); i++)
+			AddSceneNodeRecursively(sceneNode->GetChildAt(i));
+	}
+
+	void GridSceneManager::RemoveSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		if (sceneNode->GetSceneManager() != this)
+			return;
+
+		unsigned int slot = GetSceneManagerIndex(*sceneNode);
+
+		Erase(slot);
+		SetSceneManager(*sceneNode, nullptr);
+
+		m_FreeSlots.push_back(slot);
+		m_SceneNodeCount--;
+
+		// sceneNode might be a reference to the slot itself.
+		m_SceneNodes[slot].reset();
+	}
+
+	void GridSceneManager::UpdateSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		if (sceneNode->GetSceneManager() != this)
+			return;
+
+		unsigned int slot = GetSceneManagerIndex(*sceneNode);
+		unsigned int cellIndex = m_SlotCells[slot];
+		BoxBounds aabb = sceneNode->GetWorldAABB();
+
+		if (cellIndex != InvalidIndex && !aabb.GetInfinite())
+		{
+			Cell &cell = m_Cells[cellIndex];
+			Vector4 center = aabb.GetCenter();
+
+			// still in the same cell, only the bounds change.
+			if (GetCellCoord(center.x) == cell.x && GetCellCoord(center.y) == cell.y && GetCellCoord(center.z) == cell.z)
+			{
+				Vector4 extents = aabb.GetExtents();
+				m_MaxExtents.x = std::max(m_MaxExtents.x, extents.x);
+				m_MaxExtents.y = std::max(m_MaxExtents.y, extents.y);
+				m_MaxExtents.z = std::max(m_MaxExtents.z, extents.z);
+
+				cell.bounds.Set(m_SlotPositions[slot], aabb);
+				return;
+			}
+		}
+
+		Erase(slot);
+		Insert(slot, aabb);
+	}
+
+	void GridSceneManager::WalkScene(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags) const
+	{
+		if (flags != 0)
+		{
+			WalkScene(collider, [&](const SceneNode::Ptr &sceneNode)
+			{
+				if (sceneNode->GetComponentFlags() & flags)
+					filterFunc(sceneNode);
+			});
+			return;
+		}
+
+		for (auto slot : m_InfiniteSlots)
+			filterFunc(m_SceneNodes[slot]);
+
+		BoxBounds colliderBounds;
+		bool bounded = GetColliderBounds(collider, colliderBounds);
+
+		if (bounded)
+		{
+			// cells whose loose bounds can touch the collider's aabb.
+			Vector4 min = colliderBounds.GetMin() - m_MaxExtents;
+			Vector4 max = colliderBounds.GetMax() + m_MaxExtents;
+
+			int minX = GetCellCoord(min.x), minY = GetCellCoord(min.y), minZ = GetCellCoord(min.z);
+			int maxX = GetCellCoord(max.x), maxY = GetCellCoord(max.y), maxZ = GetCellCoord(max.z);
+
+			double footprint = (double)(maxX - minX + 1) * (maxY - minY + 1) * (maxZ - minZ + 1);
+
+			if (footprint <= m_CellMap.size())
+			{
+				for (int x = minX; x <= maxX; x++)
+				{
+					for (int y = minY; y <= maxY; y++)
+					{
+						for (int z = minZ; z <= maxZ; z++)
+						{
+							auto it = m_CellMap.find(GetCellKey(x, y, z));
+							if (it != m_CellMap.end())
+								WalkCell(collider, m_Cells[it->second], filterFunc);
+						}
+					}
+				}
+				return;
+			}
+
+			// the footprint is larger than the occupied cells, visit those instead.
+			for (const auto &cell : m_Cells)
+			{
+				if (cell.x >= minX && cell.x <= maxX && cell.y >= minY && cell.y <= maxY && cell.z >= minZ && cell.z <= maxZ)
+					WalkCell(collider, cell, filterFunc);
+			}
+			return;
+		}
+
+		for (const auto &cell : m_Cells)
+			WalkCell(collider, cell, filterFunc);
+	}
+
+	void GridSceneManager::Clear()
+	{
+		for (auto &sceneNode : m_SceneNodes)
+		{
+			if (sceneNode != nullptr)
+				SetSceneManager(*sceneNode, nullptr);
+		}
+
+		m_SceneNodes.clear();
+		m_FreeSlots.clear();
+		m_SceneNodeCount = 0;
+
+		m_SlotCells.clear();
+		m_SlotPositions.clear();
+		m_Cells.clear();
+		m_CellMap.clear();
+		m_InfiniteSlots.clear();
+
+		m_MaxExtents = Vector4(0.0f);
+	}
+
+	float GridSceneManager::GetCellSize() const
+	{
+		return m_CellSize;
+	}
+
+	unsigned int GridSceneManager::GetSceneNodeCount() const
+	{
+		return m_SceneNodeCount;
+	}
+
+	unsigned int GridSceneManager::GetOccupiedCellCount() const
+	{
+		unsigned int count = 0;
+		for (const auto &cell : m_Cells)
+		{
+			if (!cell.slots.empty())
+				count++;
+		}
+		return count;
+	}
+
+	void GridSceneManager::Insert(unsigned int slot, const BoxBounds &aabb)
+	{
+		if (aabb.GetInfinite())
+		{
+			m_SlotCells[slot] = InvalidIndex;
+			m_SlotPositions[slot] = m_InfiniteSlots.size();
+			m_InfiniteSlots.push_back(slot);
+			return;
+		}
+
+		Vector4 center = aabb.GetCenter();
+		Vector4 extents = aabb.GetExtents();
+
+		m_MaxExtents.x = std::max(m_MaxExtents.x, extents.x);
+		m_MaxExtents.y = std::max(m_MaxExtents.y, extents.y);
+		m_MaxExtents.z = std::max(m_MaxExtents.z, extents.z);
+
+		unsigned int cellIndex = GetCell(GetCellCoord(center.x), GetCellCoord(center.y), GetCellCoord(center.z));
+		Cell &cell = m_Cells[cellIndex];
+
+		m_SlotCells[slot] = cellIndex;
+		m_SlotPositions[slot] = cell.slots.size();
+
+		cell.slots.push_back(slot);
+		cell.bounds.Add(aabb);
+	}
+
+	void GridSceneManager::Erase(unsigned int slot)
+	{
+		unsigned int cellIndex = m_SlotCells[slot];
+		unsigned int position = m_SlotPositions[slot];
+
+		std::vector<unsigned int> &slots = cellIndex == InvalidIndex ? m_InfiniteSlots : m_Cells[cellIndex].slots;
+
+		// move the last one into the hole.
+		unsigned int last = slots.back();
+		slots[position] = last;
+		m_SlotPositions[last] = position;
+		slots.pop_back();
+
+		if (cellIndex != InvalidIndex)
+			m_Cells[cellIndex].bounds.RemoveAt(position);
+
+		m_SlotCells[slot] = InvalidIndex;
+		m_SlotPositions[slot] = InvalidIndex;
+	}
+
+	unsigned int GridSceneManager::GetCell(int x, int y, int z)
+	{
+		auto result = m_CellMap.emplace(GetCellKey(x, y, z), m_Cells.size());
+		if (result.second)
+		{
+			m_Cells.push_back(Cell());
+
+			Cell &cell = m_Cells.back();
+			cell.x = x;
+			cell.y = y;
+			cell.z = z;
+		}
+		return result.first->second;
+	}
+
+	int GridSceneManager::GetCellCoord(float value) const
+	{
+		// keep coords in the 21 bits GetCellKey packs.
+		float coord = std::floor(value / m_CellSize);
+		return (int)std::max(-1048576.0f, std::min(coord, 1048575.0f));
+	}
+
+	BoxBounds GridSceneManager::GetCellBounds(const Cell &cell) const
+	{
+		Vector4 min(cell.x * m_CellSize, cell.y * m_CellSize, cell.z * m_CellSize);
+		Vector4 max = min + Vector4(m_CellSize);
+		return BoxBounds(min - m_MaxExtents, max + m_MaxExtents);
+	}
+
+	void GridSceneManager::WalkCell(const Collidable &collider, const Cell &cell, const FilterFunc &filterFunc) const
+	{
+		unsigned int count = cell.slots.size();
+		if (count == 0)
+			return;
+
+		Side side = collider.IsInside(GetCellBounds(cell));
+		if (side == Side::OUT)
+			return;
+
+		if (side == Side::IN)
+		{
+			for (auto slot : cell.slots)
+				filterFunc(m_SceneNodes[slot]);
+			return;
+		}
+
+		// test cell's scenenodes, a batch at a time.
+		const unsigned int batchSize = 64;
+		unsigned int visibles[batchSize];
+
+		for (unsigned int begin = 0; begin < count; begin += batchSize)
+		{
+			unsigned int end = std::min(begin + batchSize, count);
+			unsigned int visibleCount = collider.IsInsideFastBatch(cell.bounds, begin, end, visibles);
+			for (unsigned int i = 0; i < visibleCount; i++)
+				filterFunc(m_SceneNodes[cell.slots[visibles[i]]]);
+		}
+	}
+
+	bool GridSceneManager::GetColliderBounds(const Collidable &collider, BoxBounds &aabb)
+	{
+		if (auto frustum = dynamic_cast<const Frustum*>(&collider))
+		{
+			aabb = frustum->GetBoxBounds();
+		}
+		else if (auto box = dynamic_cast<const BoxBounds*>(&collider))
+		{
+			aabb = *box;
+		}
+		else if (auto sphere = dynamic_cast<const SphereBounds*>(&collider))
+		{
+			if (sphere->GetInfinite())
+				return false;
+
+			Vector4 radius(sphere->GetRadius());
+			aabb = BoxBounds(sphere->GetCenter() - radius, sphere->GetCenter() + radius);
+		}
+		else
+		{
+			return false;
+		}
+
+		return !aabb.GetInfinite();
+	}
+
+	unsigned long long GridSceneManager::GetCellKey(int x, int y, int z)
+	{
+		const unsigned long long mask = 0x1fffff;
+		return ((unsigned long long)(x & mask) << 42) | ((unsigned long long)(y & mask) << 21) | (unsigned long long)(z & mask);
+	}
+}
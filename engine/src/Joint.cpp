@@ -55,6 +55,11 @@ namespace fury
 	}
 
 	void Joint::Update(const Matrix4 &matrix)
+	{
+		Update(AffineMatrix(matrix));
+	}
+
+	void Joint::Update(const AffineMatrix &matrix)
 	{
 		m_CombinedMatrix = matrix * m_LocalMatrix;
 		m_FinalMatrix = m_CombinedMatrix * m_OffsetMatrix;
@@ -66,9 +71,9 @@ namespace fury
 
 	void Joint::Update(float dt)
 	{
-		m_LocalMatrix.Translate(m_Position.first + (m_Position.second - m_Position.first) * dt); 
-		m_LocalMatrix.AppendRotation(m_Rotation.first.Slerp(m_Rotation.second, dt));
-		m_LocalMatrix.AppendScale(m_Scaling.first + (m_Scaling.second - m_Scaling.first) * dt);
+		m_LocalMatrix.TRS(m_Position.first + (m_Position.second - m_Position.first) * dt, 
+			m_Rotation.first.Slerp(m_Rotation.second, dt), 
+			m_Scaling.first + (m_Scaling.second - m_Scaling.first) * dt);
 	}
 
 	void Joint::SetRotation(Quaternion rot, bool old)
@@ -103,37 +108,37 @@ namespace fury
 
 	void Joint::SetLocalMatrix(const Matrix4 &matrix)
 	{
-		m_LocalMatrix = matrix;
+		m_LocalMatrix = AffineMatrix(matrix);
 	}
 
 	Matrix4 Joint::GetLocalMatrix() const
 	{
-		return m_LocalMatrix;
+		return m_LocalMatrix.ToMatrix4();
 	}
 
 	void Joint::SetCombinedMatrix(const Matrix4 &matrix)
 	{
-		m_CombinedMatrix = matrix;
+		m_CombinedMatrix = AffineMatrix(matrix);
 	}
 
 	Matrix4 Joint::GetCombinedMatrix() const
 	{
-		return m_CombinedMatrix;
+		return m_CombinedMatrix.ToMatrix4();
 	}
 
 	void Joint::SetOffsetMatrix(const Matrix4 &matrix)
 	{
-		m_OffsetMatrix = matrix;
+		m_OffsetMatrix = AffineMatrix(matrix);
 	}
 
 	Matrix4 Joint::GetOffsetMatrix() const
 	{
-		return m_OffsetMatrix;
+		return m_OffsetMatrix.ToMatrix4();
 	}
 
 	Matrix4 Joint::GetFinalMatrix()
 	{
-		return m_FinalMatrix;
+		return m_FinalMatrix.ToMatrix4();
 	}
 
 	Joint::Ptr Joint::GetFirstChild() const
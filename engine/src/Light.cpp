@@ -16,6 +16,11 @@ namespace fury
 		m_TypeIndex = typeid(Light);
 	};
 
+	unsigned int Light::GetComponentFlags() const
+	{
+		return SceneNode::LIGHT | (m_CastShadows ? SceneNode::SHADOW_LIGHT : 0);
+	}
+
 	Component::Ptr Light::Clone() const
 	{
 		auto ptr = Light::Create();
@@ -103,6 +108,9 @@ namespace fury
 	void Light::SetCastShadows(bool cast)
 	{
 		m_CastShadows = cast;
+
+		if (!m_Owner.expired())
+			m_Owner.lock()->UpdateComponentFlags();
 	}
 
 	bool Light::GetCastShadows() const
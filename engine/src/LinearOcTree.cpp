@@ -0,0 +1,413 @@
+#include <algorithm>
+
+#include "BoxBounds.h"
+#include "Collidable.h"
+#include "LinearOcTree.h"
+#include "SceneNode.h"
+#include "Log.h"
+
+namespace fury
+{
+	const unsigned int LinearOcTree::InvalidIndex = 0xffffffff;
+
+	const unsigned int LinearOcTree::MaxDepthLimit = 16;
+
+	LinearOcTree::Ptr LinearOcTree::Create(Vector4 min, Vector4 max, unsigned int maxDepth)
+	{
+		return std::make_shared<LinearOcTree>(min, max, maxDepth);
+	}
+
+	LinearOcTree::LinearOcTree(Vector4 min, Vector4 max, unsigned int maxDepth) :
+		m_TypeIndex(typeid(LinearOcTree)), m_Min(min), m_Max(max), m_MaxDepth(std::min(maxDepth, MaxDepthLimit))
+	{
+		if (maxDepth > MaxDepthLimit)
+			FURYW << "LinearOcTree supports " << MaxDepthLimit << " levels at most!";
+	}
+
+	LinearOcTree::~LinearOcTree()
+	{
+		Clear();
+		FURYD << "LinearOcTree::~LinearOcTree";
+	}
+
+	std::type_index LinearOcTree::GetTypeIndex() const
+	{
+		return m_TypeIndex;
+	}
+
+	void LinearOcTree::AddSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		auto manager = sceneNode->GetSceneManager();
+		if (manager == this)
+		{
+			UpdateSceneNode(sceneNode);
+			return;
+		}
+		else if (manager != nullptr)
+		{
+			manager->RemoveSceneNode(sceneNode);
+		}
+
+		unsigned int slot;
+		if (m_FreeSlots.empty())
+		{
+			slot = m_SceneNodes.size();
+			m_SceneNodes.push_back(sceneNode);
+			m_SlotCodes.push_back(0);
+		}
+		else
+		{
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+			m_SceneNodes[slot] = sceneNode;
+		}
+
+		m_SlotCodes[slot] = GetLocationCode(sceneNode->GetWorldAABB());
+		SetSceneManager(*sceneNode, this, slot);
+
+		m_Dirty = true;
+	}
+
+	void LinearOcTree::AddSceneNodeRecursively(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		AddSceneNode(sceneNode);
+
+		for (unsigned int i = 0; i < sceneNode->GetChildCount(); i++)
+			AddSceneNodeRecursively(sceneNode->GetChildAt(i));
+	}
+
+	void LinearOcTree::RemoveSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		if (sceneNode->GetSceneManager() != this)
+			return;
+
+		unsigned int slot = GetSceneManagerIndex(*sceneNode);
+
+		// leave a hole in the sorted objects, no need to rebuild.
+		if (!m_Dirty)
+			m_ObjectSlots[m_SlotObjects[slot]] = InvalidIndex;
+
+		SetSceneManager(*sceneNode, nullptr);
+
+		m_SlotCodes[slot] = 0;
+		m_FreeSlots.push_back(slot);
+
+		// sceneNode might be a reference to the slot itself.
+		m_SceneNodes[slot].reset();
+	}
+
+	void LinearOcTree::UpdateSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		if (sceneNode->GetSceneManager() != this)
+			return;
+
+		unsigned int slot = GetSceneManagerIndex(*sceneNode);
+		BoxBounds aabb = sceneNode->GetWorldAABB();
+		uint64_t code = GetLocationCode(aabb);
+
+		if (code != m_SlotCodes[slot])
+		{
+			m_SlotCodes[slot] = code;
+			m_Dirty = true;
+		}
+		else if (!m_Dirty)
+		{
+			m_ObjectBounds.Set(m_SlotObjects[slot], aabb);
+		}
+	}
+
+	void LinearOcTree::WalkScene(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags) const
+	{
+		if (flags != 0)
+		{
+			WalkScene(collider, [&](const SceneNode::Ptr &sceneNode)
+			{
+				if (sceneNode->GetComponentFlags() & flags)
+					filterFunc(sceneNode);
+			});
+			return;
+		}
+
+		if (m_Dirty)
+			Rebuild();
+
+		const unsigned int batchSize = 64;
+		unsigned int visibles[batchSize];
+
+		unsigned int cellCount = m_Cells.size();
+		unsigned int index = 0;
+
+		while (index < cellCount)
+		{
+			const Cell &cell = m_Cells[index];
+
+			if (cell.objectBegin == cell.subtreeObjectEnd)
+			{
+				index = cell.skip;
+				continue;
+			}
+
+			Side side = collider.IsInside(BoxBounds(
+				Vector4(cell.min[0], cell.min[1], cell.min[2]),
+				Vector4(cell.max[0], cell.max[1], cell.max[2])));
+
+			if (side == Side::OUT)
+			{
+				index = cell.skip;
+			}
+			else if (side == Side::IN)
+			{
+				// the whole subtree is visible.
+				for (unsigned int i = cell.objectBegin; i < cell.subtreeObjectEnd; i++)
+				{
+					unsigned int slot = m_ObjectSlots[i];
+					if (slot != InvalidIndex)
+						filterFunc(m_SceneNodes[slot]);
+				}
+				index = cell.skip;
+			}
+			else
+			{
+				// test cell's own objects, then step into it's first child.
+				for (unsigned int begin = cell.objectBegin; begin < cell.objectEnd; begin += batchSize)
+				{
+					unsigned int end = std::min(begin + batchSize, cell.objectEnd);
+					unsigned int count = collider.IsInsideFastBatch(m_ObjectBounds, begin, end, visibles);
+					for (unsigned int i = 0; i < count; i++)
+					{
+						unsigned int slot = m_ObjectSlots[visibles[i]];
+						if (slot != InvalidIndex)
+							filterFunc(m_SceneNodes[slot]);
+					}
+				}
+				index++;
+			}
+		}
+	}
+
+	void LinearOcTree::Reset(Vector4 min, Vector4 max, unsigned int maxDepth)
+	{
+		m_Min = min;
+		m_Max = max;
+		m_MaxDepth = std::min(maxDepth, MaxDepthLimit);
+
+		unsigned int slotCount = m_SceneNodes.size();
+		for (unsigned int slot = 0; slot < slotCount; slot++)
+		{
+			if (m_SlotCodes[slot] != 0)
+				m_SlotCodes[slot] = GetLocationCode(m_SceneNodes[slot]->GetWorldAABB());
+		}
+
+		m_Dirty = true;
+	}
+
+	void LinearOcTree::Clear()
+	{
+		for (auto &sceneNode : m_SceneNodes)
+		{
+			if (sceneNode != nullptr)
+				SetSceneManager(*sceneNode, nullptr);
+		}
+
+		m_SceneNodes.clear();
+		m_SlotCodes.clear();
+		m_FreeSlots.clear();
+		m_SlotObjects.clear();
+		m_Cells.clear();
+		m_ObjectSlots.clear();
+		m_ObjectBounds.Clear();
+
+		m_Dirty = true;
+	}
+
+	unsigned int LinearOcTree::GetSceneNodeCount() const
+	{
+		return m_SceneNodes.size() - m_FreeSlots.size();
+	}
+
+	unsigned int LinearOcTree::GetCellCount() const
+	{
+		if (m_Dirty)
+			Rebuild();
+
+		return m_Cells.size();
+	}
+
+	void LinearOcTree::Rebuild() const
+	{
+		// sort key: cell's morton code aligned to max depth, then depth.
+		// this puts cells in depth-first order, parents before childs.
+		m_SortBuffer.clear();
+
+		unsigned int slotCount = m_SceneNodes.size();
+		for (unsigned int slot = 0; slot < slotCount; slot++)
+		{
+			uint64_t code = m_SlotCodes[slot];
+			if (code == 0)
+				continue;
+
+			unsigned int depth = GetCodeDepth(code);
+			uint64_t morton = code ^ ((uint64_t)1 << (3 * depth));
+			m_SortBuffer.push_back(std::make_pair(((morton << (3 * (m_MaxDepth - depth))) << 5) | depth, slot));
+		}
+
+		std::sort(m_SortBuffer.begin(), m_SortBuffer.end());
+
+		m_Cells.clear();
+		m_ObjectSlots.clear();
+		m_ObjectBounds.Clear();
+		m_CellStack.clear();
+		m_SlotObjects.assign(slotCount, InvalidIndex);
+
+		Cell root;
+		root.code = 1;
+		root.depth = 0;
+		root.parent = InvalidIndex;
+		root.skip = InvalidIndex;
+		root.objectBegin = root.objectEnd = root.subtreeObjectEnd = 0;
+		SetCellBounds(root);
+
+		m_CellStack.push_back(0);
+		m_Cells.push_back(root);
+
+		for (const auto &pair : m_SortBuffer)
+		{
+			unsigned int slot = pair.second;
+			unsigned int depth = pair.first & 31;
+			uint64_t code = m_SlotCodes[slot];
+
+			// close cells that don't contain this one, root contains all.
+			while (true)
+			{
+				Cell &top = m_Cells[m_CellStack.back()];
+				if (top.depth <= depth && (code >> (3 * (depth - top.depth))) == top.code)
+					break;
+
+				top.skip = m_Cells.size();
+				top.subtreeObjectEnd = m_ObjectSlots.size();
+				m_CellStack.pop_back();
+			}
+
+			// open cells down to this one.
+			for (unsigned int d = m_Cells[m_CellStack.back()].depth + 1; d <= depth; d++)
+			{
+				Cell cell;
+				cell.code = code >> (3 * (depth - d));
+				cell.depth = d;
+				cell.parent = m_CellStack.back();
+				cell.skip = InvalidIndex;
+				cell.objectBegin = cell.objectEnd = cell.subtreeObjectEnd = m_ObjectSlots.size();
+				SetCellBounds(cell);
+
+				m_CellStack.push_back(m_Cells.size());
+				m_Cells.push_back(cell);
+			}
+
+			m_SlotObjects[slot] = m_ObjectSlots.size();
+			m_ObjectSlots.push_back(slot);
+			m_ObjectBounds.Add(m_SceneNodes[slot]->GetWorldAABB());
+
+			m_Cells[m_CellStack.back()].objectEnd = m_ObjectSlots.size();
+		}
+
+		while (!m_CellStack.empty())
+		{
+			Cell &top = m_Cells[m_CellStack.back()];
+			top.skip = m_Cells.size();
+			top.subtreeObjectEnd = m_ObjectSlots.size();
+			m_CellStack.pop_back();
+		}
+
+		m_Dirty = false;
+	}
+
+	uint64_t LinearOcTree::GetLocationCode(const BoxBounds &aabb) const
+	{
+		if (aabb.GetInfinite())
+			return 1;
+
+		Vector4 min = aabb.GetMin();
+		Vector4 max = aabb.GetMax();
+
+		if (min.x < m_Min.x || min.y < m_Min.y || min.z < m_Min.z ||
+			max.x > m_Max.x || max.y > m_Max.y || max.z > m_Max.z)
+			return 1;
+
+		// quantize aabb to the grid of max depth.
+		unsigned int resolution = 1u << m_MaxDepth;
+		unsigned int last = resolution - 1;
+		float scaleX = resolution / (m_Max.x - m_Min.x);
+		float scaleY = resolution / (m_Max.y - m_Min.y);
+		float scaleZ = resolution / (m_Max.z - m_Min.z);
+
+		unsigned int minX = std::min((unsigned int)((min.x - m_Min.x) * scaleX), last);
+		unsigned int minY = std::min((unsigned int)((min.y - m_Min.y) * scaleY), last);
+		unsigned int minZ = std::min((unsigned int)((min.z - m_Min.z) * scaleZ), last);
+		unsigned int maxX = std::min((unsigned int)((max.x - m_Min.x) * scaleX), last);
+		unsigned int maxY = std::min((unsigned int)((max.y - m_Min.y) * scaleY), last);
+		unsigned int maxZ = std::min((unsigned int)((max.z - m_Min.z) * scaleZ), last);
+
+		// deepest level where min and max fall in the same cell.
+		unsigned int diff = (minX ^ maxX) | (minY ^ maxY) | (minZ ^ maxZ);
+		unsigned int shift = 0;
+		while ((diff >> shift) != 0)
+			shift++;
+
+		unsigned int depth = m_MaxDepth - shift;
+		uint64_t morton = SpreadBits(minX >> shift) | (SpreadBits(minY >> shift) << 1) | (SpreadBits(minZ >> shift) << 2);
+
+		return ((uint64_t)1 << (3 * depth)) | morton;
+	}
+
+	unsigned int LinearOcTree::GetCodeDepth(uint64_t code) const
+	{
+		unsigned int depth = 0;
+		while (code > 1)
+		{
+			code >>= 3;
+			depth++;
+		}
+		return depth;
+	}
+
+	void LinearOcTree::SetCellBounds(Cell &cell) const
+	{
+		uint64_t morton = cell.code ^ ((uint64_t)1 << (3 * cell.depth));
+		float count = (float)(1u << cell.depth);
+
+		Vector4 size = (m_Max - m_Min) / count;
+		Vector4 min = m_Min + Vector4(
+			CompactBits(morton) * size.x,
+			CompactBits(morton >> 1) * size.y,
+			CompactBits(morton >> 2) * size.z, 0.0f);
+
+		cell.min[0] = min.x;
+		cell.min[1] = min.y;
+		cell.min[2] = min.z;
+		cell.max[0] = min.x + size.x;
+		cell.max[1] = min.y + size.y;
+		cell.max[2] = min.z + size.z;
+	}
+
+	uint64_t LinearOcTree::SpreadBits(uint64_t value) const
+	{
+		value &= 0x1fffff;
+		value = (value | value << 32) & 0x1f00000000ffff;
+		value = (value | value << 16) & 0x1f0000ff0000ff;
+		value = (value | value << 8) & 0x100f00f00f00f00f;
+		value = (value | value << 4) & 0x10c30c30c30c30c3;
+		value = (value | value << 2) & 0x1249249249249249;
+		return value;
+	}
+
+	uint64_t LinearOcTree::CompactBits(uint64_t value) const
+	{
+		value &= 0x1249249249249249;
+		value = (value ^ (value >> 2)) & 0x10c30c30c30c30c3;
+		value = (value ^ (value >> 4)) & 0x100f00f00f00f00f;
+		value = (value ^ (value >> 8)) & 0x1f0000ff0000ff;
+		value = (value ^ (value >> 16)) & 0x1f00000000ffff;
+		value = (value ^ (value >> 32)) & 0x1fffff;
+		return value;
+	}
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "Log.h"
 #include "GLLoader.h"
 #include "Material.h"
+#include "SceneNode.h"
 #include "Texture.h"
 #include "Uniform.h"
 
@@ -188,5 +189,6 @@ namespace fury
 	void Material::SetOpaque(bool value)
 	{
 		m_Opaque = value;
+		SceneNode::InvalidateComponentFlags();
 	}
 }
\ No newline at end of file
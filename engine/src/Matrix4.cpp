@@ -6,6 +6,10 @@
 #include "Plane.h"
 #include "Quaternion.h"
 
+#if defined(FURY_USE_SSE)
+#include <emmintrin.h>
+#endif
+
 namespace fury
 {
 	std::string Matrix4::PROJECTION_MATRIX = "projection_matrix";
@@ -13,11 +17,6 @@ namespace fury
 	std::string Matrix4::INVERT_VIEW_MATRIX = "invert_view_matrix";
 
 	std::string Matrix4::WORLD_MATRIX = "world_matrix";
-	
-	Matrix4::Matrix4()
-	{
-		Identity();
-	}
 
 	Matrix4::Matrix4(const float raw[])
 	{
@@ -29,19 +28,6 @@ namespace fury
 		ASSERT_MSG(raw.size() == 16, "Incorrect matrix data size!");
 		std::copy(raw.begin(), raw.end(), Raw);
 	}
-
-	Matrix4::Matrix4(const Matrix4 &other) 
-	{
-		for(int i = 0; i < 16; i++) Raw[i] = other.Raw[i];
-	}
-
-	void Matrix4::Identity()
-	{
-		Raw[0] = 1.0f; Raw[4] = 0.0f; Raw[8] = 0.0f; Raw[12] = 0.0f;
-		Raw[1] = 0.0f; Raw[5] = 1.0f; Raw[9] = 0.0f; Raw[13] = 0.0f;
-		Raw[2] = 0.0f; Raw[6] = 0.0f; Raw[10] = 1.0f; Raw[14] = 0.0f;
-		Raw[3] = 0.0f; Raw[7] = 0.0f; Raw[11] = 0.0f; Raw[15] = 1.0f;
-	}
 	
 	void Matrix4::Translate(Vector4 position)
 	{
@@ -180,16 +166,6 @@ namespace fury
 		return Matrix4(data);
 	}
 
-	Vector4 Matrix4::Multiply(Vector4 data) const
-	{
-		return Vector4(
-			data.x * Raw[0] + data.y * Raw[4] + data.z * Raw[8] + data.w * Raw[12],
-			data.x * Raw[1] + data.y * Raw[5] + data.z * Raw[9] + data.w * Raw[13],
-			data.x * Raw[2] + data.y * Raw[6] + data.z * Raw[10] + data.w * Raw[14],
-			data.x * Raw[3] + data.y * Raw[7] + data.z * Raw[11] + data.w * Raw[15]
-		);
-	}
-
 	Quaternion Matrix4::Multiply(Quaternion data) const
 	{
 		Vector4 axis = MathUtil::QuatToAxisRad(data);
@@ -203,38 +179,58 @@ namespace fury
 
 	BoxBounds Matrix4::Multiply(const BoxBounds &aabb) const
 	{
-		Vector4 max = aabb.GetMax();
+		// arvo's method, each column scaled by min and max, the smaller one goes to the new min.
 		Vector4 min = aabb.GetMin();
+		Vector4 max = aabb.GetMax();
 
-		Vector4 vertices[] = {
-			Multiply(Vector4(min, 1.0f)),
-			Multiply(Vector4(max.x, min.y, min.z, 1.0f)),
-			Multiply(Vector4(min.x, max.y, min.z, 1.0f)),
-			Multiply(Vector4(max.x, max.y, min.z, 1.0f)),
-			Multiply(Vector4(min.x, min.y, max.z, 1.0f)),
-			Multiply(Vector4(max.x, min.y, max.z, 1.0f)),
-			Multiply(Vector4(min.x, max.y, max.z, 1.0f)),
-			Multiply(Vector4(max, 1.0f))
-		};
-
-		max = min = vertices[0];
-
-		for (Vector4 &vt : vertices)
+#if defined(FURY_USE_SSE)
+		__m128 vMin = _mm_loadu_ps(&min.x);
+		__m128 vMax = _mm_loadu_ps(&max.x);
+		__m128 newMin = _mm_loadu_ps(Raw + 12);
+		__m128 newMax = newMin;
+
+		__m128 column = _mm_loadu_ps(Raw);
+		__m128 a = _mm_mul_ps(column, _mm_shuffle_ps(vMin, vMin, _MM_SHUFFLE(0, 0, 0, 0)));
+		__m128 b = _mm_mul_ps(column, _mm_shuffle_ps(vMax, vMax, _MM_SHUFFLE(0, 0, 0, 0)));
+		newMin = _mm_add_ps(newMin, _mm_min_ps(a, b));
+		newMax = _mm_add_ps(newMax, _mm_max_ps(a, b));
+
+		column = _mm_loadu_ps(Raw + 4);
+		a = _mm_mul_ps(column, _mm_shuffle_ps(vMin, vMin, _MM_SHUFFLE(1, 1, 1, 1)));
+		b = _mm_mul_ps(column, _mm_shuffle_ps(vMax, vMax, _MM_SHUFFLE(1, 1, 1, 1)));
+		newMin = _mm_add_ps(newMin, _mm_min_ps(a, b));
+		newMax = _mm_add_ps(newMax, _mm_max_ps(a, b));
+
+		column = _mm_loadu_ps(Raw + 8);
+		a = _mm_mul_ps(column, _mm_shuffle_ps(vMin, vMin, _MM_SHUFFLE(2, 2, 2, 2)));
+		b = _mm_mul_ps(column, _mm_shuffle_ps(vMax, vMax, _MM_SHUFFLE(2, 2, 2, 2)));
+		newMin = _mm_add_ps(newMin, _mm_min_ps(a, b));
+		newMax = _mm_add_ps(newMax, _mm_max_ps(a, b));
+
+		_mm_storeu_ps(&min.x, newMin);
+		_mm_storeu_ps(&max.x, newMax);
+		min.w = max.w = 1.0f;
+#else
+		float newMin[3] = { Raw[12], Raw[13], Raw[14] };
+		float newMax[3] = { Raw[12], Raw[13], Raw[14] };
+		const float vMin[3] = { min.x, min.y, min.z };
+		const float vMax[3] = { max.x, max.y, max.z };
+
+		for (int j = 0; j < 3; j++)
 		{
-			if (vt.x > max.x)
-				max.x = vt.x;
-			else if (vt.x < min.x)
-				min.x = vt.x;
-			if (vt.y > max.y)
-				max.y = vt.y;
-			else if (vt.y < min.y)
-				min.y = vt.y;
-			if (vt.z > max.z)
-				max.z = vt.z;
-			else if (vt.z < min.z)
-				min.z = vt.z;
+			for (int i = 0; i < 3; i++)
+			{
+				float a = Raw[j * 4 + i] * vMin[j];
+				float b = Raw[j * 4 + i] * vMax[j];
+				newMin[i] += a < b ? a : b;
+				newMax[i] += a < b ? b : a;
+			}
 		}
 
+		min = Vector4(newMin[0], newMin[1], newMin[2], 1.0f);
+		max = Vector4(newMax[0], newMax[1], newMax[2], 1.0f);
+#endif
+
 		return BoxBounds(min, max);
 	}
 
@@ -249,7 +245,47 @@ namespace fury
 	Matrix4 Matrix4::Inverse() const
 	{
 		Matrix4 output;
-		
+
+#if defined(FURY_USE_SSE)
+		// rows of the inverted 3x3 are the cross products of it's columns, over the determinant.
+		__m128 c0 = _mm_loadu_ps(Raw);
+		__m128 c1 = _mm_loadu_ps(Raw + 4);
+		__m128 c2 = _mm_loadu_ps(Raw + 8);
+
+		__m128 c0yzx = _mm_shuffle_ps(c0, c0, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 c0zxy = _mm_shuffle_ps(c0, c0, _MM_SHUFFLE(3, 1, 0, 2));
+		__m128 c1yzx = _mm_shuffle_ps(c1, c1, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 c1zxy = _mm_shuffle_ps(c1, c1, _MM_SHUFFLE(3, 1, 0, 2));
+		__m128 c2yzx = _mm_shuffle_ps(c2, c2, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 c2zxy = _mm_shuffle_ps(c2, c2, _MM_SHUFFLE(3, 1, 0, 2));
+
+		__m128 r0 = _mm_sub_ps(_mm_mul_ps(c1yzx, c2zxy), _mm_mul_ps(c1zxy, c2yzx));
+		__m128 r1 = _mm_sub_ps(_mm_mul_ps(c2yzx, c0zxy), _mm_mul_ps(c2zxy, c0yzx));
+		__m128 r2 = _mm_sub_ps(_mm_mul_ps(c0yzx, c1zxy), _mm_mul_ps(c0zxy, c1yzx));
+
+		__m128 dot = _mm_mul_ps(c0, r0);
+		float det = _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(1, 1, 1, 1))), _mm_movehl_ps(dot, dot)));
+		if(det != 0)
+		{
+			__m128 det2 = _mm_set1_ps(1.0f / det);
+			r0 = _mm_mul_ps(r0, det2);
+			r1 = _mm_mul_ps(r1, det2);
+			r2 = _mm_mul_ps(r2, det2);
+			__m128 r3 = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+			__m128 t = _mm_mul_ps(r0, _mm_set1_ps(Raw[12]));
+			t = _mm_add_ps(t, _mm_mul_ps(r1, _mm_set1_ps(Raw[13])));
+			t = _mm_add_ps(t, _mm_mul_ps(r2, _mm_set1_ps(Raw[14])));
+
+			// w lanes come from the zero row r3.
+			_mm_storeu_ps(output.Raw, r0);
+			_mm_storeu_ps(output.Raw + 4, r1);
+			_mm_storeu_ps(output.Raw + 8, r2);
+			_mm_storeu_ps(output.Raw + 12, _mm_xor_ps(t, _mm_set1_ps(-0.0f)));
+			output.Raw[15] = 1.0f;
+		}
+#else
 		float det = Raw[0] * (Raw[5] * Raw[10] - Raw[6] * Raw[9])
 					+ Raw[1] * (Raw[6] * Raw[8] - Raw[4] * Raw[10])
 					+ Raw[2] * (Raw[4] * Raw[9] - Raw[5] * Raw[8]);
@@ -273,6 +309,7 @@ namespace fury
 			output.Raw[14] = -(Raw[12] * output.Raw[2] + Raw[13] * output.Raw[6] + Raw[14] * output.Raw[10]);
 			output.Raw[15] = 1.0f;
 		}
+#endif
 		
 		return output;
 	}
@@ -281,58 +318,4 @@ namespace fury
 	{
 		return Matrix4(this->Raw);
 	}
-
-	bool Matrix4::operator == (const Matrix4 &other) const
-	{
-		for(int i = 0; i < 16; i++)
-		{
-			if(Raw[i] != other.Raw[i]) 
-				return false;
-		}
-		return true;
-	}
-	
-	bool Matrix4::operator != (const Matrix4 &other) const
-	{
-		for(int i = 0; i < 16; i++)
-		{
-			if(Raw[i] != other.Raw[i]) 
-				return true;
-		}
-		return false;
-	}
-
-	Matrix4 &Matrix4::operator = (const Matrix4 &other)
-	{
-		for(int i = 0; i < 16; i++)
-			Raw[i] = other.Raw[i];
-		return *this;
-	}
-
-	Matrix4 Matrix4::operator * (const Matrix4 &other) const
-	{
-		Matrix4 output;
-		
-		output.Raw[0] = Raw[0] * other.Raw[0] + Raw[4] * other.Raw[1] + Raw[8]	* other.Raw[2] + Raw[12] * other.Raw[3];
-		output.Raw[1] = Raw[1] * other.Raw[0] + Raw[5] * other.Raw[1] + Raw[9]	* other.Raw[2] + Raw[13] * other.Raw[3];
-		output.Raw[2] = Raw[2] * other.Raw[0] + Raw[6] * other.Raw[1] + Raw[10] * other.Raw[2] + Raw[14] * other.Raw[3];
-		output.Raw[3] = Raw[3] * other.Raw[0] + Raw[7] * other.Raw[1] + Raw[11] * other.Raw[2] + Raw[15] * other.Raw[3];
-
-		output.Raw[4] = Raw[0] * other.Raw[4] + Raw[4] * other.Raw[5] + Raw[8]	* other.Raw[6] + Raw[12] * other.Raw[7];
-		output.Raw[5] = Raw[1] * other.Raw[4] + Raw[5] * other.Raw[5] + Raw[9]	* other.Raw[6] + Raw[13] * other.Raw[7];
-		output.Raw[6] = Raw[2] * other.Raw[4] + Raw[6] * other.Raw[5] + Raw[10] * other.Raw[6] + Raw[14] * other.Raw[7];
-		output.Raw[7] = Raw[3] * other.Raw[4] + Raw[7] * other.Raw[5] + Raw[11] * other.Raw[6] + Raw[15] * other.Raw[7];
-
-		output.Raw[8] = Raw[0] * other.Raw[8] + Raw[4] * other.Raw[9] + Raw[8] * other.Raw[10] + Raw[12] * other.Raw[11];
-		output.Raw[9] = Raw[1] * other.Raw[8] + Raw[5] * other.Raw[9] + Raw[9] * other.Raw[10] + Raw[13] * other.Raw[11];
-		output.Raw[10] = Raw[2] * other.Raw[8] + Raw[6] * other.Raw[9] + Raw[10] * other.Raw[10] + Raw[14] * other.Raw[11];
-		output.Raw[11] = Raw[3] * other.Raw[8] + Raw[7] * other.Raw[9] + Raw[11] * other.Raw[10] + Raw[15] * other.Raw[11];
-
-		output.Raw[12] = Raw[0] * other.Raw[12] + Raw[4] * other.Raw[13] + Raw[8] * other.Raw[14] + Raw[12] * other.Raw[15];
-		output.Raw[13] = Raw[1] * other.Raw[12] + Raw[5] * other.Raw[13] + Raw[9] * other.Raw[14] + Raw[13] * other.Raw[15];
-		output.Raw[14] = Raw[2] * other.Raw[12] + Raw[6] * other.Raw[13] + Raw[10] * other.Raw[14] + Raw[14] * other.Raw[15];
-		output.Raw[15] = Raw[3] * other.Raw[12] + Raw[7] * other.Raw[13] + Raw[11] * other.Raw[14] + Raw[15] * other.Raw[15];
-		
-		return output;
-	}
 }
\ No newline at end of file
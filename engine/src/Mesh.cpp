@@ -3,6 +3,7 @@
 #include "Log.h"
 #include "GLLoader.h"
 #include "Mesh.h"
+#include "MeshBvh.h"
 #include "SceneNode.h"
 #include "Joint.h"
 
@@ -265,5 +266,21 @@ namespace fury
 	void Mesh::SetCastShadows(bool state)
 	{
 		m_CastShadows = state;
+		SceneNode::InvalidateComponentFlags();
+	}
+
+	void Mesh::BuildRayCastBvh(unsigned int maxLeafSize)
+	{
+		m_RayCastBvh = MeshBvh::Create(*this, maxLeafSize);
+	}
+
+	void Mesh::DeleteRayCastBvh()
+	{
+		m_RayCastBvh.reset();
+	}
+
+	std::shared_ptr<MeshBvh> Mesh::GetRayCastBvh() const
+	{
+		return m_RayCastBvh;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cfloat>
+
+#include "Mesh.h"
+#include "MeshBvh.h"
+#include "Ray.h"
+
+namespace fury
+{
+	MeshBvh::Ptr MeshBvh::Create(const Mesh &mesh, unsigned int maxLeafSize)
+	{
+		return std::make_shared<MeshBvh>(mesh, maxLeafSize);
+	}
+
+	MeshBvh::MeshBvh(const Mesh &mesh, unsigned int maxLeafSize) : 
+		m_MaxLeafSize(std::max(maxLeafSize, 1u))
+	{
+		if (mesh.GetSubMeshCount() > 0)
+		{
+			for (unsigned int i = 0; i < mesh.GetSubMeshCount(); i++)
+				AddTriangles(mesh.Positions.Data, mesh.GetSubMeshAt(i)->Indices.Data);
+		}
+		else
+		{
+			AddTriangles(mesh.Positions.Data, mesh.Indices.Data);
+		}
+
+		unsigned int triangleCount = m_Vertices.size() / 9;
+		if (triangleCount == 0)
+			return;
+
+		std::vector<BuildItem> items(triangleCount);
+		for (unsigned int i = 0; i < triangleCount; i++)
+		{
+			const float *v = &m_Vertices[i * 9];
+
+			items[i].triangle = i;
+			for (int axis = 0; axis < 3; axis++)
+				items[i].center[axis] = (v[axis] + v[axis + 3] + v[axis + 6]) / 3.0f;
+		}
+
+		// unsorted copy, BuildNode writes triangles back in leaf order.
+		std::vector<float> vertices;
+		vertices.swap(m_Vertices);
+		m_Vertices.reserve(vertices.size());
+		m_Triangles.reserve(triangleCount);
+
+		BuildNode(items, vertices, 0, triangleCount);
+	}
+
+	bool MeshBvh::RayCast(const Ray &ray, float maxDistance, float &distance, unsigned int *triangle) const
+	{
+		if (m_Nodes.empty())
+			return false;
+
+		float entry;
+		if (!ray.Intersects(m_Nodes[0].min, m_Nodes[0].max, maxDistance, entry))
+			return false;
+
+		bool hit = false;
+		float nearest = maxDistance;
+
+		// depth is log2 of the triangle count, 64 is plenty.
+		std::pair<unsigned int, float> stack[64];
+		unsigned int stackSize = 0;
+		stack[stackSize++] = std::make_pair(0u, entry);
+
+		while (stackSize > 0)
+		{
+			auto top = stack[--stackSize];
+			if (top.second > nearest)
+				continue;
+
+			unsigned int index = top.first;
+			const Node &node = m_Nodes[index];
+
+			if (node.skip == index + 1)
+			{
+				for (unsigned int i = node.triangleBegin; i < node.triangleEnd; i++)
+				{
+					const float *v = &m_Vertices[i * 9];
+
+					float t;
+					if (ray.Intersects(Vector4(v[0], v[1], v[2]), Vector4(v[3], v[4], v[5]), Vector4(v[6], v[7], v[8]), nearest, t))
+					{
+						hit = true;
+						nearest = t;
+						if (triangle != nullptr)
+							*triangle = m_Triangles[i];
+					}
+				}
+				continue;
+			}
+
+			unsigned int left = index + 1;
+			unsigned int right = m_Nodes[left].skip;
+
+			float leftEntry, rightEntry;
+			bool leftHit = ray.Intersects(m_Nodes[left].min, m_Nodes[left].max, nearest, leftEntry);
+			bool rightHit = ray.Intersects(m_Nodes[right].min, m_Nodes[right].max, nearest, rightEntry);
+
+			// push the far child first, so the near one is visited first.
+			if (leftHit && rightHit && leftEntry < rightEntry)
+			{
+				stack[stackSize++] = std::make_pair(right, rightEntry);
+				stack[stackSize++] = std::make_pair(left, leftEntry);
+			}
+			else
+			{
+				if (leftHit)
+					stack[stackSize++] = std::make_pair(left, leftEntry);
+				if (rightHit)
+					stack[stackSize++] = std::make_pair(right, rightEntry);
+			}
+		}
+
+		if (hit)
+			distance = nearest;
+
+		return hit;
+	}
+
+	unsigned int MeshBvh::GetTriangleCount() const
+	{
+		return m_Triangles.size();
+	}
+
+	unsigned int MeshBvh::GetNodeCount() const
+	{
+		return m_Nodes.size();
+	}
+
+	void MeshBvh::AddTriangles(const std::vector<float> &positions, const std::vector<unsigned int> &indices)
+	{
+		unsigned int vertexCount = positions.size() / 3;
+
+		for (unsigned int i = 0; i + 2 < indices.size(); i += 3)
+		{
+			if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount)
+				continue;
+
+			for (int k = 0; k < 3; k++)
+			{
+				const float *v = &positions[indices[i + k] * 3];
+				m_Vertices.insert(m_Vertices.end(), v, v + 3);
+			}
+		}
+	}
+
+	unsigned int MeshBvh::BuildNode(std::vector<BuildItem> &items, const std::vector<float> &vertices, unsigned int begin, unsigned int end)
+	{
+		unsigned int index = m_Nodes.size();
+		m_Nodes.push_back(Node());
+
+		float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+		float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		float centerMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+		float centerMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		for (unsigned int i = begin; i < end; i++)
+		{
+			const float *v = &vertices[items[i].triangle * 9];
+			for (int axis = 0; axis < 3; axis++)
+			{
+				min[axis] = std::min(min[axis], std::min(v[axis], std::min(v[axis + 3], v[axis + 6])));
+				max[axis] = std::max(max[axis], std::max(v[axis], std::max(v[axis + 3], v[axis + 6])));
+				centerMin[axis] = std::min(centerMin[axis], items[i].center[axis]);
+				centerMax[axis] = std::max(centerMax[axis], items[i].center[axis]);
+			}
+		}
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			m_Nodes[index].min[axis] = min[axis];
+			m_Nodes[index].max[axis] = max[axis];
+		}
+
+		unsigned int count = end - begin;
+		if (count <= m_MaxLeafSize)
+		{
+			Node &node = m_Nodes[index];
+			node.skip = index + 1;
+			node.triangleBegin = m_Triangles.size();
+
+			for (unsigned int i = begin; i < end; i++)
+			{
+				const float *v = &vertices[items[i].triangle * 9];
+				m_Vertices.insert(m_Vertices.end(), v, v + 9);
+				m_Triangles.push_back(items[i].triangle);
+			}
+
+			node.triangleEnd = m_Triangles.size();
+			return index;
+		}
+
+		int axis = 0;
+		for (int i = 1; i < 3; i++)
+		{
+			if (centerMax[i] - centerMin[i] > centerMax[axis] - centerMin[axis])
+				axis = i;
+		}
+
+		unsigned int mid = begin + count / 2;
+		std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end, 
+			[axis](const BuildItem &a, const BuildItem &b) -> bool
+		{
+			return a.center[axis] < b.center[axis];
+		});
+
+		unsigned int triangleBegin = m_Triangles.size();
+
+		BuildNode(items, vertices, begin, mid);
+		BuildNode(items, vertices, mid, end);
+
+		// m_Nodes might have been reallocated.
+		Node &node = m_Nodes[index];
+		node.skip = m_Nodes.size();
+		node.triangleBegin = triangleBegin;
+		node.triangleEnd = m_Triangles.size();
+
+		return index;
+	}
+}
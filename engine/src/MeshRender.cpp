@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <atomic>
+
 #include "Log.h"
 #include "Mesh.h"
 #include "MeshRender.h"
@@ -12,6 +15,12 @@ namespace fury
 		return std::make_shared<MeshRender>(material, mesh);
 	}
 
+	unsigned int MeshRender::CreateLodView()
+	{
+		static std::atomic<unsigned int> nextView(0);
+		return nextView++;
+	}
+
 	MeshRender::MeshRender(const std::shared_ptr<Material> &material, const std::shared_ptr<Mesh> &mesh)
 		: m_Mesh(mesh) 
 	{
@@ -29,16 +38,52 @@ namespace fury
 			auto material = m_Materials[i];
 			clone->SetMaterial(material.lock(), i);
 		}
+
+		clone->m_Occluder = m_Occluder;
+		clone->m_OccluderMesh = m_OccluderMesh;
+		clone->m_Lods = m_Lods;
+		clone->m_LodHysteresis = m_LodHysteresis;
 		
 		return clone;
 	}
 
+	unsigned int MeshRender::GetComponentFlags() const
+	{
+		// same as GetRenderable, without warning while materials are still being set.
+		auto mesh = m_Mesh.lock();
+		if (mesh == nullptr || m_Materials.size() < mesh->GetSubMeshCount())
+			return 0;
+
+		unsigned int flags = SceneNode::RENDERABLE;
+
+		for (auto material : m_Materials)
+		{
+			auto ptr = material.lock();
+			if (ptr == nullptr)
+				return 0;
+
+			if (!ptr->GetOpaque())
+				flags |= SceneNode::TRANSLUCENT;
+		}
+
+		if (mesh->GetCastShadows())
+			flags |= SceneNode::SHADOW_CASTER;
+
+		if (m_Occluder)
+			flags |= SceneNode::OCCLUDER;
+
+		return flags;
+	}
+
 	void MeshRender::SetMaterial(const std::shared_ptr<Material> &material, unsigned int index)
 	{
 		if (index < m_Materials.size())
 			m_Materials[index] = material;
 		else
 			m_Materials.push_back(material);
+
+		if (!m_Owner.expired())
+			m_Owner.lock()->UpdateComponentFlags();
 	}
 
 	std::shared_ptr<Material> MeshRender::GetMaterial(unsigned int index) const
@@ -59,7 +104,10 @@ namespace fury
 		m_Mesh = mesh;
 
 		if (!m_Owner.expired())
+		{
 			OnAttaching(m_Owner.lock());
+			m_Owner.lock()->UpdateComponentFlags();
+		}
 	}
 
 	std::shared_ptr<Mesh> MeshRender::GetMesh() const
@@ -85,6 +133,119 @@ namespace fury
 		return true;
 	}
 
+	void MeshRender::SetOccluder(bool occluder, const std::shared_ptr<Mesh> &occluderMesh)
+	{
+		m_Occluder = occluder;
+		m_OccluderMesh = occluderMesh;
+
+		if (!m_Owner.expired())
+			m_Owner.lock()->UpdateComponentFlags();
+	}
+
+	bool MeshRender::GetOccluder() const
+	{
+		return m_Occluder;
+	}
+
+	std::shared_ptr<Mesh> MeshRender::GetOccluderMesh() const
+	{
+		if (!m_OccluderMesh.expired())
+			return m_OccluderMesh.lock();
+
+		return m_Mesh.lock();
+	}
+
+	void MeshRender::AddLod(const std::shared_ptr<Mesh> &mesh, float distance)
+	{
+		auto baseMesh = m_Mesh.lock();
+		if (mesh == nullptr || (baseMesh != nullptr && mesh->GetSubMeshCount() != baseMesh->GetSubMeshCount()))
+		{
+			FURYW << "Lod mesh and mesh SubMesh count miss match!";
+			return;
+		}
+
+		Lod lod = { mesh, distance };
+		auto it = std::upper_bound(m_Lods.begin(), m_Lods.end(), distance, [](float value, const Lod &other)
+		{
+			return value < other.distance;
+		});
+		m_Lods.insert(it, lod);
+	}
+
+	void MeshRender::RemoveAllLods()
+	{
+		m_Lods.clear();
+		m_LodStates.clear();
+	}
+
+	unsigned int MeshRender::GetLodCount() const
+	{
+		return m_Lods.size() + 1;
+	}
+
+	std::shared_ptr<Mesh> MeshRender::GetLodMesh(unsigned int lod) const
+	{
+		if (lod > 0 && lod <= m_Lods.size())
+		{
+			if (auto mesh = m_Lods[lod - 1].mesh.lock())
+				return mesh;
+		}
+
+		return m_Mesh.lock();
+	}
+
+	float MeshRender::GetLodDistance(unsigned int lod) const
+	{
+		if (lod > 0 && lod <= m_Lods.size())
+			return m_Lods[lod - 1].distance;
+		else
+			return 0.0f;
+	}
+
+	void MeshRender::SetLodHysteresis(float fraction)
+	{
+		m_LodHysteresis = std::min(std::max(fraction, 0.0f), 1.0f);
+	}
+
+	float MeshRender::GetLodHysteresis() const
+	{
+		return m_LodHysteresis;
+	}
+
+	unsigned int MeshRender::SelectLod(unsigned int view, float distance) const
+	{
+		if (m_Lods.empty())
+			return 0;
+
+		auto it = std::find_if(m_LodStates.begin(), m_LodStates.end(), [view](const std::pair<unsigned int, unsigned int> &state)
+		{
+			return state.first == view;
+		});
+
+		if (it == m_LodStates.end())
+		{
+			// forget the oldest view.
+			if (m_LodStates.size() >= MaxLodViews)
+				m_LodStates.erase(m_LodStates.begin());
+
+			m_LodStates.push_back(std::make_pair(view, 0u));
+			it = m_LodStates.end() - 1;
+		}
+
+		unsigned int lodCount = m_Lods.size();
+		unsigned int lod = std::min(it->second, lodCount);
+
+		// coarser as soon as it's past the distance, finer once it's well within.
+		while (lod < lodCount && distance >= m_Lods[lod].distance)
+			lod++;
+
+		while (lod > 0 && distance < m_Lods[lod - 1].distance * (1.0f - m_LodHysteresis))
+			lod--;
+
+		it->second = lod;
+		return lod;
+	}
+
 	void MeshRender::OnAttaching(const std::shared_ptr<SceneNode> &node)
 	{
 		Component::OnAttaching(node);
@@ -1,32 +1,92 @@
-#include <deque>
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <vector>
 
 #include "Frustum.h"
-#include "Light.h"
-#include "Material.h"
-#include "Mesh.h"
-#include "MeshRender.h"
 #include "OcTreeNode.h"
 #include "OcTree.h"
-#include "RenderQuery.h"
+#include "Ray.h"
 #include "SceneNode.h"
 #include "SphereBounds.h"
+#include "ThreadUtil.h"
 #include "Log.h"
 
 namespace fury
 {
-	OcTree::Ptr OcTree::Create(Vector4 min, Vector4 max, unsigned int maxDepth)
+	class OcTree::BuildPool
 	{
-		return std::make_shared<OcTree>(min, max, maxDepth);
+	public:
+
+		// rebinds to the control block allocate_shared puts in front of each tree node.
+		template<class T>
+		struct Allocator
+		{
+			typedef T value_type;
+
+			std::shared_ptr<BuildPool> pool;
+
+			Allocator(const std::shared_ptr<BuildPool> &pool) : pool(pool) {}
+
+			template<class U>
+			Allocator(const Allocator<U> &other) : pool(other.pool) {}
+
+			T *allocate(size_t count)
+			{
+				return static_cast<T*>(pool->Allocate(count * sizeof(T)));
+			}
+
+			// blocks go back with the pool, once the last tree node from it is gone.
+			void deallocate(T *block, size_t count) {}
+
+			template<class U>
+			bool operator == (const Allocator<U> &other) const { return pool == other.pool; }
+
+			template<class U>
+			bool operator != (const Allocator<U> &other) const { return pool != other.pool; }
+		};
+
+		// only the task that owns the pool allocates from it.
+		void *Allocate(size_t size)
+		{
+			const size_t align = alignof(std::max_align_t);
+			size = (size + align - 1) / align * align;
+
+			if (m_Used + size > ChunkSize)
+			{
+				m_Chunks.emplace_back(new char[std::max(size, ChunkSize)]);
+				m_Used = 0;
+			}
+
+			void *block = m_Chunks.back().get() + m_Used;
+			m_Used += size;
+			return block;
+		}
+
+	private:
+
+		static const size_t ChunkSize = 64 * 1024;
+
+		std::vector<std::unique_ptr<char[]>> m_Chunks;
+
+		size_t m_Used = ChunkSize;
+	};
+
+	OcTree::Ptr OcTree::Create(Vector4 min, Vector4 max, unsigned int maxDepth, float looseness)
+	{
+		return std::make_shared<OcTree>(min, max, maxDepth, looseness);
 	}
 
-	OcTree::OcTree(Vector4 min, Vector4 max, unsigned int maxDepth) :
-		m_TypeIndex(typeid(OcTree)), m_MaxDepth(maxDepth)
+	OcTree::OcTree(Vector4 min, Vector4 max, unsigned int maxDepth, float looseness) :
+		m_TypeIndex(typeid(OcTree)), m_MaxDepth(maxDepth), m_Looseness(std::max(looseness, 1.0f))
 	{
 		m_Root = OcTreeNode::Create(*this, nullptr, min, max);
 	}
 
 	OcTree::~OcTree()
 	{
+		// childs hold their parent, break the cycle first.
+		m_Root->Clear();
 		m_Root.reset();
 		FURYD << "OcTree::~OcTree";
 	}
@@ -38,6 +98,17 @@ namespace fury
 
 	void OcTree::AddSceneNode(const SceneNode::Ptr &sceneNode)
 	{
+		auto manager = sceneNode->GetSceneManager();
+		if (manager == this)
+		{
+			UpdateSceneNode(sceneNode);
+			return;
+		}
+		else if (manager != nullptr)
+		{
+			manager->RemoveSceneNode(sceneNode);
+		}
+
 		AddSceneNode(sceneNode, m_Root, 0);
 	}
 
@@ -46,148 +117,577 @@ namespace fury
 		AddSceneNode(sceneNode);
 
 		for (unsigned int i = 0; i < sceneNode->GetChildCount(); i++)
-			AddSceneNode(sceneNode->GetChildAt(i));
+			AddSceneNodeRecursively(sceneNode->GetChildAt(i));
+	}
+
+	void OcTree::Build(const SceneNodes &sceneNodes)
+	{
+		Clear();
+
+		std::vector<BuildItem> items;
+		items.reserve(sceneNodes.size());
+
+		for (const auto &sceneNode : sceneNodes)
+		{
+			SceneManager *manager = sceneNode->GetSceneManager();
+
+			// listed twice.
+			if (manager == this)
+				continue;
+
+			if (manager != nullptr)
+				manager->RemoveSceneNode(sceneNode);
+
+			// claim it now, it gets it's tree node when it's placed.
+			SetSceneManager(*sceneNode, this);
+
+			BuildItem item = { &sceneNode, sceneNode->GetWorldAABB(), sceneNode->GetComponentFlags(), 0 };
+			items.push_back(item);
+		}
+
+		if (items.empty())
+			return;
+
+		std::vector<BuildItem> scratch(items.size());
+		BuildRange rootRange = { m_Root, 0, 0, (unsigned int)items.size() };
+
+		auto &threadUtil = ThreadUtil::Instance();
+		unsigned int workerCount = threadUtil->GetWorkerCount();
+
+		// waiting for tasks on a worker could deadlock the pool.
+		if (workerCount < 2 || items.size() < m_ParallelThreshold || !threadUtil->IsMainThread())
+		{
+			BuildSubTree(rootRange, items, scratch, std::make_shared<BuildPool>());
+			return;
+		}
+
+		// split top levels breadth first until there're a few subtrees per worker.
+		auto pool = std::make_shared<BuildPool>();
+
+		std::vector<BuildRange> subTrees;
+		subTrees.push_back(rootRange);
+
+		unsigned int targetCount = workerCount * 4;
+		unsigned int head = 0;
+
+		while (head < subTrees.size() && subTrees.size() - head < targetCount)
+		{
+			BuildRange range = subTrees[head++];
+			BuildTreeNode(range, items, scratch, pool, subTrees);
+		}
+
+		// subtrees own disjoint ranges of items and scratch.
+		std::vector<std::future<void>> futures;
+		futures.reserve(subTrees.size() - head);
+
+		for (unsigned int i = head; i < subTrees.size(); i++)
+		{
+			const BuildRange &range = subTrees[i];
+			futures.push_back(threadUtil->Enqueue([this, &range, &items, &scratch]()
+			{
+				BuildSubTree(range, items, scratch, std::make_shared<BuildPool>());
+			}));
+		}
+
+		for (auto &future : futures)
+			future.get();
 	}
 
 	void OcTree::RemoveSceneNode(const SceneNode::Ptr &sceneNode)
 	{
-		sceneNode->RemoveFromOcTree(false);
+		auto treeNode = sceneNode->m_OcTreeNode.lock();
+		if (treeNode == nullptr)
+			return;
+
+		treeNode->RemoveSceneNode(sceneNode);
+
+		if (treeNode->m_TotalSceneNodeCount == 0 && m_PruneThreshold > 0 && ++m_EmptiedCount >= m_PruneThreshold)
+		{
+			m_EmptiedCount = 0;
+			Prune();
+		}
 	}
 
 	void OcTree::UpdateSceneNode(const SceneNode::Ptr &sceneNode)
 	{
-		sceneNode->RemoveFromOcTree(false);
+		if (UpdateInPlace(sceneNode))
+			return;
+
+		RemoveSceneNode(sceneNode);
 		AddSceneNode(sceneNode);
 	}
 
-	void OcTree::GetRenderQuery(const Collidable &collider, const std::shared_ptr<RenderQuery> &renderQuery) const
+	void OcTree::FlushUpdates()
 	{
-		renderQuery->Clear();
+		TakePendingUpdates(m_FlushNodes);
+		m_FlushOrder.clear();
 
-		WalkScene(collider, [&](const SceneNode::Ptr &sceneNode)
+		for (unsigned int i = 0; i < m_FlushNodes.size(); i++)
 		{
-			if (sceneNode->GetComponent<Light>() != nullptr)
-				renderQuery->AddLight(sceneNode);
-			
-			if (auto render = sceneNode->GetComponent<MeshRender>())
-			{
-				if (render->GetRenderable())
-					renderQuery->AddRenderable(sceneNode);
-			}
-		});
+			const auto &sceneNode = m_FlushNodes[i];
+			if (UpdateInPlace(sceneNode))
+				continue;
+
+			RemoveSceneNode(sceneNode);
+			m_FlushOrder.push_back(std::make_pair(GetMortonCode(sceneNode->GetWorldAABB().GetCenter()), i));
+		}
+
+		std::sort(m_FlushOrder.begin(), m_FlushOrder.end());
+
+		for (const auto &pair : m_FlushOrder)
+			AddSceneNode(m_FlushNodes[pair.second]);
+
+		m_FlushNodes.clear();
 	}
 
-	void OcTree::GetVisibleSceneNodes(const Collidable &collider, SceneNodes &sceneNodes) const
+	void OcTree::UpdateSceneNodeFlags(const SceneNode &sceneNode)
 	{
-		sceneNodes.clear();
+		auto treeNode = sceneNode.m_OcTreeNode.lock();
+		unsigned int index = sceneNode.m_SceneManagerIndex;
 
-		WalkScene(collider, [&](const SceneNode::Ptr &sceneNode) 
-		{
-			sceneNodes.push_back(sceneNode);
-		});
+		if (treeNode != nullptr && index < treeNode->m_SceneNodes.size() && treeNode->m_SceneNodes[index].get() == &sceneNode)
+			treeNode->m_SceneNodeFlags[index] = sceneNode.GetComponentFlags();
 	}
 
-	void OcTree::GetVisibleRenderables(const Collidable &collider, SceneNodes &renderables) const
+	void OcTree::WalkScene(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags) const
 	{
-		renderables.clear();
+		if (m_Root->m_TotalSceneNodeCount == 0)
+			return;
+
+		if (flags != 0)
+			RefreshSceneNodeFlags();
+
+		const Frustum *coherent = GetCoherentFrustum(collider);
 
-		WalkScene(collider, [&](const SceneNode::Ptr &sceneNode)
+		CullingStats stats;
+		stats.aabbTests++;
+
+		TreeNodePair rootPair;
+		if (WalkRoot(collider, coherent, rootPair))
 		{
-			auto render = sceneNode->GetComponent<MeshRender>();
-			if (render != nullptr && render->GetRenderable())
-				renderables.push_back(sceneNode);
-		});
+			std::vector<TreeNodePair> possiblePairs;
+			possiblePairs.push_back(rootPair);
+
+			VisibleList visibles;
+
+			while (!possiblePairs.empty())
+			{
+				// pop next possible node, it's already known to be visible.
+				TreeNodePair currentPair = possiblePairs.back();
+				possiblePairs.pop_back();
+
+				WalkTreeNode(collider, coherent, flags, currentPair, visibles, possiblePairs, stats);
+
+				for (auto sceneNode : visibles)
+					filterFunc(*sceneNode);
+
+				visibles.clear();
+			}
+		}
+
+		if (m_CountWalkStats)
+			m_WalkStats += stats;
 	}
 
-	void OcTree::GetVisibleShadowCasters(const Collidable &collider, SceneNodes &renderables) const
+	void OcTree::WalkSceneParallel(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags) const
 	{
-		renderables.clear();
+		auto &threadUtil = ThreadUtil::Instance();
+		unsigned int workerCount = threadUtil->GetWorkerCount();
 
-		WalkScene(collider, [&](const SceneNode::Ptr &sceneNode)
+		// waiting for tasks on a worker could deadlock the pool.
+		if (workerCount < 2 || m_Root->m_TotalSceneNodeCount < m_ParallelThreshold || !threadUtil->IsMainThread())
 		{
-			auto render = sceneNode->GetComponent<MeshRender>();
-			if (render != nullptr && render->GetRenderable() && render->GetMesh()->GetCastShadows())
-				renderables.push_back(sceneNode);
-		});
-	}
+			WalkScene(collider, filterFunc, flags);
+			return;
+		}
 
-	void OcTree::GetVisibleLights(const Collidable &collider, SceneNodes &lights) const
-	{
-		lights.clear();
+		if (flags != 0)
+			RefreshSceneNodeFlags();
+
+		const Frustum *coherent = GetCoherentFrustum(collider);
 
-		WalkScene(collider, [&](const SceneNode::Ptr &sceneNode)
+		CullingStats stats;
+		stats.aabbTests++;
+
+		TreeNodePair rootPair;
+		if (!WalkRoot(collider, coherent, rootPair))
 		{
-			if (sceneNode->GetComponent<Light>() != nullptr)
-				lights.push_back(sceneNode);
+			if (m_CountWalkStats)
+				m_WalkStats += stats;
+			return;
+		}
 
-		});
-	}
+		// split top levels breadth first until there're a few subtrees per worker,
+		// visible scenenodes of the split nodes come first.
+		std::vector<TreeNodePair> subTrees;
+		subTrees.push_back(rootPair);
 
-	void OcTree::GetVisibleRenderableAndLights(const Collidable &collider, SceneNodes &renderables, SceneNodes &lights) const
-	{
-		renderables.clear();
-		lights.clear();
+		VisibleList visibles;
+
+		unsigned int targetCount = workerCount * 4;
+		unsigned int head = 0;
+
+		while (head < subTrees.size() && subTrees.size() - head < targetCount)
+			WalkTreeNode(collider, coherent, flags, subTrees[head++], visibles, subTrees, stats);
+
+		unsigned int taskCount = subTrees.size() - head;
+		if (m_WalkTasks.size() < taskCount)
+			m_WalkTasks.resize(taskCount);
+
+		std::vector<std::future<void>> futures;
+		futures.reserve(taskCount);
+
+		for (unsigned int i = 0; i < taskCount; i++)
+		{
+			WalkTask &task = m_WalkTasks[i];
+			task.pairs.clear();
+			task.visibles.clear();
+			task.stats = CullingStats();
+			task.pairs.push_back(subTrees[head + i]);
+
+			futures.push_back(threadUtil->Enqueue([this, &collider, coherent, flags, &task]()
+			{
+				WalkTreeNodes(collider, coherent, flags, task);
+			}));
+		}
+
+		for (auto sceneNode : visibles)
+			filterFunc(*sceneNode);
 
-		WalkScene(collider, [&](const SceneNode::Ptr &sceneNode)
+		// merge in task order, so the result doesn't depend on scheduling.
+		for (unsigned int i = 0; i < taskCount; i++)
 		{
-			auto render = sceneNode->GetComponent<MeshRender>();
-			if (render != nullptr && render->GetRenderable())
-				renderables.push_back(sceneNode);
-			else if (sceneNode->GetComponent<Light>() != nullptr)
-				lights.push_back(sceneNode);
+			futures[i].get();
 
-		});
+			for (auto sceneNode : m_WalkTasks[i].visibles)
+				filterFunc(*sceneNode);
+
+			stats += m_WalkTasks[i].stats;
+		}
+
+		if (m_CountWalkStats)
+			m_WalkStats += stats;
 	}
 
-	void OcTree::WalkScene(const Collidable &collider, const FilterFunc &filterFunc) const
+	void OcTree::WalkSceneMulti(const Colliders &colliders, const MultiFilterFunc &filterFunc, unsigned int flags) const
 	{
-		using TreeNodePair = std::pair<bool, OcTreeNode::Ptr>;
+		ASSERT_MSG(colliders.size() <= MaxViews, "Too many colliders for one walk!");
 
-		std::deque<TreeNodePair> possiblePairs;
-		possiblePairs.push_back(std::make_pair(false, m_Root));
+		unsigned int viewCount = colliders.size();
+		if (viewCount == 0 || m_Root->m_TotalSceneNodeCount == 0)
+			return;
+
+		if (flags != 0)
+			RefreshSceneNodeFlags();
+
+		MultiWalkPair rootPair = { 0, 0, m_Root.get() };
+		for (unsigned int v = 0; v < viewCount; v++)
+		{
+			Side side = colliders[v]->IsInside(m_Root->m_LooseAABB);
+			if (side != Side::OUT)
+				rootPair.active |= 1u << v;
+			if (side == Side::IN)
+				rootPair.inside |= 1u << v;
+		}
+
+		CullingStats stats;
+		stats.aabbTests += viewCount;
+
+		if (rootPair.active == 0)
+		{
+			if (m_CountWalkStats)
+				m_WalkStats += stats;
+			return;
+		}
+
+		const unsigned int batchSize = 64;
+		unsigned int batchVisibles[batchSize];
+		Side childSides[8];
+
+		std::vector<MultiWalkPair> possiblePairs;
+		possiblePairs.push_back(rootPair);
+
+		std::vector<unsigned int> viewMasks;
 
 		while (!possiblePairs.empty())
 		{
-			// pop next possible node.
-			TreeNodePair currentPair = possiblePairs.back();
+			MultiWalkPair currentPair = possiblePairs.back();
 			possiblePairs.pop_back();
 
-			// procced
-			bool tested = currentPair.first;
-			OcTreeNode::Ptr treeNode = currentPair.second;
+			const OcTreeNode *treeNode = currentPair.treeNode;
+			unsigned int inside = currentPair.inside;
 
-			if (treeNode->GetTotalSceneNodeCount() > 0)
+			// only views that straddle this node need testing.
+			unsigned int testing = currentPair.active & ~inside;
+
+			stats.treeNodesVisited++;
+			if (testing == 0)
+				stats.treeNodesInside++;
+
+			unsigned int sceneNodeCount = treeNode->m_SceneNodes.size();
+			if (sceneNodeCount > 0)
 			{
-				Side result = tested ? Side::IN : collider.IsInside(treeNode->GetAABB());
+				viewMasks.assign(sceneNodeCount, inside);
 
-				if (result != Side::OUT)
+				for (unsigned int v = 0; v < viewCount; v++)
 				{
-					if (result == Side::IN)
-						tested = true;
+					if (!(testing & (1u << v)))
+						continue;
 
-					// test currentTreeNode's belonging sceneNodes
-					int sceneNodeCount = treeNode->GetSceneNodeCount();
-					for (int i = 0; i < sceneNodeCount; i++)
+					stats.aabbTests += sceneNodeCount;
+					for (unsigned int begin = 0; begin < sceneNodeCount; begin += batchSize)
 					{
-						SceneNode::Ptr sceneNode = treeNode->GetSceneNodeAt(i);
-						if (tested || collider.IsInsideFast(sceneNode->GetWorldAABB()))
-							filterFunc(sceneNode);
+						unsigned int end = std::min(begin + batchSize, sceneNodeCount);
+						unsigned int count = colliders[v]->IsInsideFastBatch(treeNode->m_SceneNodeBounds, begin, end, batchVisibles);
+						for (unsigned int i = 0; i < count; i++)
+							viewMasks[batchVisibles[i]] |= 1u << v;
 					}
+				}
 
-					// add currentTreeNode's childs to possiblePairs vector.
-					for (int i = 0; i < 8; i++)
-					{
-						OcTreeNode::Ptr childNode = treeNode->GetChildAt(i);
-						if (childNode != nullptr && childNode->GetTotalSceneNodeCount() > 0)
-							possiblePairs.push_back(std::make_pair(tested, childNode));
-					}
+				for (unsigned int i = 0; i < sceneNodeCount; i++)
+				{
+					if (viewMasks[i] != 0 && (flags == 0 || (treeNode->m_SceneNodeFlags[i] & flags)))
+						filterFunc(treeNode->m_SceneNodes[i], viewMasks[i]);
+				}
+			}
+
+			// no scenenodes below this node.
+			if (treeNode->m_TotalSceneNodeCount == sceneNodeCount)
+				continue;
+
+			unsigned int childActive[8], childInside[8];
+			for (int i = 0; i < 8; i++)
+				childActive[i] = childInside[i] = inside;
+
+			for (unsigned int v = 0; v < viewCount; v++)
+			{
+				if (!(testing & (1u << v)))
+					continue;
+
+				colliders[v]->IsInsideBatch(treeNode->m_ChildBounds, 0, 8, childSides);
+				stats.aabbTests += 8;
+
+				for (int i = 0; i < 8; i++)
+				{
+					if (childSides[i] != Side::OUT)
+						childActive[i] |= 1u << v;
+					if (childSides[i] == Side::IN)
+						childInside[i] |= 1u << v;
 				}
 			}
+
+			for (int i = 0; i < 8; i++)
+			{
+				const OcTreeNode *childNode = treeNode->m_Childs[i].get();
+				if (childNode == nullptr || childNode->m_TotalSceneNodeCount == 0 || childActive[i] == 0)
+					continue;
+
+				MultiWalkPair childPair = { childActive[i], childInside[i], childNode };
+				possiblePairs.push_back(childPair);
+			}
 		}
+
+		if (m_CountWalkStats)
+			m_WalkStats += stats;
+	}
+
+	void OcTree::WalkRay(const Ray &ray, float maxDistance, const RayFunc &rayFunc, unsigned int flags) const
+	{
+		if (m_Root->m_TotalSceneNodeCount == 0)
+			return;
+
+		if (flags != 0)
+			RefreshSceneNodeFlags();
+
+		// tree nodes and scenenodes share one heap by entry distance,
+		// so scenenodes come out nearest first, and everything past maxDistance is never opened.
+		struct RayItem
+		{
+			float entry;
+
+			const OcTreeNode *treeNode;
+
+			// scenenode of treeNode, or -1 for treeNode itself.
+			int index;
+
+			bool operator < (const RayItem &other) const
+			{
+				return entry > other.entry;
+			}
+		};
+
+		std::vector<RayItem> heap;
+
+		float entry;
+		if (!ray.Intersects(m_Root->m_LooseAABB, maxDistance, entry))
+			return;
+
+		heap.push_back({ entry, m_Root.get(), -1 });
+
+		while (!heap.empty())
+		{
+			std::pop_heap(heap.begin(), heap.end());
+			RayItem item = heap.back();
+			heap.pop_back();
+
+			if (item.entry > maxDistance)
+				break;
+
+			const OcTreeNode *treeNode = item.treeNode;
+
+			if (item.index >= 0)
+			{
+				maxDistance = rayFunc(treeNode->m_SceneNodes[item.index], item.entry);
+				continue;
+			}
+
+			for (unsigned int i = 0; i < treeNode->m_SceneNodes.size(); i++)
+			{
+				if (flags != 0 && !(treeNode->m_SceneNodeFlags[i] & flags))
+					continue;
+
+				if (ray.Intersects(treeNode->m_SceneNodeBounds.GetAt(i), maxDistance, entry))
+				{
+					heap.push_back({ entry, treeNode, (int)i });
+					std::push_heap(heap.begin(), heap.end());
+				}
+			}
+
+			if (treeNode->m_TotalSceneNodeCount == treeNode->m_SceneNodes.size())
+				continue;
+
+			for (int i = 0; i < 8; i++)
+			{
+				const OcTreeNode *childNode = treeNode->m_Childs[i].get();
+				if (childNode == nullptr || childNode->m_TotalSceneNodeCount == 0)
+					continue;
+
+				if (ray.Intersects(childNode->m_LooseAABB, maxDistance, entry))
+				{
+					heap.push_back({ entry, childNode, -1 });
+					std::push_heap(heap.begin(), heap.end());
+				}
+			}
+		}
+	}
+
+	void OcTree::SetParallelThreshold(unsigned int sceneNodeCount)
+	{
+		m_ParallelThreshold = sceneNodeCount;
+	}
+
+	unsigned int OcTree::GetParallelThreshold() const
+	{
+		return m_ParallelThreshold;
+	}
+
+	float OcTree::GetLooseness() const
+	{
+		return m_Looseness;
+	}
+
+	void OcTree::SetCoherentCulling(bool enable)
+	{
+		m_CoherentCulling = enable;
+	}
+
+	bool OcTree::GetCoherentCulling() const
+	{
+		return m_CoherentCulling;
+	}
+
+	void OcTree::SetPruneThreshold(unsigned int treeNodeCount)
+	{
+		m_PruneThreshold = treeNodeCount;
+	}
+
+	unsigned int OcTree::GetPruneThreshold() const
+	{
+		return m_PruneThreshold;
+	}
+
+	void OcTree::Prune()
+	{
+		std::vector<OcTreeNode*> treeNodes;
+		treeNodes.push_back(m_Root.get());
+
+		while (!treeNodes.empty())
+		{
+			OcTreeNode *treeNode = treeNodes.back();
+			treeNodes.pop_back();
+
+			for (int i = 0; i < 8; i++)
+			{
+				OcTreeNode *childNode = treeNode->m_Childs[i].get();
+				if (childNode == nullptr)
+					continue;
+
+				if (childNode->m_TotalSceneNodeCount > 0)
+				{
+					childNode->m_PruneCandidate = false;
+					treeNodes.push_back(childNode);
+				}
+				else if (childNode->m_PruneCandidate)
+				{
+					// nothing below it, Clear only drops it's childs.
+					childNode->Clear();
+					treeNode->m_Childs[i] = nullptr;
+				}
+				else
+				{
+					childNode->m_PruneCandidate = true;
+				}
+			}
+		}
+	}
+
+	void OcTree::Compact()
+	{
+		auto pool = std::make_shared<BuildPool>();
+		OcTreeNode::Ptr root = CompactTreeNode(*m_Root, nullptr, pool);
+
+		// scenenodes moved to the copy already.
+		m_Root->Clear();
+		m_Root = root;
+		m_EmptiedCount = 0;
+	}
+
+	OcTree::MemoryStats OcTree::GetMemoryStats() const
+	{
+		MemoryStats stats = { 0, 0, 0, std::vector<unsigned int>(m_MaxDepth + 1, 0) };
+
+		std::vector<std::pair<const OcTreeNode*, unsigned int>> treeNodes;
+		treeNodes.push_back(std::make_pair(m_Root.get(), 0u));
+
+		while (!treeNodes.empty())
+		{
+			const OcTreeNode *treeNode = treeNodes.back().first;
+			unsigned int depth = treeNodes.back().second;
+			treeNodes.pop_back();
+
+			stats.treeNodeCount++;
+			if (treeNode->m_TotalSceneNodeCount == 0)
+				stats.emptyTreeNodeCount++;
+
+			stats.bytes += treeNode->GetMemoryBytes();
+
+			if (depth >= stats.depthHistogram.size())
+				stats.depthHistogram.resize(depth + 1, 0);
+			stats.depthHistogram[depth]++;
+
+			for (int i = 0; i < 8; i++)
+			{
+				if (treeNode->m_Childs[i] != nullptr)
+					treeNodes.push_back(std::make_pair(treeNode->m_Childs[i].get(), depth + 1));
+			}
+		}
+
+		return stats;
 	}
 
 	void OcTree::Reset(Vector4 min, Vector4 max, unsigned int maxDepth)
 	{
+		m_Root->Clear();
 		m_Root.reset();
 		m_Root = OcTreeNode::Create(*this, nullptr, min, max);
 	}
@@ -197,12 +697,343 @@ namespace fury
 		m_Root->Clear();
 	}
 
+	OcTreeNode::Ptr OcTree::CompactTreeNode(OcTreeNode &treeNode, const OcTreeNode::Ptr &parent, 
+		const std::shared_ptr<BuildPool> &pool)
+	{
+		BoxBounds aabb = treeNode.m_AABB;
+		OcTreeNode::Ptr copy = std::allocate_shared<OcTreeNode>(BuildPool::Allocator<OcTreeNode>(pool), 
+			*this, parent, aabb.GetMin(), aabb.GetMax());
+
+		// copies allocate exactly size, the old arrays' slack goes with the old node.
+		copy->m_SceneNodes = treeNode.m_SceneNodes;
+		copy->m_SceneNodeBounds = treeNode.m_SceneNodeBounds;
+		copy->m_SceneNodeFlags = treeNode.m_SceneNodeFlags;
+		copy->m_SceneNodePlanes = treeNode.m_SceneNodePlanes;
+		copy->m_LastPlane = treeNode.m_LastPlane;
+		copy->m_InsideMask = treeNode.m_InsideMask;
+		copy->m_IsLeaf = treeNode.m_IsLeaf;
+		copy->m_TotalSceneNodeCount = treeNode.m_TotalSceneNodeCount;
+
+		for (auto &sceneNode : copy->m_SceneNodes)
+			sceneNode->SetOcTreeNode(copy);
+
+		// so clearing the old node won't detach them.
+		treeNode.m_SceneNodes.clear();
+
+		for (int i = 0; i < 8; i++)
+		{
+			OcTreeNode *childNode = treeNode.m_Childs[i].get();
+			if (childNode != nullptr && childNode->m_TotalSceneNodeCount > 0)
+				copy->m_Childs[i] = CompactTreeNode(*childNode, copy, pool);
+		}
+
+		return copy;
+	}
+
+	bool OcTree::UpdateInPlace(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		// root holds whatever fits nowhere else, re-add to give it a chance to sink.
+		auto treeNode = sceneNode->m_OcTreeNode.lock();
+		if (treeNode != nullptr && treeNode != m_Root && treeNode->CanHold(sceneNode->GetWorldAABB()))
+		{
+			treeNode->UpdateSceneNode(sceneNode);
+			return true;
+		}
+
+		return false;
+	}
+
+	unsigned int OcTree::GetMortonCode(Vector4 point) const
+	{
+		Vector4 min = m_Root->m_AABB.GetMin();
+		Vector4 size = m_Root->m_AABB.GetSize();
+
+		float coords[3] = {
+			(point.x - min.x) / size.x,
+			(point.y - min.y) / size.y,
+			(point.z - min.z) / size.z
+		};
+
+		unsigned int code = 0;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			// clamp outsiders to the border, spread 10 bits to every 3rd bit.
+			unsigned int value = (unsigned int)(std::min(std::max(coords[axis], 0.0f), 1.0f) * 1023.0f);
+			value = (value | (value << 16)) & 0x030000ff;
+			value = (value | (value << 8)) & 0x0300f00f;
+			value = (value | (value << 4)) & 0x030c30c3;
+			value = (value | (value << 2)) & 0x09249249;
+			code |= value << (2 - axis);
+		}
+
+		return code;
+	}
+
+	void OcTree::RefreshSceneNodeFlags() const
+	{
+		unsigned int version = SceneNode::GetComponentFlagsVersion();
+		if (m_FlagsVersion == version)
+			return;
+
+		std::vector<const OcTreeNode*> treeNodes;
+		treeNodes.push_back(m_Root.get());
+
+		while (!treeNodes.empty())
+		{
+			const OcTreeNode *treeNode = treeNodes.back();
+			treeNodes.pop_back();
+
+			for (unsigned int i = 0; i < treeNode->m_SceneNodes.size(); i++)
+				treeNode->m_SceneNodeFlags[i] = treeNode->m_SceneNodes[i]->GetComponentFlags();
+
+			for (int i = 0; i < 8; i++)
+			{
+				if (treeNode->m_Childs[i] != nullptr && treeNode->m_Childs[i]->m_TotalSceneNodeCount > 0)
+					treeNodes.push_back(treeNode->m_Childs[i].get());
+			}
+		}
+
+		m_FlagsVersion = version;
+	}
+
+	const Frustum *OcTree::GetCoherentFrustum(const Collidable &collider) const
+	{
+		return m_CoherentCulling ? dynamic_cast<const Frustum*>(&collider) : nullptr;
+	}
+
+	bool OcTree::WalkRoot(const Collidable &collider, const Frustum *coherent, TreeNodePair &pair) const
+	{
+		const OcTreeNode *root = m_Root.get();
+		unsigned char mask = 0;
+		Side side;
+
+		if (coherent != nullptr)
+		{
+			mask = root->m_InsideMask;
+			side = coherent->IsInside(root->m_LooseAABB, root->m_LastPlane, 0, mask);
+			root->m_InsideMask = mask;
+		}
+		else
+		{
+			side = collider.IsInside(root->m_LooseAABB);
+			mask = side == Side::IN ? Frustum::AllPlanes : 0;
+		}
+
+		pair = std::make_pair(mask, root);
+		return side != Side::OUT;
+	}
+
+	void OcTree::WalkTreeNode(const Collidable &collider, const Frustum *coherent, unsigned int flags, TreeNodePair pair, 
+		VisibleList &visibles, std::vector<TreeNodePair> &pairs, CullingStats &stats) const
+	{
+		const unsigned int batchSize = 64;
+		unsigned int batchVisibles[batchSize];
+		Side childSides[8];
+
+		// raw pointers, the tree can't change while we walk it.
+		unsigned char mask = pair.first;
+		bool inside = mask == Frustum::AllPlanes;
+		const OcTreeNode *treeNode = pair.second;
+
+		stats.treeNodesVisited++;
+
+		// test treeNode's belonging sceneNodes, a batch at a time.
+		const unsigned int *sceneNodeFlags = treeNode->m_SceneNodeFlags.data();
+		unsigned int sceneNodeCount = treeNode->m_SceneNodes.size();
+		if (inside)
+		{
+			stats.treeNodesInside++;
+
+			for (unsigned int i = 0; i < sceneNodeCount; i++)
+			{
+				if (flags == 0 || (sceneNodeFlags[i] & flags))
+					visibles.push_back(&treeNode->m_SceneNodes[i]);
+			}
+		}
+		else if (coherent != nullptr)
+		{
+			// one at a time, starting with the plane that rejected it last time.
+			for (unsigned int i = 0; i < sceneNodeCount; i++)
+			{
+				if (flags != 0 && !(sceneNodeFlags[i] & flags))
+					continue;
+
+				stats.aabbTests++;
+				if (coherent->IsInsideFast(treeNode->m_SceneNodeBounds.GetAt(i), treeNode->m_SceneNodePlanes[i], mask))
+					visibles.push_back(&treeNode->m_SceneNodes[i]);
+			}
+		}
+		else
+		{
+			stats.aabbTests += sceneNodeCount;
+			for (unsigned int begin = 0; begin < sceneNodeCount; begin += batchSize)
+			{
+				unsigned int end = std::min(begin + batchSize, sceneNodeCount);
+				unsigned int count = collider.IsInsideFastBatch(treeNode->m_SceneNodeBounds, begin, end, batchVisibles);
+				for (unsigned int i = 0; i < count; i++)
+				{
+					unsigned int index = batchVisibles[i];
+					if (flags == 0 || (sceneNodeFlags[index] & flags))
+						visibles.push_back(&treeNode->m_SceneNodes[index]);
+				}
+			}
+		}
+
+		// no scenenodes below this node.
+		if (treeNode->m_TotalSceneNodeCount == sceneNodeCount)
+			return;
+
+		// test all 8 childs at once.
+		if (!inside && coherent == nullptr)
+		{
+			collider.IsInsideBatch(treeNode->m_ChildBounds, 0, 8, childSides);
+			stats.aabbTests += 8;
+		}
+
+		for (int i = 0; i < 8; i++)
+		{
+			const OcTreeNode *childNode = treeNode->m_Childs[i].get();
+			if (childNode == nullptr || childNode->m_TotalSceneNodeCount == 0)
+				continue;
+
+			if (inside)
+			{
+				pairs.push_back(std::make_pair(mask, childNode));
+			}
+			else if (coherent != nullptr)
+			{
+				// skips planes this node is inside of, remembers the result for next time.
+				unsigned char childMask = childNode->m_InsideMask;
+				stats.aabbTests++;
+				Side side = coherent->IsInside(childNode->m_LooseAABB, childNode->m_LastPlane, mask, childMask);
+				childNode->m_InsideMask = childMask;
+
+				if (side != Side::OUT)
+					pairs.push_back(std::make_pair(childMask, childNode));
+			}
+			else if (childSides[i] != Side::OUT)
+			{
+				pairs.push_back(std::make_pair(childSides[i] == Side::IN ? Frustum::AllPlanes : 0, childNode));
+			}
+		}
+	}
+
+	void OcTree::WalkTreeNodes(const Collidable &collider, const Frustum *coherent, unsigned int flags, WalkTask &task) const
+	{
+		while (!task.pairs.empty())
+		{
+			TreeNodePair pair = task.pairs.back();
+			task.pairs.pop_back();
+
+			WalkTreeNode(collider, coherent, flags, pair, task.visibles, task.pairs, task.stats);
+		}
+	}
+
+	void OcTree::BuildTreeNode(const BuildRange &range, std::vector<BuildItem> &items, std::vector<BuildItem> &scratch, 
+		const std::shared_ptr<BuildPool> &pool, std::vector<BuildRange> &childRanges)
+	{
+		OcTreeNode *treeNode = range.treeNode.get();
+		unsigned int counts[9] = { 0 };
+
+		// same choice AddSceneNode makes, one level at a time.
+		for (unsigned int i = range.begin; i < range.end; i++)
+		{
+			BuildItem &item = items[i];
+			int childIndex = -1;
+
+			if (range.depth < m_MaxDepth)
+			{
+				if (m_Looseness > 1.0f)
+					childIndex = treeNode->GetLooseFitChildIndex(item.aabb);
+				else if (treeNode->IsTwiceSize(item.aabb))
+					childIndex = treeNode->GetFitChildIndex(item.aabb);
+			}
+
+			item.bucket = childIndex + 1;
+			counts[item.bucket]++;
+		}
+
+		// counting sort by bucket, stays first.
+		unsigned int offsets[9];
+		offsets[0] = range.begin;
+		for (int i = 1; i < 9; i++)
+			offsets[i] = offsets[i - 1] + counts[i - 1];
+
+		for (unsigned int i = range.begin; i < range.end; i++)
+			scratch[offsets[items[i].bucket]++] = items[i];
+
+		std::copy(scratch.begin() + range.begin, scratch.begin() + range.end, items.begin() + range.begin);
+
+		unsigned int stayEnd = range.begin + counts[0];
+		unsigned int stayCount = treeNode->m_SceneNodes.size() + counts[0];
+
+		treeNode->m_SceneNodes.reserve(stayCount);
+		treeNode->m_SceneNodeBounds.Reserve(stayCount);
+		treeNode->m_SceneNodeFlags.reserve(stayCount);
+		treeNode->m_SceneNodePlanes.reserve(stayCount);
+
+		for (unsigned int i = range.begin; i < stayEnd; i++)
+		{
+			const auto &sceneNode = *items[i].sceneNode;
+
+			treeNode->m_SceneNodes.push_back(sceneNode);
+			treeNode->m_SceneNodeBounds.Add(items[i].aabb);
+			treeNode->m_SceneNodeFlags.push_back(items[i].flags);
+			treeNode->m_SceneNodePlanes.push_back(0);
+
+			sceneNode->SetOcTreeNode(range.treeNode);
+			sceneNode->m_SceneManagerIndex = treeNode->m_SceneNodes.size() - 1;
+		}
+
+		// everything in range ends up below treeNode, no need to count up the parents.
+		treeNode->m_TotalSceneNodeCount = range.end - range.begin;
+
+		for (unsigned int i = 1; i < 9; i++)
+		{
+			if (counts[i] == 0)
+				continue;
+
+			unsigned int childIndex = i - 1;
+			BoxBounds childAABB = treeNode->GetChildAABB(childIndex);
+
+			OcTreeNode::Ptr child = std::allocate_shared<OcTreeNode>(BuildPool::Allocator<OcTreeNode>(pool), 
+				*this, range.treeNode, childAABB.GetMin(), childAABB.GetMax());
+			treeNode->m_Childs[childIndex] = child;
+
+			BuildRange childRange = { child, range.depth + 1, offsets[i] - counts[i], offsets[i] };
+			childRanges.push_back(childRange);
+		}
+	}
+
+	void OcTree::BuildSubTree(const BuildRange &range, std::vector<BuildItem> &items, std::vector<BuildItem> &scratch, 
+		const std::shared_ptr<BuildPool> &pool)
+	{
+		std::vector<BuildRange> ranges;
+		ranges.push_back(range);
+
+		while (!ranges.empty())
+		{
+			BuildRange current = ranges.back();
+			ranges.pop_back();
+
+			BuildTreeNode(current, items, scratch, pool, ranges);
+		}
+	}
+
 	void OcTree::AddSceneNode(const SceneNode::Ptr &sceneNode, const OcTreeNode::Ptr &treeNode, unsigned int depth)
 	{
 		BoxBounds treeBounds = treeNode->GetAABB();
 		BoxBounds nodeBounds = sceneNode->GetWorldAABB();
 
-		if ((depth < m_MaxDepth) && treeNode->IsTwiceSize(nodeBounds))
+		if (m_Looseness > 1.0f)
+		{
+			OcTreeNode::Ptr fitNode = depth < m_MaxDepth ? treeNode->GetLooseFitNode(nodeBounds) : nullptr;
+			if (fitNode != nullptr)
+				AddSceneNode(sceneNode, fitNode, ++depth);
+			else
+				treeNode->AddSceneNode(sceneNode);
+		}
+		else if ((depth < m_MaxDepth) && treeNode->IsTwiceSize(nodeBounds))
 		{
 			OcTreeNode::Ptr fitNode = treeNode->GetFitNode(nodeBounds);
 			AddSceneNode(sceneNode, fitNode, ++depth);
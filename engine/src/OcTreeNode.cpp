@@ -1,8 +1,5 @@
-#include <math.h>
-
 #include "OcTreeNode.h"
 #include "OcTree.h"
-#include "Plane.h"
 #include "SceneNode.h"
 
 namespace fury
@@ -17,7 +14,10 @@ namespace fury
 		m_TypeIndex(typeid(OcTreeNode)), m_Manager(manager), m_Parent(parent), 
 		m_AABB(min, max), m_IsLeaf(false), m_TotalSceneNodeCount(0)
 	{
+		m_LooseAABB = GetLooseAABB(m_AABB);
 
+		for (unsigned int i = 0; i < 8; i++)
+			m_ChildBounds.Add(GetLooseAABB(GetChildAABB(i)));
 	}
 
 	OcTreeNode::~OcTreeNode()
@@ -34,6 +34,11 @@ namespace fury
 	{
 		return m_AABB;
 	}
+
+	BoxBounds OcTreeNode::GetLooseAABB() const
+	{
+		return m_LooseAABB;
+	}
 	
 	bool OcTreeNode::IsTwiceSize(BoxBounds other) const
 	{
@@ -48,6 +53,40 @@ namespace fury
 	}
 
 	OcTreeNode::Ptr OcTreeNode::GetFitNode(BoxBounds other)
+	{
+		int childIndex = GetFitChildIndex(other);
+		if (childIndex < 0)
+			return shared_from_this();
+
+		OcTreeNode::Ptr child = m_Childs[childIndex];
+		if (child == nullptr)
+		{
+			BoxBounds childAABB = GetChildAABB(childIndex);
+			m_Childs[childIndex] = child = OcTreeNode::Create(
+				m_Manager, shared_from_this(), childAABB.GetMin(), childAABB.GetMax());
+		}
+
+		return child;
+	}
+
+	OcTreeNode::Ptr OcTreeNode::GetLooseFitNode(BoxBounds other)
+	{
+		int childIndex = GetLooseFitChildIndex(other);
+		if (childIndex < 0)
+			return nullptr;
+
+		OcTreeNode::Ptr child = m_Childs[childIndex];
+		if (child != nullptr)
+			return child;
+
+		BoxBounds childAABB = GetChildAABB(childIndex);
+		m_Childs[childIndex] = child = OcTreeNode::Create(
+			m_Manager, shared_from_this(), childAABB.GetMin(), childAABB.GetMax());
+
+		return child;
+	}
+
+	int OcTreeNode::GetFitChildIndex(const BoxBounds &other) const
 	{
 		Vector4 treeCenter = m_AABB.GetCenter();
 		Vector4 treeMin = m_AABB.GetMin();
@@ -57,55 +96,64 @@ namespace fury
 		Vector4 otherMax = other.GetMax();
 
 		// test if boungbox is within this treeNode.
-
 		if (otherMin.x <= treeMin.x || otherMin.y <= treeMin.y || otherMin.z <= treeMin.z ||
 			otherMax.x >= treeMax.x || otherMax.y >= treeMax.y || otherMax.z >= treeMax.z)
-			return shared_from_this();
+			return -1;
 
-		// test with split planes to find the correct child to fit in.
+		// it straddles a split plane if it reaches over the center.
+		if ((otherMin.x <= treeCenter.x && otherMax.x > treeCenter.x) ||
+			(otherMin.y <= treeCenter.y && otherMax.y > treeCenter.y) ||
+			(otherMin.z <= treeCenter.z && otherMax.z > treeCenter.z))
+			return -1;
 
-		Plane splitPlanes[] = {
-			Plane(treeCenter, treeCenter + Vector4::YAxis, treeCenter + Vector4::XAxis),
-			Plane(treeCenter, treeCenter + Vector4::XAxis, treeCenter + Vector4::ZAxis),
-			Plane(treeCenter, treeCenter + Vector4::ZAxis, treeCenter + Vector4::YAxis)
-		};
+		// see GetChildAABB for index layout.
+		return (otherMax.x <= treeCenter.x ? 4 : 0) + (otherMax.y <= treeCenter.y ? 2 : 0) + (otherMax.z <= treeCenter.z ? 1 : 0);
+	}
 
-		bool collideResult[3];
+	int OcTreeNode::GetLooseFitChildIndex(const BoxBounds &other) const
+	{
+		if (other.GetInfinite())
+			return -1;
 
-		// index = first + second * 2 + third * 4
-		int childIndex = 0;
-		for (int i = 0; i < 3; i++)
-		{
-			Side side = splitPlanes[i].IsInside(other);
-
-			if (side == Side::STRADDLE)
-			{
-				return shared_from_this();
-			}
-			else
-			{
-				collideResult[i] = side == Side::IN;
-				childIndex += (collideResult[i] ? 1 : 0) * (int)pow(2, i);
-			}
-		}
+		Vector4 treeCenter = m_AABB.GetCenter();
+		Vector4 otherCenter = other.GetCenter();
 
-		Vector4 treeExtents = m_AABB.GetExtents();
+		// see GetChildAABB for index layout.
+		unsigned int childIndex = (otherCenter.x < treeCenter.x ? 4 : 0) + 
+			(otherCenter.y < treeCenter.y ? 2 : 0) + (otherCenter.z < treeCenter.z ? 1 : 0);
 
-		OcTreeNode::Ptr child = m_Childs[childIndex];
-		if (child == nullptr)
-		{
-			Vector4 aabbMax(
-				(collideResult[2] ? 0 : 1) * treeExtents.x + treeCenter.x,
-				(collideResult[1] ? 0 : 1) * treeExtents.y + treeCenter.y,
-				(collideResult[0] ? 0 : 1) * treeExtents.z + treeCenter.z,
-				1.0f
-			);
+		const OcTreeNode *child = m_Childs[childIndex].get();
+		bool fits = child != nullptr ? child->CanHold(other) : m_ChildBounds.GetAt(childIndex).IsInside(other) == Side::IN;
 
-			m_Childs[childIndex] = child = OcTreeNode::Create(
-				m_Manager, shared_from_this(), aabbMax - treeExtents, aabbMax);
-		}
+		return fits ? childIndex : -1;
+	}
 
-		return child;
+	bool OcTreeNode::CanHold(const BoxBounds &other) const
+	{
+		return !other.GetInfinite() && m_LooseAABB.IsInside(other) == Side::IN;
+	}
+
+	BoxBounds OcTreeNode::GetChildAABB(unsigned int index) const
+	{
+		Vector4 treeCenter = m_AABB.GetCenter();
+		Vector4 treeExtents = m_AABB.GetExtents();
+
+		// index = first + second * 2 + third * 4
+		Vector4 aabbMax(
+			((index & 4) ? 0 : 1) * treeExtents.x + treeCenter.x,
+			((index & 2) ? 0 : 1) * treeExtents.y + treeCenter.y,
+			((index & 1) ? 0 : 1) * treeExtents.z + treeCenter.z,
+			1.0f
+		);
+
+		return BoxBounds(aabbMax - treeExtents, aabbMax);
+	}
+
+	BoxBounds OcTreeNode::GetLooseAABB(const BoxBounds &aabb) const
+	{
+		Vector4 center = aabb.GetCenter();
+		Vector4 extents = aabb.GetExtents() * m_Manager.GetLooseness();
+		return BoxBounds(center - extents, center + extents);
 	}
 
 	OcTree &OcTreeNode::GetManager() const
@@ -139,12 +187,31 @@ namespace fury
 		return m_TotalSceneNodeCount;
 	}
 
+	size_t OcTreeNode::GetMemoryBytes() const
+	{
+		size_t bytes = sizeof(OcTreeNode);
+
+		bytes += m_SceneNodes.capacity() * sizeof(std::shared_ptr<SceneNode>);
+		bytes += m_SceneNodeFlags.capacity() * sizeof(unsigned int);
+		bytes += m_SceneNodePlanes.capacity() * sizeof(unsigned char);
+
+		// 6 float arrays each.
+		bytes += m_SceneNodeBounds.CenterX.capacity() * sizeof(float) * 6;
+		bytes += m_ChildBounds.CenterX.capacity() * sizeof(float) * 6;
+
+		return bytes;
+	}
+
 	void OcTreeNode::Clear()
 	{
 		for (auto &sceneNode : m_SceneNodes)
 			sceneNode->SetOcTreeNode(nullptr);
 		
 		m_SceneNodes.clear();
+		m_SceneNodeBounds.Clear();
+		m_SceneNodeFlags.clear();
+		m_SceneNodePlanes.clear();
+		m_TotalSceneNodeCount = 0;
 		m_IsLeaf = true;
 
 		for (int i = 0; i < 8; i++)
@@ -158,31 +225,54 @@ namespace fury
 	void OcTreeNode::AddSceneNode(const std::shared_ptr<SceneNode> &node)
 	{
 		m_SceneNodes.push_back(node);
+		m_SceneNodeBounds.Add(node->GetWorldAABB());
+		m_SceneNodeFlags.push_back(node->GetComponentFlags());
+		m_SceneNodePlanes.push_back(0);
 		node->SetOcTreeNode(shared_from_this());
+		node->m_SceneManagerIndex = m_SceneNodes.size() - 1;
 		IncreaseSceneNodeCount();
 	}
 
 	void OcTreeNode::RemoveSceneNode(const std::shared_ptr<SceneNode> &node)
 	{
-		auto it = m_SceneNodes.begin();
-		while (it != m_SceneNodes.end())
-		{
-			if (*it == node)
-				break;
-			++it;
-		}
+		unsigned int index = node->m_SceneManagerIndex;
+		if (index >= m_SceneNodes.size() || m_SceneNodes[index] != node)
+			return;
 
-		if (it != m_SceneNodes.end())
+		// node might be a reference to the slot itself.
+		std::shared_ptr<SceneNode> removed = node;
+
+		// move the last one into the hole.
+		unsigned int last = m_SceneNodes.size() - 1;
+		if (index != last)
 		{
-			m_SceneNodes.erase(it);
-			node->SetOcTreeNode(nullptr);
-			DecreaseSceneNodeCount();
+			m_SceneNodes[index] = m_SceneNodes[last];
+			m_SceneNodes[index]->m_SceneManagerIndex = index;
+			m_SceneNodeFlags[index] = m_SceneNodeFlags[last];
+			m_SceneNodePlanes[index] = m_SceneNodePlanes[last];
 		}
+
+		m_SceneNodeBounds.RemoveAt(index);
+		m_SceneNodes.pop_back();
+		m_SceneNodeFlags.pop_back();
+		m_SceneNodePlanes.pop_back();
+
+		removed->SetOcTreeNode(nullptr);
+		removed->m_SceneManagerIndex = 0;
+		DecreaseSceneNodeCount();
+	}
+
+	void OcTreeNode::UpdateSceneNode(const std::shared_ptr<SceneNode> &node)
+	{
+		unsigned int index = node->m_SceneManagerIndex;
+		if (index < m_SceneNodes.size() && m_SceneNodes[index] == node)
+			m_SceneNodeBounds.Set(index, node->GetWorldAABB());
 	}
 
 	void OcTreeNode::IncreaseSceneNodeCount()
 	{
 		m_TotalSceneNodeCount++;
+		m_PruneCandidate = false;
 		if (m_Parent != nullptr)
 			m_Parent->IncreaseSceneNodeCount();
 	}
@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "BoxBounds.h"
+#include "Camera.h"
+#include "Mesh.h"
+#include "MeshRender.h"
+#include "OcclusionCuller.h"
+#include "RenderQuery.h"
+#include "SceneNode.h"
+
+#if defined(FURY_USE_SSE)
+#include <emmintrin.h>
+#endif
+
+namespace fury
+{
+	OcclusionCuller::Ptr OcclusionCuller::Create(unsigned int width, unsigned int height)
+	{
+		return std::make_shared<OcclusionCuller>(width, height);
+	}
+
+	OcclusionCuller::OcclusionCuller(unsigned int width, unsigned int height)
+	{
+		m_Width = (std::max(width, 4u) + 3) & ~3u;
+		m_Height = std::max(height, 1u);
+
+		unsigned int levelWidth = m_Width;
+		unsigned int levelHeight = m_Height;
+
+		while (true)
+		{
+			m_LevelWidths.push_back(levelWidth);
+			m_LevelHeights.push_back(levelHeight);
+			m_Levels.push_back(std::vector<float>(levelWidth * levelHeight, 1.0f));
+
+			if (levelWidth == 1 && levelHeight == 1)
+				break;
+
+			levelWidth = (levelWidth + 1) / 2;
+			levelHeight = (levelHeight + 1) / 2;
+		}
+	}
+
+	void OcclusionCuller::Begin(const Matrix4 &viewProjMatrix)
+	{
+		m_ViewProjMatrix = viewProjMatrix;
+
+		for (auto &level : m_Levels)
+			std::fill(level.begin(), level.end(), 1.0f);
+
+		m_OccluderCount = 0;
+		m_TriangleCount = 0;
+		m_CulledCount = 0;
+	}
+
+	void OcclusionCuller::Begin(const std::shared_ptr<SceneNode> &camNode)
+	{
+		auto camera = camNode->GetComponent<Camera>();
+		Begin(camera->GetProjectionMatrix() * camNode->GetInvertWorldMatrix());
+	}
+
+	void OcclusionCuller::AddOccluder(const std::shared_ptr<SceneNode> &node)
+	{
+		auto render = node->GetComponent<MeshRender>();
+		if (render == nullptr)
+			return;
+
+		auto mesh = render->GetOccluderMesh();
+		if (mesh != nullptr)
+			AddOccluder(mesh, node->GetWorldMatrix());
+	}
+
+	void OcclusionCuller::AddOccluder(const std::shared_ptr<Mesh> &mesh, const Matrix4 &worldMatrix)
+	{
+		Matrix4 matrix = m_ViewProjMatrix * worldMatrix;
+
+		const auto &positions = mesh->Positions.Data;
+		unsigned int vertexCount = positions.size() / 3;
+
+		// Vector4's assignment doesn't copy w, construct them in place.
+		m_ClipVertices.clear();
+		for (unsigned int i = 0; i < vertexCount; i++)
+			m_ClipVertices.push_back(matrix.Multiply(Vector4(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2], 1.0f)));
+
+		auto drawIndices = [&](const std::vector<unsigned int> &indices)
+		{
+			for (unsigned int i = 0; i + 2 < indices.size(); i += 3)
+			{
+				if (indices[i] < vertexCount && indices[i + 1] < vertexCount && indices[i + 2] < vertexCount)
+					DrawTriangle(m_ClipVertices[indices[i]], m_ClipVertices[indices[i + 1]], m_ClipVertices[indices[i + 2]]);
+			}
+		};
+
+		unsigned int subMeshCount = mesh->GetSubMeshCount();
+		if (subMeshCount > 0)
+		{
+			for (unsigned int i = 0; i < subMeshCount; i++)
+				drawIndices(mesh->GetSubMeshAt(i)->Indices.Data);
+		}
+		else
+		{
+			drawIndices(mesh->Indices.Data);
+		}
+
+		m_OccluderCount++;
+	}
+
+	void OcclusionCuller::End()
+	{
+		BuildHiZ();
+	}
+
+	bool OcclusionCuller::IsVisible(const BoxBounds &aabb) const
+	{
+		if (m_OccluderCount == 0 || aabb.GetInfinite())
+			return true;
+
+		Vector4 min = aabb.GetMin();
+		Vector4 max = aabb.GetMax();
+
+		float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+		float maxX = -FLT_MAX, maxY = -FLT_MAX;
+
+		for (int i = 0; i < 8; i++)
+		{
+			Vector4 corner(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z, 1.0f);
+			Vector4 clip = m_ViewProjMatrix.Multiply(corner);
+
+			// crosses the near plane.
+			if (clip.w <= 0.0f || clip.z < -clip.w)
+				return true;
+
+			float x = (clip.x / clip.w * 0.5f + 0.5f) * m_Width;
+			float y = (clip.y / clip.w * 0.5f + 0.5f) * m_Height;
+
+			minX = std::min(minX, x);
+			minY = std::min(minY, y);
+			minZ = std::min(minZ, clip.z / clip.w);
+			maxX = std::max(maxX, x);
+			maxY = std::max(maxY, y);
+		}
+
+		// off screen, not ours to cull.
+		if (maxX < 0.0f || maxY < 0.0f || minX >= m_Width || minY >= m_Height)
+			return true;
+
+		int x0 = std::max((int)std::floor(minX), 0);
+		int y0 = std::max((int)std::floor(minY), 0);
+		int x1 = std::min((int)std::floor(maxX), (int)m_Width - 1);
+		int y1 = std::min((int)std::floor(maxY), (int)m_Height - 1);
+
+		// go up until the rect covers at most 2x2 texels.
+		unsigned int level = 0;
+		while ((x1 - x0 > 1 || y1 - y0 > 1) && level + 1 < m_Levels.size())
+		{
+			x0 >>= 1;
+			y0 >>= 1;
+			x1 >>= 1;
+			y1 >>= 1;
+			level++;
+		}
+
+		const auto &depths = m_Levels[level];
+		unsigned int levelWidth = m_LevelWidths[level];
+
+		float maxDepth = 0.0f;
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int x = x0; x <= x1; x++)
+				maxDepth = std::max(maxDepth, depths[y * levelWidth + x]);
+		}
+
+		return minZ <= maxDepth;
+	}
+
+	void OcclusionCuller::Cull(const std::shared_ptr<SceneNode> &camNode, const std::shared_ptr<RenderQuery> &renderQuery)
+	{
+		Begin(camNode);
+
+		for (const auto &node : renderQuery->renderableNodes)
+		{
+			if (node->GetComponentFlags() & SceneNode::OCCLUDER)
+				AddOccluder(node);
+		}
+
+		End();
+
+		if (m_OccluderCount == 0)
+			return;
+
+		m_Occluded.clear();
+
+		auto &nodes = renderQuery->renderableNodes;
+		nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [&](const std::shared_ptr<SceneNode> &node)
+		{
+			if (IsVisible(node->GetWorldAABB()))
+				return false;
+
+			m_Occluded.push_back(node.get());
+			return true;
+		}), nodes.end());
+
+		m_CulledCount = m_Occluded.size();
+		if (m_CulledCount == 0)
+			return;
+
+		std::sort(m_Occluded.begin(), m_Occluded.end());
+
+		auto isOccluded = [&](const RenderUnit &unit) -> bool
+		{
+			return std::binary_search(m_Occluded.begin(), m_Occluded.end(), unit.node);
+		};
+
+		auto &opaqueUnits = renderQuery->opaqueUnits;
+		opaqueUnits.erase(std::remove_if(opaqueUnits.begin(), opaqueUnits.end(), isOccluded), opaqueUnits.end());
+
+		auto &transparentUnits = renderQuery->transparentUnits;
+		transparentUnits.erase(std::remove_if(transparentUnits.begin(), transparentUnits.end(), isOccluded), transparentUnits.end());
+	}
+
+	unsigned int OcclusionCuller::GetWidth() const
+	{
+		return m_Width;
+	}
+
+	unsigned int OcclusionCuller::GetHeight() const
+	{
+		return m_Height;
+	}
+
+	const std::vector<float> &OcclusionCuller::GetDepthLevel(unsigned int level) const
+	{
+		return m_Levels[std::min<unsigned int>(level, m_Levels.size() - 1)];
+	}
+
+	unsigned int OcclusionCuller::GetLevelCount() const
+	{
+		return m_Levels.size();
+	}
+
+	unsigned int OcclusionCuller::GetOccluderCount() const
+	{
+		return m_OccluderCount;
+	}
+
+	unsigned int OcclusionCuller::GetTriangleCount() const
+	{
+		return m_TriangleCount;
+	}
+
+	unsigned int OcclusionCuller::GetCulledCount() const
+	{
+		return m_CulledCount;
+	}
+
+	void OcclusionCuller::DrawTriangle(const Vector4 &v0, const Vector4 &v1, const Vector4 &v2)
+	{
+		const Vector4 *vertices[3] = { &v0, &v1, &v2 };
+
+		// all out of one side.
+		if ((v0.x > v0.w && v1.x > v1.w && v2.x > v2.w) || (v0.x < -v0.w && v1.x < -v1.w && v2.x < -v2.w) ||
+			(v0.y > v0.w && v1.y > v1.w && v2.y > v2.w) || (v0.y < -v0.w && v1.y < -v1.w && v2.y < -v2.w) ||
+			(v0.z > v0.w && v1.z > v1.w && v2.z > v2.w))
+			return;
+
+		// clip against the near plane, z + w >= 0.
+		// assigning a Vector4 keeps it's w, so set it by hand.
+		Vector4 polygon[4];
+		unsigned int count = 0;
+
+		for (int i = 0; i < 3; i++)
+		{
+			const Vector4 &a = *vertices[i];
+			const Vector4 &b = *vertices[(i + 1) % 3];
+
+			float da = a.z + a.w;
+			float db = b.z + b.w;
+
+			if (da >= 0.0f)
+			{
+				polygon[count] = a;
+				polygon[count++].w = a.w;
+			}
+
+			if ((da >= 0.0f) != (db >= 0.0f))
+			{
+				float t = da / (da - db);
+				polygon[count] = Vector4(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t);
+				polygon[count++].w = a.w + (b.w - a.w) * t;
+			}
+		}
+
+		if (count < 3)
+			return;
+
+		// to screen space.
+		for (unsigned int i = 0; i < count; i++)
+		{
+			Vector4 &v = polygon[i];
+			float w = std::max(v.w, 1e-6f);
+			v = Vector4((v.x / w * 0.5f + 0.5f) * m_Width, (v.y / w * 0.5f + 0.5f) * m_Height, v.z / w);
+		}
+
+		for (unsigned int i = 2; i < count; i++)
+			RasterizeTriangle(polygon[0], polygon[i - 1], polygon[i]);
+
+		m_TriangleCount++;
+	}
+
+	void OcclusionCuller::RasterizeTriangle(Vector4 v0, Vector4 v1, Vector4 v2)
+	{
+		float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+		if (std::abs(area) < 1e-8f)
+			return;
+
+		// occluders are drawn double sided.
+		if (area < 0.0f)
+		{
+			std::swap(v1, v2);
+			area = -area;
+		}
+
+		// pixels whose center is in the triangle's bounds.
+		int minX = std::max((int)std::ceil(std::min(v0.x, std::min(v1.x, v2.x)) - 0.5f), 0);
+		int minY = std::max((int)std::ceil(std::min(v0.y, std::min(v1.y, v2.y)) - 0.5f), 0);
+		int maxX = std::min((int)std::floor(std::max(v0.x, std::max(v1.x, v2.x)) - 0.5f), (int)m_Width - 1);
+		int maxY = std::min((int)std::floor(std::max(v0.y, std::max(v1.y, v2.y)) - 0.5f), (int)m_Height - 1);
+
+		if (minX > maxX || minY > maxY)
+			return;
+
+		// start at a 4 pixel boundary, m_Width is a multiple of 4.
+		minX &= ~3;
+
+		// edge functions, e(x, y) = a * x + b * y + c, positive inside.
+		float a0 = v1.y - v2.y, b0 = v2.x - v1.x, c0 = v1.x * v2.y - v2.x * v1.y;
+		float a1 = v2.y - v0.y, b1 = v0.x - v2.x, c1 = v2.x * v0.y - v0.x * v2.y;
+		float a2 = v0.y - v1.y, b2 = v1.x - v0.x, c2 = v0.x * v1.y - v1.x * v0.y;
+
+		// depth is linear in screen space.
+		float invArea = 1.0f / area;
+		float za = (a0 * v0.z + a1 * v1.z + a2 * v2.z) * invArea;
+		float zb = (b0 * v0.z + b1 * v1.z + b2 * v2.z) * invArea;
+		float zc = (c0 * v0.z + c1 * v1.z + c2 * v2.z) * invArea;
+
+		auto &depths = m_Levels[0];
+
+#if defined(FURY_USE_SSE)
+		__m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		__m128 zero = _mm_setzero_ps();
+		__m128 va0 = _mm_set1_ps(a0), va1 = _mm_set1_ps(a1), va2 = _mm_set1_ps(a2), vza = _mm_set1_ps(za);
+
+		for (int y = minY; y <= maxY; y++)
+		{
+			float py = y + 0.5f;
+			__m128 row0 = _mm_set1_ps(b0 * py + c0);
+			__m128 row1 = _mm_set1_ps(b1 * py + c1);
+			__m128 row2 = _mm_set1_ps(b2 * py + c2);
+			__m128 rowZ = _mm_set1_ps(zb * py + zc);
+
+			float *row = &depths[y * m_Width];
+
+			for (int x = minX; x <= maxX; x += 4)
+			{
+				__m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+
+				__m128 e0 = _mm_add_ps(_mm_mul_ps(va0, px), row0);
+				__m128 e1 = _mm_add_ps(_mm_mul_ps(va1, px), row1);
+				__m128 e2 = _mm_add_ps(_mm_mul_ps(va2, px), row2);
+
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+
+				__m128 z = _mm_add_ps(_mm_mul_ps(vza, px), rowZ);
+				__m128 old = _mm_loadu_ps(row + x);
+				__m128 nearest = _mm_min_ps(old, z);
+
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+			}
+		}
+#else
+		for (int y = minY; y <= maxY; y++)
+		{
+			float py = y + 0.5f;
+			float *row = &depths[y * m_Width];
+
+			for (int x = minX; x <= maxX; x++)
+			{
+				float px = x + 0.5f;
+
+				if (a0 * px + b0 * py + c0 < 0.0f || a1 * px + b1 * py + c1 < 0.0f || a2 * px + b2 * py + c2 < 0.0f)
+					continue;
+
+				row[x] = std::min(row[x], za * px + zb * py + zc);
+			}
+		}
+#endif
+	}
+
+	void OcclusionCuller::BuildHiZ()
+	{
+		for (unsigned int level = 1; level < m_Levels.size(); level++)
+		{
+			const auto &src = m_Levels[level - 1];
+			auto &dst = m_Levels[level];
+
+			unsigned int srcWidth = m_LevelWidths[level - 1];
+			unsigned int srcHeight = m_LevelHeights[level - 1];
+			unsigned int dstWidth = m_LevelWidths[level];
+			unsigned int dstHeight = m_LevelHeights[level];
+
+			for (unsigned int y = 0; y < dstHeight; y++)
+			{
+				unsigned int y0 = y * 2;
+				unsigned int y1 = std::min(y0 + 1, srcHeight - 1);
+
+				for (unsigned int x = 0; x < dstWidth; x++)
+				{
+					unsigned int x0 = x * 2;
+					unsigned int x1 = std::min(x0 + 1, srcWidth - 1);
+
+					dst[y * dstWidth + x] = std::max(
+						std::max(src[y0 * srcWidth + x0], src[y0 * srcWidth + x1]),
+						std::max(src[y1 * srcWidth + x0], src[y1 * srcWidth + x1]));
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -1,8 +1,12 @@
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
 #include <unordered_map>
 
+#include "BoxBounds.h"
 #include "Camera.h"
+#include "ConvexVolume.h"
 #include "Log.h"
 #include "EnumUtil.h"
 #include "EntityUtil.h"
@@ -14,6 +18,7 @@
 #include "Mesh.h"
 #include "MeshRender.h"
 #include "MeshUtil.h"
+#include "OcclusionCuller.h"
 #include "Pass.h"
 #include "PrelightPipeline.h"
 #include "RenderQuery.h"
@@ -26,6 +31,46 @@
 
 namespace fury
 {
+	// clears buffer and makes room for size elements, counts it if that allocates.
+	template <typename T>
+	static void ReserveScratch(std::vector<T> &buffer, size_t size, unsigned int &allocationCount)
+	{
+		buffer.clear();
+		if (buffer.capacity() < size)
+		{
+			buffer.reserve(size);
+			allocationCount++;
+		}
+	}
+
+	// grows buffer to size elements, to be overwritten, counts it if that allocates.
+	template <typename T>
+	static void GrowScratch(std::vector<T> &buffer, size_t size, unsigned int &allocationCount)
+	{
+		if (buffer.size() >= size)
+			return;
+
+		if (buffer.capacity() < size)
+			allocationCount++;
+
+		buffer.resize(size);
+	}
+
+	// views are sorted by key, returns the view's index or -1.
+	template <typename Key>
+	static int FindShadowView(const std::vector<std::pair<Key, unsigned int>> &views, const Key &key)
+	{
+		auto it = std::lower_bound(views.begin(), views.end(), std::make_pair(key, 0u));
+		return it != views.end() && it->first == key ? (int)it->second : -1;
+	}
+
+	template <typename Key>
+	static void AddShadowView(std::vector<std::pair<Key, unsigned int>> &views, const Key &key, unsigned int index)
+	{
+		auto pair = std::make_pair(key, index);
+		views.insert(std::lower_bound(views.begin(), views.end(), pair), pair);
+	}
+
 	PrelightPipeline::Ptr PrelightPipeline::Create(const std::string &name)
 	{
 		return std::make_shared<PrelightPipeline>(name);
@@ -53,10 +98,17 @@ namespace fury
 		m_CurrentShader = nullptr;
 		SortPassByIndex();
 
+		// apply deferred scene updates before culling
+		sceneManager->FlushUpdates();
+
 		// find visible nodes, 1 cam 1 query
-		std::unordered_map<std::string, RenderQuery::Ptr> queries;
+		unsigned int passCount = m_PassMap.size();
+		ReserveScratch(m_CamNodes, passCount, m_AllocationCount);
+		ReserveScratch(m_CamQueries, passCount, m_AllocationCount);
+		ReserveScratch(m_CamColliders, passCount, m_AllocationCount);
+		GrowScratch(m_CamFrustums, passCount, m_AllocationCount);
 
-		for (auto pair : m_PassMap)
+		for (const auto &pair : m_PassMap)
 		{
 			auto pass = pair.second;
 			auto camNode = pass->GetCameraNode();
@@ -67,23 +119,64 @@ namespace fury
 				continue;
 			}
 
-			auto it = queries.find(camNode->GetName());
-			if (it != queries.end())
+			// queries live across frames so their buffers keep the capacity.
+			CameraView &view = m_CameraViews[camNode->GetName()];
+			RenderQuery::Ptr &query = view.query;
+			if (query == nullptr)
+			{
+				query = RenderQuery::Create();
+				view.shadowLodView = MeshRender::CreateLodView();
+				m_AllocationCount++;
+			}
+			else if (std::find(m_CamQueries.begin(), m_CamQueries.end(), query) != m_CamQueries.end())
+			{
 				continue;
+			}
+
+			query->SetLodView(camNode->GetWorldPosition(), m_LodScale);
+
+			m_CamFrustums[m_CamNodes.size()] = camNode->GetComponent<Camera>()->GetFrustum();
+			m_CamColliders.push_back(&m_CamFrustums[m_CamNodes.size()]);
+			m_CamNodes.push_back(camNode);
+			m_CamQueries.push_back(query);
+		}
+
+		// drop queries of cameras no pass uses anymore.
+		for (auto it = m_CameraViews.begin(); it != m_CameraViews.end();)
+		{
+			if (std::find(m_CamQueries.begin(), m_CamQueries.end(), it->second.query) == m_CamQueries.end())
+				it = m_CameraViews.erase(it);
+			else
+				++it;
+		}
+
+		// one cam can use the parallel walk, more share a single walk.
+		if (m_CamQueries.size() == 1)
+			sceneManager->GetRenderQuery(*m_CamColliders[0], m_CamQueries[0]);
+		else if (m_CamQueries.size() > 1)
+			sceneManager->GetRenderQueries(m_CamColliders, m_CamQueries);
 
-			RenderQuery::Ptr query = RenderQuery::Create();
+		for (unsigned int i = 0; i < m_CamQueries.size(); i++)
+		{
+			RenderUtil::Instance()->IncreaseCullingStats(m_CamQueries[i]->cullingStats);
 
-			sceneManager->GetRenderQuery(camNode->GetComponent<Camera>()->GetFrustum(), query);
-			query->Sort(camNode->GetWorldPosition());
+			if (m_OcclusionCuller != nullptr)
+				m_OcclusionCuller->Cull(m_CamNodes[i], m_CamQueries[i]);
 
-			queries.emplace(camNode->GetName(), query);
+			auto sortStart = std::chrono::high_resolution_clock::now();
+			m_CamQueries[i]->Sort(m_CamNodes[i]->GetWorldPosition());
+			RenderUtil::Instance()->IncreaseSortTime(std::chrono::duration<float, std::milli>(
+				std::chrono::high_resolution_clock::now() - sortStart).count());
 		}
 
+		// find casters of all visible shadow lights at once
+		CullShadowCasters(sceneManager);
+
 		// draw passes
 
 		for (unsigned int i = 0; i < m_SortedPasses.size(); i++)
 		{
-			auto passName = m_SortedPasses[i];
+			const auto &passName = m_SortedPasses[i];
 			auto pass = m_PassMap[passName];
 
 			auto drawMode = pass->GetDrawMode();
@@ -94,13 +187,16 @@ namespace fury
 			if (m_CurrentCamera == nullptr)
 				continue;
 
-			auto query = queries[m_CurrentCamera->GetName()];
+			const auto &view = m_CameraViews[m_CurrentCamera->GetName()];
+			auto query = view.query;
+			m_CurrentShadowLodView = view.shadowLodView;
 
 			if (drawMode == DrawMode::OPAQUE)
 			{
 				pass->Bind();
 				for (const auto &unit : query->opaqueUnits)
 					DrawUnit(pass, unit);
+				EndDrawUnits();
 				pass->UnBind();
 			}
 			else if (drawMode == DrawMode::TRANSPARENT)
@@ -108,6 +204,7 @@ namespace fury
 				pass->Bind();
 				for (const auto &unit : query->transparentUnits)
 					DrawUnit(pass, unit);
+				EndDrawUnits();
 				pass->UnBind();
 			}
 			else if (drawMode == DrawMode::QUAD)
@@ -129,18 +226,210 @@ namespace fury
 		}
 
 		if (m_DrawLightBounds || m_DrawOpaqueBounds)
-			DrawDebug(queries);
+			DrawDebug();
 
 		// post
 		m_CurrentCamera = nullptr;
 		m_CurrentShader = nullptr;
+
+		m_LightShadowViews.clear();
+		m_DirShadowViews.clear();
+
+		// keep the buffers' capacity, not the scenenodes.
+		for (auto &pair : m_CameraViews)
+			pair.second.query->Clear();
+
+		for (auto &casters : m_ShadowCasters)
+			casters.clear();
+
+		m_CamNodes.clear();
+		m_CamQueries.clear();
+		m_CamColliders.clear();
+	}
+
+	void PrelightPipeline::SetOcclusionCuller(const std::shared_ptr<OcclusionCuller> &culler)
+	{
+		m_OcclusionCuller = culler;
+	}
+
+	std::shared_ptr<OcclusionCuller> PrelightPipeline::GetOcclusionCuller() const
+	{
+		return m_OcclusionCuller;
+	}
+
+	void PrelightPipeline::SetLodScale(float scale)
+	{
+		m_LodScale = scale;
+	}
+
+	float PrelightPipeline::GetLodScale() const
+	{
+		return m_LodScale;
+	}
+
+	void PrelightPipeline::SetShadowLodScale(float scale)
+	{
+		m_ShadowLodScale = scale;
+	}
+
+	float PrelightPipeline::GetShadowLodScale() const
+	{
+		return m_ShadowLodScale;
+	}
+
+	unsigned int PrelightPipeline::GetAllocationCount() const
+	{
+		unsigned int count = m_AllocationCount;
+		for (const auto &pair : m_CameraViews)
+			count += pair.second.query->GetAllocationCount();
+
+		return count;
+	}
+
+	void PrelightPipeline::ResetAllocationCount()
+	{
+		m_AllocationCount = 0;
+		for (const auto &pair : m_CameraViews)
+			pair.second.query->ResetAllocationCount();
+	}
+
+	void PrelightPipeline::CullShadowCasters(const std::shared_ptr<SceneManager> &sceneManager)
+	{
+		// each visible light has at most one view per light pass, the buffers are sized for that,
+		// so colliders pointing into them stay put while we collect them.
+		unsigned int viewCount = 0;
+		for (const auto &pair : m_PassMap)
+		{
+			auto camNode = pair.second->GetCameraNode();
+			if (camNode != nullptr && pair.second->GetDrawMode() == DrawMode::LIGHT)
+				viewCount += m_CameraViews[camNode->GetName()].query->lightNodes.size();
+		}
+
+		ReserveScratch(m_LightShadowViews, viewCount, m_AllocationCount);
+		ReserveScratch(m_DirShadowViews, viewCount, m_AllocationCount);
+		ReserveScratch(m_ShadowColliders, viewCount, m_AllocationCount);
+		ReserveScratch(m_CastersOnly, viewCount, m_AllocationCount);
+		GrowScratch(m_CasterVolumes, viewCount, m_AllocationCount);
+		GrowScratch(m_LightSpheres, viewCount, m_AllocationCount);
+		GrowScratch(m_LightFrustums, viewCount, m_AllocationCount);
+
+		unsigned int volumeCount = 0, sphereCount = 0, frustumCount = 0;
+
+		for (const auto &pair : m_PassMap)
+		{
+			auto pass = pair.second;
+			auto camNode = pass->GetCameraNode();
+
+			if (camNode == nullptr || pass->GetDrawMode() != DrawMode::LIGHT)
+				continue;
+
+			auto query = m_CameraViews[camNode->GetName()].query;
+
+			for (const auto &node : query->lightNodes)
+			{
+				auto light = node->GetComponent<Light>();
+				if (!light->GetCastShadows())
+					continue;
+
+				if (light->GetType() == LightType::DIRECTIONAL)
+				{
+					auto key = std::make_pair<const SceneNode*, const SceneNode*>(node.get(), camNode.get());
+					if (FindShadowView(m_DirShadowViews, key) != -1)
+						continue;
+
+					// same volume as DrawDirLightShadowMap.
+					auto camera = camNode->GetComponent<Camera>();
+					ConvexVolume &volume = m_CasterVolumes[volumeCount++];
+					volume.SetExtrudedFrustum(camera->GetFrustum(camera->GetNear(), camera->GetShadowFar()), 
+						node->GetWorldMatrix().Multiply(Vector4(0.0f, -1.0f, 0.0f, 0.0f)));
+
+					AddShadowView(m_DirShadowViews, key, m_ShadowColliders.size());
+					m_ShadowColliders.push_back(&volume);
+					m_CastersOnly.push_back(true);
+				}
+				else
+				{
+					const SceneNode *key = node.get();
+					if (FindShadowView(m_LightShadowViews, key) != -1)
+						continue;
+
+					AddShadowView(m_LightShadowViews, key, m_ShadowColliders.size());
+
+					if (light->GetType() == LightType::POINT)
+					{
+						SphereBounds &sphere = m_LightSpheres[sphereCount++];
+						sphere = SphereBounds(node->GetWorldPosition(), light->GetRadius());
+						m_ShadowColliders.push_back(&sphere);
+						m_CastersOnly.push_back(true);
+					}
+					else
+					{
+						// same frustum as DrawSpotLightShadowMap.
+						Matrix4 lightMatrix;
+						lightMatrix.Rotate(MathUtil::AxisRadToQuat(Vector4::XAxis, MathUtil::DegToRad * 90.0f));
+						lightMatrix = lightMatrix * node->GetInvertWorldMatrix();
+
+						Frustum &frustum = m_LightFrustums[frustumCount++];
+						frustum.Setup(light->GetOutterAngle(), 1.0f, 1.0f, light->GetRadius());
+						frustum.Transform(lightMatrix.Inverse());
+
+						m_ShadowColliders.push_back(&frustum);
+						m_CastersOnly.push_back(false);
+					}
+				}
+			}
+		}
+
+		if (m_ShadowColliders.empty())
+			return;
+
+		// the walk fills the caster lists, count the ones it had to grow.
+		unsigned int colliderCount = m_ShadowColliders.size();
+		if (m_ShadowCasters.capacity() < colliderCount)
+			m_AllocationCount++;
+
+		GrowScratch(m_ShadowCasterCapacities, colliderCount, m_AllocationCount);
+		for (unsigned int i = 0; i < colliderCount; i++)
+			m_ShadowCasterCapacities[i] = i < m_ShadowCasters.size() ? m_ShadowCasters[i].capacity() : 0;
+
+		sceneManager->GetVisibleRenderables(m_ShadowColliders, m_ShadowCasters);
+
+		for (unsigned int i = 0; i < colliderCount; i++)
+		{
+			if (m_ShadowCasters[i].capacity() > m_ShadowCasterCapacities[i])
+				m_AllocationCount++;
+		}
+
+		// dir and point lights only draw shadow casters.
+		for (unsigned int i = 0; i < colliderCount; i++)
+		{
+			if (!m_CastersOnly[i])
+				continue;
+
+			auto &casters = m_ShadowCasters[i];
+			casters.erase(std::remove_if(casters.begin(), casters.end(), [](const SceneNode::Ptr &caster)
+			{
+				return !(caster->GetComponentFlags() & SceneNode::SHADOW_CASTER);
+			}), casters.end());
+		}
+	}
+
+	const std::vector<std::shared_ptr<SceneNode>> *PrelightPipeline::FindShadowCasters(const std::shared_ptr<SceneNode> &lightNode, const std::shared_ptr<SceneNode> &camNode) const
+	{
+		int view;
+		if (lightNode->GetComponent<Light>()->GetType() == LightType::DIRECTIONAL)
+			view = FindShadowView(m_DirShadowViews, std::make_pair<const SceneNode*, const SceneNode*>(lightNode.get(), camNode.get()));
+		else
+			view = FindShadowView(m_LightShadowViews, (const SceneNode*)lightNode.get());
+
+		return view == -1 ? nullptr : &m_ShadowCasters[view];
 	}
 
 	void PrelightPipeline::DrawUnit(const std::shared_ptr<Pass> &pass, const RenderUnit &unit)
 	{
-		auto node = unit.node;
-		auto mesh = unit.mesh;
-		auto material = unit.material;
+		SceneNode *node = unit.node;
+		Mesh *mesh = unit.mesh;
+		Material *material = unit.material;
 
 		auto shader = material->GetShaderForPass(pass->GetRenderIndex());
 
@@ -154,18 +443,28 @@ namespace fury
 			return;
 		}
 
-		shader->Bind();
-		shader->BindCamera(m_CurrentCamera);
-		shader->BindMatrix(Matrix4::WORLD_MATRIX, node->GetWorldMatrix());
+		// skip the program, camera and textures if the last unit bound them already.
+		if (shader != m_BoundShader || material != m_BoundMaterial)
+		{
+			shader->Bind();
 
-		shader->BindMaterial(material);
+			if (shader != m_BoundShader)
+				shader->BindCamera(m_CurrentCamera);
 
-		for (unsigned int i = 0; i < pass->GetTextureCount(true); i++)
-		{
-			auto ptr = pass->GetTextureAt(i, true);
-			shader->BindTexture(ptr->GetName(), ptr);
+			shader->BindMaterial(material);
+
+			for (unsigned int i = 0; i < pass->GetTextureCount(true); i++)
+			{
+				auto ptr = pass->GetTextureAt(i, true);
+				shader->BindTexture(ptr->GetName(), ptr);
+			}
+
+			m_BoundShader = shader;
+			m_BoundMaterial = material;
 		}
 
+		shader->BindMatrix(Matrix4::WORLD_MATRIX, node->GetWorldMatrix());
+
 		if (mesh->GetSubMeshCount() > 0)
 		{
 			auto subMesh = mesh->GetSubMeshAt(unit.subMesh);
@@ -182,8 +481,6 @@ namespace fury
 			RenderUtil::Instance()->IncreaseTriangleCount(mesh->Indices.Data.size());
 		}
 
-		shader->UnBind();
-
 		// TODO: Maybe subMeshCount ? 
 		if (mesh->IsSkinnedMesh())
 			RenderUtil::Instance()->IncreaseSkinnedMeshCount();
@@ -193,6 +490,15 @@ namespace fury
 		RenderUtil::Instance()->IncreaseDrawCall();
 	}
 
+	void PrelightPipeline::EndDrawUnits()
+	{
+		if (m_BoundShader != nullptr)
+			m_BoundShader->UnBind();
+
+		m_BoundShader.reset();
+		m_BoundMaterial = nullptr;
+	}
+
 	void PrelightPipeline::DrawLight(const std::shared_ptr<SceneManager> &sceneManager, const std::shared_ptr<Pass> &pass, const std::shared_ptr<SceneNode> &node)
 	{
 		auto light = node->GetComponent<Light>();
@@ -369,21 +675,73 @@ namespace fury
 		lightMatrix.Rotate(MathUtil::AxisRadToQuat(Vector4::XAxis, MathUtil::DegToRad * 90.0f));
 		lightMatrix = lightMatrix * node->GetInvertWorldMatrix();
 
-		// get camera's frustum's worldspace aabb.
-		auto camAABB = camera->GetFrustum(camera->GetNear(), camera->GetShadowFar()).GetBoxBounds();
+		// shadows only land inside the camera's frustum, up to shadow far.
+		auto frustum = camera->GetFrustum(camera->GetNear(), camera->GetShadowFar());
 
-		// find shadow casters
-		fury::SceneManager::SceneNodes casters;
-		sceneManager->GetVisibleShadowCasters(camAABB, casters);
+		// find shadow casters, anything between the light and the frustum.
+		fury::SceneManager::SceneNodes walkCasters;
+		auto casters = FindShadowCasters(node, camNode);
+		if (casters == nullptr)
+		{
+			ConvexVolume casterVolume(frustum, node->GetWorldMatrix().Multiply(Vector4(0.0f, -1.0f, 0.0f, 0.0f)));
+			sceneManager->GetVisibleShadowCasters(casterVolume, walkCasters);
+			casters = &walkCasters;
+		}
+
+		// fit the projection in light view space, the light looks down -z.
+		BoxBounds frustumBounds;
+		frustumBounds.SetDirty(true);
+		for (const auto &corner : frustum.GetCurrentCorners())
+			frustumBounds.Encapsulate(lightMatrix.Multiply(corner));
+
+		// receivers are the visible renderables in the shadowed part of the frustum.
+		BoxBounds receiverBounds;
+		receiverBounds.SetDirty(true);
+
+		auto viewIt = m_CameraViews.find(camNode->GetName());
+		if (viewIt != m_CameraViews.end())
+		{
+			for (const auto &receiver : viewIt->second.query->renderableNodes)
+			{
+				auto aabb = receiver->GetWorldAABB();
+				if (!aabb.GetInfinite() && frustum.IsInsideFast(aabb))
+					receiverBounds.Encapsulate(lightMatrix.Multiply(aabb));
+			}
+		}
+
+		Vector4 min = frustumBounds.GetMin();
+		Vector4 max = frustumBounds.GetMax();
+
+		if (!receiverBounds.GetDirty())
+		{
+			Vector4 receiverMin = receiverBounds.GetMin();
+			Vector4 receiverMax = receiverBounds.GetMax();
+
+			min.x = std::max(min.x, receiverMin.x);
+			min.y = std::max(min.y, receiverMin.y);
+			min.z = std::max(min.z, receiverMin.z);
+			max.x = std::min(max.x, receiverMax.x);
+			max.y = std::min(max.y, receiverMax.y);
+			max.z = std::min(max.z, receiverMax.z);
+
+			if (min.x >= max.x || min.y >= max.y || min.z >= max.z)
+			{
+				min = frustumBounds.GetMin();
+				max = frustumBounds.GetMax();
+			}
+		}
 
-		// transform world space aabb to light space.
-		camAABB = node->GetInvertWorldMatrix().Multiply(camAABB);
+		// pull the near plane back to the farthest caster towards the light.
+		for (const auto &caster : *casters)
+		{
+			auto aabb = caster->GetWorldAABB();
+			if (!aabb.GetInfinite())
+				max.z = std::max(max.z, lightMatrix.Multiply(aabb).GetMax().z);
+		}
 
 		// gen projection matrix for light.
 		Matrix4 projMatrix;
-		projMatrix.OrthoOffCenter(camAABB.GetMin().x, camAABB.GetMax().x,
-			camAABB.GetMin().y, camAABB.GetMax().y,
-			camAABB.GetMin().z, camAABB.GetMax().z);
+		projMatrix.OrthoOffCenter(min.x, max.x, min.y, max.y, -max.z, -min.z);
 
 		// draw casters to depth map, aka shadow map.
 		{
@@ -403,12 +761,14 @@ namespace fury
 			depth_shader->Bind();
 			depth_shader->BindMatrix(Matrix4::INVERT_VIEW_MATRIX, &lightMatrix.Raw[0]);
 			depth_shader->BindMatrix(Matrix4::PROJECTION_MATRIX, &projMatrix.Raw[0]);
-			depth_shader->BindFloat("camera_far", camAABB.GetMax().z);
+			// depth is stored between the ortho planes, the same range shadowCoord.z has in SunLight.glsl.
+			depth_shader->BindFloat("depth_near", -max.z);
+			depth_shader->BindFloat("camera_far", -min.z);
 
-			for (auto &caster : casters)
+			for (auto &caster : *casters)
 			{
 				auto casterRender = caster->GetComponent<MeshRender>();
-				auto casterMesh = casterRender->GetMesh();
+				auto casterMesh = GetShadowCasterMesh(*caster, *casterRender);
 
 				depth_shader->BindMesh(casterMesh);
 				depth_shader->BindMatrix(Matrix4::WORLD_MATRIX, &caster->GetWorldMatrix().Raw[0]);
@@ -454,8 +814,13 @@ namespace fury
 		auto radius = light->GetRadius();
 		auto lightSphere = SphereBounds(node->GetWorldPosition(), radius);
 
-		fury::SceneManager::SceneNodes casters;
-		sceneManager->GetVisibleShadowCasters(lightSphere, casters);
+		fury::SceneManager::SceneNodes walkCasters;
+		auto casters = FindShadowCasters(node, camNode);
+		if (casters == nullptr)
+		{
+			sceneManager->GetVisibleShadowCasters(lightSphere, walkCasters);
+			casters = &walkCasters;
+		}
 
 		float aspect = (float)depth_buffer->GetWidth() / depth_buffer->GetHeight();
 		Matrix4 projMatrix;
@@ -497,10 +862,10 @@ namespace fury
 				m_SharedPass->BindRenderTargets();
 				m_SharedPass->Bind();
 
-				for (auto &caster : casters)
+				for (auto &caster : *casters)
 				{
 					auto casterRender = caster->GetComponent<MeshRender>();
-					auto casterMesh = casterRender->GetMesh();
+					auto casterMesh = GetShadowCasterMesh(*caster, *casterRender);
 
 					auto ivm = dirMatrices[i];
 
@@ -563,8 +928,13 @@ namespace fury
 		projMatrix.PerspectiveFov(light->GetOutterAngle(), aspect, 1.0f, radius);
 
 		// find shadow casters
-		fury::SceneManager::SceneNodes casters;
-		sceneManager->GetVisibleRenderables(frustum, casters);
+		fury::SceneManager::SceneNodes walkCasters;
+		auto casters = FindShadowCasters(node, pass->GetCameraNode());
+		if (casters == nullptr)
+		{
+			sceneManager->GetVisibleRenderables(frustum, walkCasters);
+			casters = &walkCasters;
+		}
 
 		// draw casters to depth map, aka shadow map.
 		{
@@ -587,10 +957,10 @@ namespace fury
 			depth_shader->BindMatrix(Matrix4::PROJECTION_MATRIX, &projMatrix.Raw[0]);
 			depth_shader->BindFloat("camera_far", radius);
 
-			for (auto &caster : casters)
+			for (auto &caster : *casters)
 			{
 				auto casterRender = caster->GetComponent<MeshRender>();
-				auto casterMesh = casterRender->GetMesh();
+				auto casterMesh = GetShadowCasterMesh(*caster, *casterRender);
 
 				depth_shader->BindMesh(casterMesh);
 				depth_shader->BindMatrix(Matrix4::WORLD_MATRIX, &caster->GetWorldMatrix().Raw[0]);
@@ -624,7 +994,13 @@ namespace fury
 		return std::make_pair(depth_buffer, m_BiasMatrix * projMatrix * lightMatrix * m_CurrentCamera->GetWorldMatrix());
 	}
 
-	void PrelightPipeline::DrawDebug(std::unordered_map<std::string, RenderQuery::Ptr> &queries)
+	std::shared_ptr<Mesh> PrelightPipeline::GetShadowCasterMesh(const SceneNode &caster, const MeshRender &render) const
+	{
+		float distance = (caster.GetWorldPosition() - m_CurrentCamera->GetWorldPosition()).Length();
+		return render.GetLodMesh(render.SelectLod(m_CurrentShadowLodView, distance * m_ShadowLodScale));
+	}
+
+	void PrelightPipeline::DrawDebug()
 	{
 		glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
@@ -643,11 +1019,11 @@ namespace fury
 			if (camNode == nullptr || pass->GetDrawMode() == DrawMode::QUAD)
 				continue;
 
-			auto it = queries.find(camNode->GetName());
-			if (it == queries.end())
+			auto it = m_CameraViews.find(camNode->GetName());
+			if (it == m_CameraViews.end())
 				continue;
 
-			auto visibles = it->second;
+			auto visibles = it->second.query;
 			renderUtil->BeginDrawLines(camNode);
 
 			if (m_DrawOpaqueBounds)
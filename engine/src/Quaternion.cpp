@@ -11,11 +11,6 @@ namespace fury
 		w = 1.0f;
 	}
 
-	float Quaternion::DotProduct(Quaternion other) const
-	{
-		return w * other.w + x * other.x + y * other.y + z * other.z;
-	}
-
 	Quaternion Quaternion::Slerp(Quaternion other, float dt) const
 	{
 		float cosom = DotProduct(other);
@@ -52,18 +47,6 @@ namespace fury
 		return end;
 	}
 
-	Quaternion Quaternion::Conjugate() const
-	{
-		Quaternion other;
-
-		other.x = -x;
-		other.y = -y;
-		other.z = -z;
-		other.w = w;
-
-		return other;
-	}
-
 	Quaternion Quaternion::Pow(float exp) const
 	{
 		if(std::abs(w) > .9999f) return *this;
@@ -103,30 +86,4 @@ namespace fury
 	{
 		return Quaternion(*this);
 	}
-
-	bool Quaternion::operator == (Quaternion other) const
-	{
-		return x == other.x && y == other.y && z == other.z && w == other.w;
-	}
-	
-	bool Quaternion::operator != (Quaternion other) const
-	{
-		return x != other.x || y != other.y || z != other.z || w != other.w;
-	}
-
-	Quaternion &Quaternion::operator = (Quaternion other)
-	{
-		x = other.x; y = other.y; z = other.z; w = other.w;
-		return *this;
-	}
-	
-	Quaternion Quaternion::operator * (Quaternion other) const
-	{
-		return Quaternion(
-			w * other.x + x * other.w + y * other.z - z * other.y, 
-			w * other.y - x * other.z + y * other.w + z * other.x, 
-			w * other.z + x * other.y - y * other.x + z * other.w, 
-			w * other.w - x * other.x - y * other.y - z * other.z
-		);
-	}
 }
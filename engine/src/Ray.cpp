@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "BoxBounds.h"
+#include "Matrix4.h"
+#include "Ray.h"
+
+namespace fury
+{
+	Ray::Ray() 
+	{
+		SetOriginAndDirection(Vector4(0.0f), Vector4::NegZAxis);
+	}
+
+	Ray::Ray(Vector4 origin, Vector4 direction)
+	{
+		SetOriginAndDirection(origin, direction.Normalized());
+	}
+
+	void Ray::SetOriginAndDirection(Vector4 origin, Vector4 direction)
+	{
+		const float inf = std::numeric_limits<float>::infinity();
+
+		m_Origin = Vector4(origin, 1.0f);
+		m_Direction = Vector4(direction, 0.0f);
+		m_InvDirection = Vector4(
+			direction.x != 0.0f ? 1.0f / direction.x : inf,
+			direction.y != 0.0f ? 1.0f / direction.y : inf,
+			direction.z != 0.0f ? 1.0f / direction.z : inf, 0.0f);
+	}
+
+	Vector4 Ray::GetOrigin() const
+	{
+		return m_Origin;
+	}
+
+	Vector4 Ray::GetDirection() const
+	{
+		return m_Direction;
+	}
+
+	Vector4 Ray::GetPoint(float distance) const
+	{
+		return Vector4(m_Origin + m_Direction * distance, 1.0f);
+	}
+
+	bool Ray::Intersects(const BoxBounds &aabb, float maxDistance, float &entry) const
+	{
+		if (aabb.GetInfinite())
+		{
+			entry = 0.0f;
+			return true;
+		}
+
+		Vector4 min = aabb.GetMin();
+		Vector4 max = aabb.GetMax();
+
+		float minRaw[3] = { min.x, min.y, min.z };
+		float maxRaw[3] = { max.x, max.y, max.z };
+
+		return Intersects(minRaw, maxRaw, maxDistance, entry);
+	}
+
+	bool Ray::Intersects(const float *min, const float *max, float maxDistance, float &entry) const
+	{
+		const float origin[3] = { m_Origin.x, m_Origin.y, m_Origin.z };
+		const float invDirection[3] = { m_InvDirection.x, m_InvDirection.y, m_InvDirection.z };
+
+		float near = 0.0f;
+		float far = maxDistance;
+
+		for (int i = 0; i < 3; i++)
+		{
+			float t0 = (min[i] - origin[i]) * invDirection[i];
+			float t1 = (max[i] - origin[i]) * invDirection[i];
+
+			// 0 * inf is nan when the origin is on a slab, count it as inside.
+			if (t0 != t0) t0 = -std::numeric_limits<float>::infinity();
+			if (t1 != t1) t1 = std::numeric_limits<float>::infinity();
+
+			if (t0 > t1)
+				std::swap(t0, t1);
+
+			near = std::max(near, t0);
+			far = std::min(far, t1);
+
+			if (near > far)
+				return false;
+		}
+
+		entry = near;
+		return true;
+	}
+
+	bool Ray::Intersects(Vector4 v0, Vector4 v1, Vector4 v2, float maxDistance, float &distance) const
+	{
+		const float epsilon = 1e-8f;
+
+		// moller trumbore.
+		Vector4 edge1 = v1 - v0;
+		Vector4 edge2 = v2 - v0;
+		Vector4 p = m_Direction.CrossProduct(edge2);
+
+		float det = edge1 * p;
+		if (std::abs(det) < epsilon)
+			return false;
+
+		float invDet = 1.0f / det;
+		Vector4 s = m_Origin - v0;
+
+		float u = (s * p) * invDet;
+		if (u < 0.0f || u > 1.0f)
+			return false;
+
+		Vector4 q = s.CrossProduct(edge1);
+
+		float v = (m_Direction * q) * invDet;
+		if (v < 0.0f || u + v > 1.0f)
+			return false;
+
+		float t = (edge2 * q) * invDet;
+		if (t < 0.0f || t > maxDistance)
+			return false;
+
+		distance = t;
+		return true;
+	}
+
+	Ray Ray::Transform(const Matrix4 &matrix) const
+	{
+		Ray ray;
+		ray.SetOriginAndDirection(matrix.Multiply(m_Origin), matrix.Multiply(m_Direction));
+		return ray;
+	}
+}
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstring>
 #include <functional>
 
 #include "RenderQuery.h"
@@ -17,51 +18,74 @@ namespace fury
 		return std::make_shared<RenderQuery>();
 	}
 
+	RenderQuery::RenderQuery() : m_LodView(MeshRender::CreateLodView())
+	{
+
+	}
+
 	void RenderQuery::AddRenderable(const std::shared_ptr<SceneNode> &node)
 	{
 		auto render = node->GetComponent<MeshRender>();
-		auto mesh = render->GetMesh();
+
+		unsigned int lod = 0;
+		if (m_HasLodView)
+			lod = render->SelectLod(m_LodView, (node->GetWorldPosition() - m_LodPosition).Length() * m_LodScale);
+
+		auto mesh = render->GetLodMesh(lod);
 		auto subMeshCount = mesh->GetSubMeshCount();
 		if (subMeshCount > 0)
 		{
 			for (unsigned int i = 0; i < subMeshCount; i++)
 			{
-				auto subMesh = mesh->GetSubMeshAt(i);
 				auto material = render->GetMaterial(i);
-				if (material->GetOpaque())
-					opaqueUnits.push_back(RenderUnit(node, mesh, material, i));
-				else
-					transparentUnits.push_back(RenderUnit(node, mesh, material, i));
+				AddUnit(material->GetOpaque() ? opaqueUnits : transparentUnits, node.get(), mesh.get(), material.get(), i);
 			}
 		}
 		else
 		{
 			auto material = render->GetMaterial();
-			if (material->GetOpaque())
-				opaqueUnits.push_back(RenderUnit(node, mesh, material, -1));
-			else
-				transparentUnits.push_back(RenderUnit(node, mesh, material, -1));
+			AddUnit(material->GetOpaque() ? opaqueUnits : transparentUnits, node.get(), mesh.get(), material.get(), -1);
 		}
 
+		if (renderableNodes.size() == renderableNodes.capacity())
+			m_AllocationCount++;
+
 		renderableNodes.push_back(node);
 	}
 
 	void RenderQuery::AddLight(const std::shared_ptr<SceneNode> &node)
 	{
+		if (lightNodes.size() == lightNodes.capacity())
+			m_AllocationCount++;
+
 		lightNodes.push_back(node);
 	}
 
-	void RenderQuery::Sort(Vector4 camPos)
+	void RenderQuery::SetLodView(Vector4 position, float scale)
 	{
-		std::sort(opaqueUnits.begin(), opaqueUnits.end(), [&camPos](const RenderUnit &a, const RenderUnit &b) -> bool
-		{
-			return a.node->GetWorldPosition().Distance(camPos) < b.node->GetWorldPosition().Distance(camPos);
-		});
+		m_HasLodView = true;
+		m_LodPosition = position;
+		m_LodScale = scale;
+	}
 
-		std::sort(transparentUnits.begin(), transparentUnits.end(), [&camPos](const RenderUnit &a, const RenderUnit &b) -> bool
-		{
-			return a.node->GetWorldPosition().Distance(camPos) > b.node->GetWorldPosition().Distance(camPos);
-		});
+	void RenderQuery::RemoveLodView()
+	{
+		m_HasLodView = false;
+	}
+
+	void RenderQuery::AddUnit(std::vector<RenderUnit> &units, SceneNode *node, Mesh *mesh, Material *material, int subMesh)
+	{
+		if (units.size() == units.capacity())
+			m_AllocationCount++;
+
+		RenderUnit unit = { node, mesh, material, subMesh, 0 };
+		units.push_back(unit);
+	}
+
+	void RenderQuery::Sort(Vector4 camPos)
+	{
+		SortUnits(opaqueUnits, camPos, true);
+		SortUnits(transparentUnits, camPos, false);
 
 		/*std::sort(lightNodes.begin(), lightNodes.end(), [](const SceneNode::Ptr &a, const SceneNode::Ptr &b) -> bool
 		{
@@ -69,11 +93,120 @@ namespace fury
 		});*/
 	}
 
+	uint64_t RenderQuery::GetSortKey(const RenderUnit &unit, const Vector4 &camPos, bool opaque)
+	{
+		// the pass isn't known here, a query is drawn by every pass of it's camera.
+		// so use what picks the pass's shader: skinned or not and the texture flags.
+		uint64_t shader = (unit.mesh->IsSkinnedMesh() ? 0x80 : 0) | (unit.material->GetTextureFlags() & 0x7f);
+		uint64_t material = unit.material->GetID() & 0xffff;
+		uint64_t mesh = unit.mesh->GetHashCode() & 0xffff;
+
+		// bits of a positive float grow with it, so the squared distance is fine.
+		float distance = (unit.node->GetWorldPosition() - camPos).SquareLength();
+		uint32_t bits;
+		std::memcpy(&bits, &distance, sizeof(bits));
+		uint64_t depth = (bits >> 7) & 0xffffff;
+
+		if (opaque)
+			return (shader << 56) | (material << 40) | (mesh << 24) | depth;
+		else
+			return ((~depth & 0xffffff) << 40) | (shader << 32) | (material << 16) | mesh;
+	}
+
+	void RenderQuery::SortUnits(std::vector<RenderUnit> &units, const Vector4 &camPos, bool opaque)
+	{
+		unsigned int count = units.size();
+		if (count < 2)
+		{
+			for (auto &unit : units)
+				unit.sortKey = GetSortKey(unit, camPos, opaque);
+			return;
+		}
+
+		if (count > m_SortItems.capacity())
+			m_AllocationCount++;
+
+		if (count > m_SortedUnits.capacity())
+			m_AllocationCount++;
+
+		m_SortItems.resize(count);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			units[i].sortKey = GetSortKey(units[i], camPos, opaque);
+			m_SortItems[i].key = units[i].sortKey;
+			m_SortItems[i].index = i;
+		}
+
+		RadixSort(m_SortItems, m_SortBuffer);
+
+		// copy back instead of swapping, so each buffer keeps it's own capacity.
+		m_SortedUnits.resize(count);
+		for (unsigned int i = 0; i < count; i++)
+			m_SortedUnits[i] = units[m_SortItems[i].index];
+
+		std::copy(m_SortedUnits.begin(), m_SortedUnits.end(), units.begin());
+	}
+
+	void RenderQuery::RadixSort(std::vector<SortItem> &items, std::vector<SortItem> &buffer)
+	{
+		const unsigned int passCount = sizeof(uint64_t);
+		unsigned int count = items.size();
+
+		// histograms of all passes in one read.
+		unsigned int histograms[passCount][256];
+		std::memset(histograms, 0, sizeof(histograms));
+
+		for (const auto &item : items)
+		{
+			for (unsigned int pass = 0; pass < passCount; pass++)
+				histograms[pass][(item.key >> (pass * 8)) & 0xff]++;
+		}
+
+		if (count > buffer.capacity())
+			m_AllocationCount++;
+
+		buffer.resize(count);
+
+		for (unsigned int pass = 0; pass < passCount; pass++)
+		{
+			unsigned int *histogram = histograms[pass];
+			unsigned int shift = pass * 8;
+
+			// every key has the same byte, nothing to move.
+			if (histogram[(items[0].key >> shift) & 0xff] == count)
+				continue;
+
+			unsigned int offset = 0;
+			for (unsigned int i = 0; i < 256; i++)
+			{
+				unsigned int bucket = histogram[i];
+				histogram[i] = offset;
+				offset += bucket;
+			}
+
+			for (const auto &item : items)
+				buffer[histogram[(item.key >> shift) & 0xff]++] = item;
+
+			items.swap(buffer);
+		}
+	}
+
 	void RenderQuery::Clear()
 	{
 		opaqueUnits.clear();
 		transparentUnits.clear();
 		renderableNodes.clear();
 		lightNodes.clear();
+		cullingStats = CullingStats();
+	}
+
+	unsigned int RenderQuery::GetAllocationCount() const
+	{
+		return m_AllocationCount;
+	}
+
+	void RenderQuery::ResetAllocationCount()
+	{
+		m_AllocationCount = 0;
 	}
 }
@@ -275,6 +275,8 @@ namespace fury
 		m_TriangleCount = 0;
 		m_SkinnedMeshCount = 0;
 		m_LightCount = 0;
+		m_CullingStats = CullingStats();
+		m_SortTime = 0.0f;
 
 		m_FrameClock.restart();
 
@@ -336,4 +338,24 @@ namespace fury
 	{
 		return m_LightCount;
 	}
+
+	void RenderUtil::IncreaseCullingStats(const CullingStats &stats)
+	{
+		m_CullingStats += stats;
+	}
+
+	const CullingStats &RenderUtil::GetCullingStats()
+	{
+		return m_CullingStats;
+	}
+
+	void RenderUtil::IncreaseSortTime(float time)
+	{
+		m_SortTime += time;
+	}
+
+	float RenderUtil::GetSortTime()
+	{
+		return m_SortTime;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,407 @@
+#include <algorithm>
+#include <chrono>
+
+#include "BoxBounds.h"
+#include "Frustum.h"
+#include "Mesh.h"
+#include "MeshBvh.h"
+#include "MeshRender.h"
+#include "Ray.h"
+#include "RenderQuery.h"
+#include "SceneManager.h"
+#include "SceneNode.h"
+
+namespace fury
+{
+	const unsigned int SceneManager::MaxViews;
+
+	void SceneManager::GetRenderQuery(const Collidable &collider, const std::shared_ptr<RenderQuery> &renderQuery) const
+	{
+		renderQuery->Clear();
+
+		auto start = std::chrono::high_resolution_clock::now();
+		unsigned long long planeTests = Frustum::GetPlaneTestCount();
+		CullingStats walkStats = GetWalkStats();
+		unsigned int emitted = 0;
+
+		WalkSceneParallel(collider, [&](const SceneNode::Ptr &sceneNode)
+		{
+			unsigned int flags = sceneNode->GetComponentFlags();
+			emitted++;
+
+			if (flags & SceneNode::LIGHT)
+				renderQuery->AddLight(sceneNode);
+			
+			if (flags & SceneNode::RENDERABLE)
+				renderQuery->AddRenderable(sceneNode);
+		}, SceneNode::LIGHT | SceneNode::RENDERABLE);
+
+		CullingStats &stats = renderQuery->cullingStats;
+		stats = GetWalkStats();
+		stats -= walkStats;
+		stats.planeTests = Frustum::GetPlaneTestCount() - planeTests;
+		stats.sceneNodesEmitted = emitted;
+		stats.time = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void SceneManager::GetVisibleSceneNodes(const Collidable &collider, SceneNodes &sceneNodes) const
+	{
+		sceneNodes.clear();
+
+		WalkScene(collider, [&](const SceneNode::Ptr &sceneNode) 
+		{
+			sceneNodes.push_back(sceneNode);
+		});
+	}
+
+	void SceneManager::GetVisibleRenderables(const Collidable &collider, SceneNodes &renderables) const
+	{
+		renderables.clear();
+
+		WalkScene(collider, [&](const SceneNode::Ptr &sceneNode)
+		{
+			renderables.push_back(sceneNode);
+		}, SceneNode::RENDERABLE);
+	}
+
+	void SceneManager::GetVisibleShadowCasters(const Collidable &collider, SceneNodes &renderables) const
+	{
+		renderables.clear();
+
+		WalkScene(collider, [&](const SceneNode::Ptr &sceneNode)
+		{
+			renderables.push_back(sceneNode);
+		}, SceneNode::SHADOW_CASTER);
+	}
+
+	void SceneManager::GetVisibleLights(const Collidable &collider, SceneNodes &lights) const
+	{
+		lights.clear();
+
+		WalkScene(collider, [&](const SceneNode::Ptr &sceneNode)
+		{
+			lights.push_back(sceneNode);
+		}, SceneNode::LIGHT);
+	}
+
+	void SceneManager::GetVisibleRenderableAndLights(const Collidable &collider, SceneNodes &renderables, SceneNodes &lights) const
+	{
+		renderables.clear();
+		lights.clear();
+
+		WalkScene(collider, [&](const SceneNode::Ptr &sceneNode)
+		{
+			if (sceneNode->GetComponentFlags() & SceneNode::RENDERABLE)
+				renderables.push_back(sceneNode);
+			else
+				lights.push_back(sceneNode);
+		}, SceneNode::LIGHT | SceneNode::RENDERABLE);
+	}
+
+	void SceneManager::GetRenderQueries(const Colliders &colliders, const std::vector<std::shared_ptr<RenderQuery>> &renderQueries) const
+	{
+		for (const auto &renderQuery : renderQueries)
+			renderQuery->Clear();
+
+		if (renderQueries.empty())
+			return;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		unsigned long long planeTests = Frustum::GetPlaneTestCount();
+		CullingStats walkStats = GetWalkStats();
+
+		WalkSceneViews(colliders, [&](const SceneNode::Ptr &sceneNode, unsigned int firstView, unsigned int viewMask)
+		{
+			unsigned int flags = sceneNode->GetComponentFlags();
+			bool isLight = (flags & SceneNode::LIGHT) != 0;
+			bool isRenderable = (flags & SceneNode::RENDERABLE) != 0;
+
+			for (unsigned int i = 0; viewMask != 0; i++, viewMask >>= 1)
+			{
+				if (!(viewMask & 1))
+					continue;
+
+				auto &renderQuery = renderQueries[firstView + i];
+				renderQuery->cullingStats.sceneNodesEmitted++;
+
+				if (isLight)
+					renderQuery->AddLight(sceneNode);
+
+				if (isRenderable)
+					renderQuery->AddRenderable(sceneNode);
+			}
+		}, SceneNode::LIGHT | SceneNode::RENDERABLE);
+
+		CullingStats &stats = renderQueries[0]->cullingStats;
+		unsigned int emitted = stats.sceneNodesEmitted;
+		stats = GetWalkStats();
+		stats -= walkStats;
+		stats.planeTests = Frustum::GetPlaneTestCount() - planeTests;
+		stats.sceneNodesEmitted = emitted;
+		stats.time = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void SceneManager::GetVisibleRenderables(const Colliders &colliders, std::vector<SceneNodes> &renderables) const
+	{
+		renderables.resize(colliders.size());
+		for (auto &nodes : renderables)
+			nodes.clear();
+
+		WalkSceneViews(colliders, [&](const SceneNode::Ptr &sceneNode, unsigned int firstView, unsigned int viewMask)
+		{
+			for (unsigned int i = 0; viewMask != 0; i++, viewMask >>= 1)
+			{
+				if (viewMask & 1)
+					renderables[firstView + i].push_back(sceneNode);
+			}
+		}, SceneNode::RENDERABLE);
+	}
+
+	void SceneManager::GetVisibleShadowCasters(const Colliders &colliders, std::vector<SceneNodes> &renderables) const
+	{
+		renderables.resize(colliders.size());
+		for (auto &nodes : renderables)
+			nodes.clear();
+
+		WalkSceneViews(colliders, [&](const SceneNode::Ptr &sceneNode, unsigned int firstView, unsigned int viewMask)
+		{
+			for (unsigned int i = 0; viewMask != 0; i++, viewMask >>= 1)
+			{
+				if (viewMask & 1)
+					renderables[firstView + i].push_back(sceneNode);
+			}
+		}, SceneNode::SHADOW_CASTER);
+	}
+
+	bool SceneManager::RayCast(const Ray &ray, RayHit &hit, float maxDistance, unsigned int flags) const
+	{
+		hit.sceneNode = nullptr;
+		hit.distance = maxDistance;
+
+		WalkRay(ray, maxDistance, [&](const SceneNode::Ptr &sceneNode, float entry) -> float
+		{
+			float distance;
+			if (GetRayHit(ray, *sceneNode, entry, hit.distance, distance))
+			{
+				hit.sceneNode = sceneNode;
+				hit.distance = distance;
+			}
+			return hit.distance;
+		}, flags);
+
+		return hit.sceneNode != nullptr;
+	}
+
+	void SceneManager::RayCastAll(const Ray &ray, RayHits &hits, float maxDistance, unsigned int flags) const
+	{
+		hits.clear();
+
+		WalkRay(ray, maxDistance, [&](const SceneNode::Ptr &sceneNode, float entry) -> float
+		{
+			RayHit hit;
+			if (GetRayHit(ray, *sceneNode, entry, maxDistance, hit.distance))
+			{
+				hit.sceneNode = sceneNode;
+				hits.push_back(hit);
+			}
+			return maxDistance;
+		}, flags);
+
+		// exact hits can be further than the entry.
+		std::stable_sort(hits.begin(), hits.end(), [](const RayHit &a, const RayHit &b) -> bool
+		{
+			return a.distance < b.distance;
+		});
+	}
+
+	void SceneManager::WalkRay(const Ray &ray, float maxDistance, const RayFunc &rayFunc, unsigned int flags) const
+	{
+		BoxBounds rayBounds;
+		if (maxDistance >= FLT_MAX)
+		{
+			rayBounds.SetInfinite(true);
+		}
+		else
+		{
+			Vector4 start = ray.GetOrigin();
+			Vector4 end = ray.GetPoint(maxDistance);
+			rayBounds.SetMinMax(
+				Vector4(std::min(start.x, end.x), std::min(start.y, end.y), std::min(start.z, end.z)),
+				Vector4(std::max(start.x, end.x), std::max(start.y, end.y), std::max(start.z, end.z)));
+		}
+
+		std::vector<std::pair<float, SceneNode::Ptr>> candidates;
+
+		WalkScene(rayBounds, [&](const SceneNode::Ptr &sceneNode)
+		{
+			float entry;
+			if (ray.Intersects(sceneNode->GetWorldAABB(), maxDistance, entry))
+				candidates.push_back(std::make_pair(entry, sceneNode));
+		}, flags);
+
+		std::stable_sort(candidates.begin(), candidates.end(), 
+			[](const std::pair<float, SceneNode::Ptr> &a, const std::pair<float, SceneNode::Ptr> &b) -> bool
+		{
+			return a.first < b.first;
+		});
+
+		for (const auto &candidate : candidates)
+		{
+			if (candidate.first > maxDistance)
+				break;
+
+			maxDistance = rayFunc(candidate.second, candidate.first);
+		}
+	}
+
+	void SceneManager::WalkSceneParallel(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags) const
+	{
+		WalkScene(collider, filterFunc, flags);
+	}
+
+	void SceneManager::WalkSceneMulti(const Colliders &colliders, const MultiFilterFunc &filterFunc, unsigned int flags) const
+	{
+		ASSERT_MSG(colliders.size() <= MaxViews, "Too many colliders for one walk!");
+
+		for (unsigned int i = 0; i < colliders.size(); i++)
+		{
+			unsigned int viewMask = 1u << i;
+			WalkScene(*colliders[i], [&](const SceneNode::Ptr &sceneNode)
+			{
+				filterFunc(sceneNode, viewMask);
+			}, flags);
+		}
+	}
+
+	void SceneManager::WalkSceneViews(const Colliders &colliders,
+		const std::function<void(const std::shared_ptr<SceneNode>&, unsigned int firstView, unsigned int viewMask)> &filterFunc,
+		unsigned int flags) const
+	{
+		Colliders views;
+
+		for (unsigned int firstView = 0; firstView < colliders.size(); firstView += MaxViews)
+		{
+			unsigned int viewCount = std::min<unsigned int>(colliders.size() - firstView, MaxViews);
+			views.assign(colliders.begin() + firstView, colliders.begin() + firstView + viewCount);
+
+			WalkSceneMulti(views, [&](const SceneNode::Ptr &sceneNode, unsigned int viewMask)
+			{
+				filterFunc(sceneNode, firstView, viewMask);
+			}, flags);
+		}
+	}
+
+	void SceneManager::SetWalkStatsCounting(bool enable)
+	{
+		m_CountWalkStats = enable;
+	}
+
+	bool SceneManager::GetWalkStatsCounting() const
+	{
+		return m_CountWalkStats;
+	}
+
+	CullingStats SceneManager::GetWalkStats() const
+	{
+		return m_WalkStats;
+	}
+
+	void SceneManager::ResetWalkStats()
+	{
+		m_WalkStats = CullingStats();
+	}
+
+	void SceneManager::SetDeferredUpdates(bool deferred)
+	{
+		m_DeferredUpdates = deferred;
+
+		if (!deferred)
+			FlushUpdates();
+	}
+
+	bool SceneManager::GetDeferredUpdates() const
+	{
+		return m_DeferredUpdates;
+	}
+
+	void SceneManager::QueueUpdate(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		if (!m_DeferredUpdates)
+		{
+			UpdateSceneNode(sceneNode);
+		}
+		else if (!sceneNode->m_UpdateQueued)
+		{
+			sceneNode->m_UpdateQueued = true;
+			m_PendingUpdates.push_back(sceneNode);
+		}
+	}
+
+	void SceneManager::FlushUpdates()
+	{
+		SceneNodes sceneNodes;
+		TakePendingUpdates(sceneNodes);
+
+		for (const auto &sceneNode : sceneNodes)
+			UpdateSceneNode(sceneNode);
+	}
+
+	void SceneManager::UpdateSceneNodeFlags(const SceneNode &sceneNode)
+	{
+
+	}
+
+	void SceneManager::TakePendingUpdates(SceneNodes &sceneNodes)
+	{
+		sceneNodes.clear();
+
+		for (const auto &sceneNode : m_PendingUpdates)
+		{
+			if (sceneNode->m_SceneManager != this)
+				continue;
+
+			sceneNode->m_UpdateQueued = false;
+			sceneNodes.push_back(sceneNode);
+		}
+
+		m_PendingUpdates.clear();
+	}
+
+	void SceneManager::SetSceneManager(SceneNode &sceneNode, SceneManager *manager, unsigned int index)
+	{
+		if (sceneNode.m_SceneManager != manager)
+			sceneNode.m_UpdateQueued = false;
+
+		sceneNode.m_SceneManager = manager;
+		sceneNode.m_SceneManagerIndex = index;
+	}
+
+	unsigned int SceneManager::GetSceneManagerIndex(const SceneNode &sceneNode)
+	{
+		return sceneNode.m_SceneManagerIndex;
+	}
+
+	bool SceneManager::GetRayHit(const Ray &ray, const SceneNode &sceneNode, float entry, float maxDistance, float &distance)
+	{
+		if (entry > maxDistance || sceneNode.GetWorldAABB().GetInfinite())
+			return false;
+
+		if (sceneNode.GetComponentFlags() & SceneNode::RENDERABLE)
+		{
+			auto render = sceneNode.GetComponent<MeshRender>();
+			auto mesh = render->GetMesh();
+			auto bvh = mesh->GetRayCastBvh();
+
+			// skinned meshes move away from their bind pose, only trust their aabb.
+			if (bvh != nullptr && !mesh->IsSkinnedMesh())
+			{
+				// the model space ray's direction isn't normalized, so distances match.
+				Ray modelRay = ray.Transform(sceneNode.GetInvertWorldMatrix());
+				return bvh->RayCast(modelRay, maxDistance, distance);
+			}
+		}
+
+		distance = entry;
+		return true;
+	}
+}
\ No newline at end of file
@@ -4,9 +4,12 @@
 #include "OcTreeNode.h"
 #include "OcTree.h"
 #include "SceneNode.h"
+#include "TransformSystem.h"
 
 namespace fury
 {
+	unsigned int SceneNode::m_SharedFlagsVersion = 0;
+
 	SceneNode::Ptr SceneNode::Create(const std::string &name)
 	{
 		return std::make_shared<SceneNode>(name);
@@ -21,6 +24,9 @@ namespace fury
 
 	SceneNode::~SceneNode()
 	{
+		if (m_TransformSystem != nullptr)
+			m_TransformSystem->Detach(*this);
+
 		RemoveAllComponents(true);
 		RemoveAllChilds();
 		//FURYD << m_Name << " destoried.";
@@ -33,21 +39,27 @@ namespace fury
 		for (auto &comp : m_Components)
 			ptr->AddComponent(comp.second->Clone());
 		// clone translations
-		ptr->SetLocalPosition(m_LocalPosition);
-		ptr->SetLocalRoattion(m_LocalRotation);
-		ptr->SetLocalScale(m_LocalScale);
+		ptr->SetLocalPosition(GetLocalPosition());
+		ptr->SetLocalRoattion(GetLocalRoattion());
+		ptr->SetLocalScale(GetLocalScale());
+		ptr->m_Static = m_Static;
 		return ptr;
 	}
 
 	void SceneNode::SetOcTreeNode(const std::shared_ptr<OcTreeNode> &ocTreeNode)
 	{
+		SceneManager *manager = ocTreeNode != nullptr ? &ocTreeNode->GetManager() : nullptr;
+		if (manager != m_SceneManager)
+			m_UpdateQueued = false;
+
 		m_OcTreeNode = ocTreeNode;
+		m_SceneManager = manager;
 	}
 
 	void SceneNode::RemoveFromOcTree(bool recursively)
 	{
-		if (!m_OcTreeNode.expired())
-			m_OcTreeNode.lock()->RemoveSceneNode(shared_from_this());
+		if (m_SceneManager != nullptr)
+			m_SceneManager->RemoveSceneNode(shared_from_this());
 
 		if (recursively)
 		{
@@ -56,32 +68,86 @@ namespace fury
 		}
 	}
 
+	SceneManager *SceneNode::GetSceneManager() const
+	{
+		return m_SceneManager;
+	}
+
+	void SceneNode::SetStatic(bool value)
+	{
+		m_Static = value;
+	}
+
+	bool SceneNode::GetStatic() const
+	{
+		return m_Static;
+	}
+
+	TransformSystem *SceneNode::GetTransformSystem() const
+	{
+		return m_TransformSystem;
+	}
+
 	void SceneNode::SetModelAABB(const BoxBounds &aabb)
 	{
-		if (aabb.GetInfinite())
+		if (m_TransformSystem != nullptr)
 		{
-			m_ModelAABB = m_LocalAABB = m_WorldAABB = aabb;
+			m_TransformSystem->SetModelAABB(m_TransformIndex, aabb);
 		}
 		else
 		{
 			m_ModelAABB = aabb;
-			m_LocalAABB = m_LocalMatrix.Multiply(m_ModelAABB);
-			m_WorldAABB = m_WorldMatrix.Multiply(m_ModelAABB);
+
+			// a dirty world transform updates them later.
+			if (!m_WorldDirty)
+			{
+				if (aabb.GetInfinite())
+				{
+					m_LocalAABB = m_WorldAABB = aabb;
+				}
+				else
+				{
+					m_LocalAABB = m_LocalMatrix.Multiply(m_ModelAABB);
+					m_WorldAABB = m_WorldMatrix.Multiply(m_ModelAABB);
+				}
+			}
 		}
+
+		// scene managers cache world aabbs, keep them in sync.
+		if (m_SceneManager != nullptr)
+			m_SceneManager->QueueUpdate(shared_from_this());
 	}
 
 	BoxBounds SceneNode::GetModelAABB() const
 	{
+		if (m_TransformSystem != nullptr)
+			return m_TransformSystem->m_ModelAABBs[m_TransformIndex];
+
 		return m_ModelAABB;
 	}
 
 	BoxBounds SceneNode::GetLocalAABB() const
 	{
+		if (m_TransformSystem != nullptr)
+		{
+			const BoxBounds &modelAABB = m_TransformSystem->m_ModelAABBs[m_TransformIndex];
+			return modelAABB.GetInfinite() ? modelAABB : m_TransformSystem->m_LocalMatrices[m_TransformIndex].Multiply(modelAABB);
+		}
+
+		if (m_WorldDirty)
+			UpdateWorldTransform();
+
 		return m_LocalAABB;
 	}
 
 	BoxBounds SceneNode::GetWorldAABB() const
 	{
+		if (m_TransformSystem != nullptr)
+			return m_TransformSystem->m_WorldAABBs.GetAt(m_TransformIndex);
+
+		if (m_WorldDirty)
+			UpdateWorldTransform();
+
 		return m_WorldAABB;
 	}
 
@@ -91,21 +157,86 @@ namespace fury
 
 	void SceneNode::Recompose(bool force)
 	{
-		if (!force && !m_TransformDirty)
+		if (m_TransformSystem != nullptr)
+		{
+			if (force)
+				m_TransformSystem->SetDirty(m_TransformIndex);
 			return;
+		}
 
-		m_TransformDirty = false;
+		if (force)
+			MarkDirty();
+
+		if (!m_TransformChanged && !m_ChildChanged)
+			return;
 
-		// update local matrix
-		m_LocalMatrix.Identity();
-		m_LocalMatrix.AppendTranslation(m_LocalPosition);
-		m_LocalMatrix.AppendRotation(m_LocalRotation);
-		m_LocalMatrix.AppendScale(m_LocalScale);
+		bool changed = m_TransformChanged;
+		m_TransformChanged = false;
+		m_ChildChanged = false;
 
-		m_InvertLocalMatrix = m_LocalMatrix.Inverse();
+		if (changed)
+		{
+			if (m_WorldDirty)
+				UpdateWorldTransform();
+
+			// scene managers cache world aabbs, one update per changed node.
+			if (m_SceneManager != nullptr)
+				m_SceneManager->QueueUpdate(shared_from_this());
+
+			// trigger event
+			OnTransformChange->Emit(shared_from_this());
+		}
+
+		// childs of a changed node changed too, others return early.
+		for (auto &child : m_Childs)
+			child->Recompose();
+	}
+
+	void SceneNode::MarkDirty()
+	{
+		// so ancestors' Recompose finds this node.
+		for (auto parent = m_Parent.lock(); parent != nullptr && !parent->m_ChildChanged; parent = parent->m_Parent.lock())
+			parent->m_ChildChanged = true;
 
-		// update world matrix
-		if (m_Parent.expired())
+		MarkSubTreeDirty();
+	}
+
+	void SceneNode::MarkSubTreeDirty()
+	{
+		// the system updates attached childs of a moving parent outside it.
+		if (m_TransformSystem != nullptr)
+		{
+			m_TransformSystem->SetDirty(m_TransformIndex);
+			return;
+		}
+
+		// updating any descendant would have updated this node, so they're all dirty already.
+		if (m_WorldDirty && m_TransformChanged)
+			return;
+
+		m_WorldDirty = true;
+		m_InvertWorldDirty = true;
+		m_TransformChanged = true;
+
+		for (auto &child : m_Childs)
+			child->MarkSubTreeDirty();
+	}
+
+	void SceneNode::UpdateLocalMatrix() const
+	{
+		if (!m_TransformDirty)
+			return;
+
+		m_TransformDirty = false;
+		m_LocalMatrix.TRS(m_LocalPosition, m_LocalRotation, m_LocalScale);
+	}
+
+	void SceneNode::UpdateWorldTransform() const
+	{
+		UpdateLocalMatrix();
+
+		auto parent = m_Parent.lock();
+		if (parent == nullptr)
 		{
 			m_WorldMatrix = m_LocalMatrix;
 			m_WorldPosition = m_LocalPosition;
@@ -114,85 +245,153 @@ namespace fury
 		}
 		else
 		{
-			Matrix4 matrix = m_Parent.lock()->GetWorldMatrix();
+			AffineMatrix matrix = parent->GetAffineWorldMatrix();
 			m_WorldMatrix = matrix * m_LocalMatrix;
 			m_WorldPosition = matrix.Multiply(m_LocalPosition);
 			m_WorldRotation = matrix.Multiply(m_LocalRotation);
 			m_WorldScale = matrix.Multiply(m_LocalScale);
 		}
-		m_InvertWorldMatrix = m_WorldMatrix.Inverse();
-
-		// update bounding box
-		SetModelAABB(m_ModelAABB);
 
-		// update octree info
-		if (!m_OcTreeNode.expired())
-			m_OcTreeNode.lock()->GetManager().UpdateSceneNode(shared_from_this());
+		m_WorldDirty = false;
+		m_InvertWorldDirty = true;
 
-		// trigger event
-		OnTransformChange->Emit(shared_from_this());
-
-		// force update child nodes' matrix
-		for (auto &child : m_Childs)
-			child->Recompose(true);
+		if (m_ModelAABB.GetInfinite())
+		{
+			m_LocalAABB = m_WorldAABB = m_ModelAABB;
+		}
+		else
+		{
+			m_LocalAABB = m_LocalMatrix.Multiply(m_ModelAABB);
+			m_WorldAABB = m_WorldMatrix.Multiply(m_ModelAABB);
+		}
 	}
 
 	Matrix4 SceneNode::GetLocalMatrix() const
 	{
-		return m_LocalMatrix;
+		if (m_TransformSystem != nullptr)
+			return m_TransformSystem->m_LocalMatrices[m_TransformIndex].ToMatrix4();
+
+		UpdateLocalMatrix();
+		return m_LocalMatrix.ToMatrix4();
 	}
 
 	Matrix4 SceneNode::GetInvertLocalMatrix() const
 	{
-		return m_InvertLocalMatrix;
+		// cheap enough from the local trs, it's not cached.
+		AffineMatrix matrix;
+		matrix.InverseTRS(GetLocalPosition(), GetLocalRoattion(), GetLocalScale());
+		return matrix.ToMatrix4();
 	}
 
 	Matrix4 SceneNode::GetWorldMatrix() const
 	{
-		return m_WorldMatrix;
+		return GetAffineWorldMatrix().ToMatrix4();
 	}
 
 	Matrix4 SceneNode::GetInvertWorldMatrix() const
 	{
-		return m_InvertWorldMatrix;
+		if (m_TransformSystem != nullptr)
+			return m_TransformSystem->GetInvertWorldMatrix(m_TransformIndex).ToMatrix4();
+
+		if (m_WorldDirty)
+			UpdateWorldTransform();
+
+		if (m_InvertWorldDirty)
+		{
+			m_InvertWorldMatrix = m_WorldMatrix.InverseAffine();
+			m_InvertWorldDirty = false;
+		}
+
+		return m_InvertWorldMatrix.ToMatrix4();
+	}
+
+	AffineMatrix SceneNode::GetAffineWorldMatrix() const
+	{
+		if (m_TransformSystem != nullptr)
+			return m_TransformSystem->m_WorldMatrices[m_TransformIndex];
+
+		if (m_WorldDirty)
+			UpdateWorldTransform();
+
+		return m_WorldMatrix;
 	}
 
 	Vector4 SceneNode::GetWorldPosition() const
 	{
+		if (m_TransformSystem != nullptr)
+			return m_TransformSystem->m_WorldMatrices[m_TransformIndex].GetTranslation();
+
+		if (m_WorldDirty)
+			UpdateWorldTransform();
+
 		return m_WorldPosition;
 	}
 
 	Quaternion SceneNode::GetWorldRoattion() const
 	{
+		if (m_TransformSystem != nullptr)
+		{
+			auto parent = m_Parent.lock();
+			return parent != nullptr ? parent->GetAffineWorldMatrix().Multiply(GetLocalRoattion()) : GetLocalRoattion();
+		}
+
+		if (m_WorldDirty)
+			UpdateWorldTransform();
+
 		return m_WorldRotation;
 	}
 
 	Vector4 SceneNode::GetWorldScale() const
 	{
+		if (m_TransformSystem != nullptr)
+		{
+			auto parent = m_Parent.lock();
+			return parent != nullptr ? parent->GetAffineWorldMatrix().Multiply(GetLocalScale()) : GetLocalScale();
+		}
+
+		if (m_WorldDirty)
+			UpdateWorldTransform();
+
 		return m_WorldScale;
 	}
 
 	Vector4 SceneNode::GetLocalPosition() const
 	{
+		if (m_TransformSystem != nullptr)
+			return m_TransformSystem->m_LocalPositions[m_TransformIndex];
+
 		return m_LocalPosition;
 	}
 
 	Quaternion SceneNode::GetLocalRoattion() const
 	{
+		if (m_TransformSystem != nullptr)
+			return m_TransformSystem->m_LocalRotations[m_TransformIndex];
+
 		return m_LocalRotation;
 	}
 
 	Vector4 SceneNode::GetLocalScale() const
 	{
+		if (m_TransformSystem != nullptr)
+			return m_TransformSystem->m_LocalScales[m_TransformIndex];
+
 		return m_LocalScale;
 	}
 
 	void SceneNode::SetLocalPosition(Vector4 position)
 	{
+		if (m_TransformSystem != nullptr)
+		{
+			m_TransformSystem->SetLocalPosition(m_TransformIndex, position);
+			return;
+		}
+
 		if (m_TransformDirty || m_LocalPosition != position)
 		{
 			m_LocalPosition = position;
 			m_TransformDirty = true;
+			MarkDirty();
 		}
 	}
 
@@ -203,10 +402,17 @@ namespace fury
 
 	void SceneNode::SetLocalRoattion(Quaternion rotation)
 	{
+		if (m_TransformSystem != nullptr)
+		{
+			m_TransformSystem->SetLocalRotation(m_TransformIndex, rotation);
+			return;
+		}
+
 		if (m_TransformDirty || m_LocalRotation != rotation)
 		{
 			m_LocalRotation = rotation;
 			m_TransformDirty = true;
+			MarkDirty();
 		}
 	}
 
@@ -223,10 +429,17 @@ namespace fury
 
 	void SceneNode::SetLocalScale(Vector4 scale)
 	{
+		if (m_TransformSystem != nullptr)
+		{
+			m_TransformSystem->SetLocalScale(m_TransformIndex, scale);
+			return;
+		}
+
 		if (m_TransformDirty || m_LocalScale != scale)
 		{
 			m_LocalScale = scale;
 			m_TransformDirty = true;
+			MarkDirty();
 		}
 	}
 
@@ -242,6 +455,14 @@ namespace fury
 	void SceneNode::SetParent(const SceneNode::Ptr &parent)
 	{
 		m_Parent = parent;
+
+		// childs join their parent's transform system.
+		if (parent != nullptr && parent->m_TransformSystem != nullptr && parent->m_TransformSystem != m_TransformSystem)
+			parent->m_TransformSystem->AddSceneNode(shared_from_this());
+
+		if (m_TransformSystem != nullptr)
+			m_TransformSystem->Reparent(*this);
+
 		Recompose(true);
 	}
 
@@ -427,6 +648,7 @@ namespace fury
 		if (it.second)
 		{
 			ptr->OnAttaching(shared_from_this());
+			UpdateComponentFlags();
 			return true;
 		}
 		return false;
@@ -443,6 +665,7 @@ namespace fury
 			m_Components.erase(it);
 
 			ptr->OnDetaching(shared_from_this());
+			UpdateComponentFlags();
 			return true;
 		}
 
@@ -470,5 +693,41 @@ namespace fury
 		}
 			
 		m_Components.clear();
+
+		if (!destructing)
+			UpdateComponentFlags();
+	}
+
+	unsigned int SceneNode::GetComponentFlags() const
+	{
+		if (m_ComponentFlagsVersion != m_SharedFlagsVersion)
+		{
+			m_ComponentFlags = 0;
+			for (const auto &pair : m_Components)
+				m_ComponentFlags |= pair.second->GetComponentFlags();
+
+			m_ComponentFlagsVersion = m_SharedFlagsVersion;
+		}
+
+		return m_ComponentFlags;
+	}
+
+	void SceneNode::UpdateComponentFlags()
+	{
+		m_ComponentFlagsVersion = m_SharedFlagsVersion - 1;
+		GetComponentFlags();
+
+		if (m_SceneManager != nullptr)
+			m_SceneManager->UpdateSceneNodeFlags(*this);
+	}
+
+	void SceneNode::InvalidateComponentFlags()
+	{
+		m_SharedFlagsVersion++;
+	}
+
+	unsigned int SceneNode::GetComponentFlagsVersion()
+	{
+		return m_SharedFlagsVersion;
 	}
 }
\ No newline at end of file
@@ -408,6 +408,11 @@ namespace fury
 	}
 
 	void Shader::BindMaterial(const std::shared_ptr<Material> &material)
+	{
+		BindMaterial(material.get());
+	}
+
+	void Shader::BindMaterial(const Material *material)
 	{
 		if (m_Dirty)
 			return;
@@ -419,13 +424,13 @@ namespace fury
 
 		for (auto it = material->m_Uniforms.begin(); it != material->m_Uniforms.end(); ++it)
 		{
-			UniformBase::Ptr &ptr = it->second;
+			const UniformBase::Ptr &ptr = it->second;
 			if (ptr != nullptr)
 				ptr->Bind(m_Program, it->first.c_str());
 		}
 	}
 
-	void Shader::BindMeshData(const std::shared_ptr<Mesh> &mesh)
+	void Shader::BindMeshData(Mesh *mesh)
 	{
 		int posFlag = glGetAttribLocation(m_Program, mesh->Positions.Name.c_str());
 		int normalFlag = glGetAttribLocation(m_Program, mesh->Normals.Name.c_str());
@@ -559,6 +564,11 @@ namespace fury
 	}
 
 	void Shader::BindMesh(const std::shared_ptr<Mesh> &mesh)
+	{
+		BindMesh(mesh.get());
+	}
+
+	void Shader::BindMesh(Mesh *mesh)
 	{
 		if (mesh->GetDirty())
 			mesh->UpdateBuffer();
@@ -572,6 +582,11 @@ namespace fury
 	}
 
 	void Shader::BindSubMesh(const std::shared_ptr<Mesh> &mesh, unsigned int index)
+	{
+		BindSubMesh(mesh.get(), index);
+	}
+
+	void Shader::BindSubMesh(Mesh *mesh, unsigned int index)
 	{
 		auto subMesh = mesh->GetSubMeshAt(index);
 		if (subMesh == nullptr)
@@ -847,4 +862,4 @@ namespace fury
 			break;
 		}
 	}
-}
\ No newline at end of file
+}
\ No newline at end of file
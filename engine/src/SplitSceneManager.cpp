@@ -0,0 +1,162 @@
+#include "BvhSceneManager.h"
+#include "SceneNode.h"
+#include "SplitSceneManager.h"
+#include "Log.h"
+
+namespace fury
+{
+	SplitSceneManager::Ptr SplitSceneManager::Create(const std::shared_ptr<SceneManager> &dynamicManager)
+	{
+		return std::make_shared<SplitSceneManager>(dynamicManager);
+	}
+
+	SplitSceneManager::SplitSceneManager(const std::shared_ptr<SceneManager> &dynamicManager) :
+		m_TypeIndex(typeid(SplitSceneManager)), m_DynamicManager(dynamicManager)
+	{
+		ASSERT_MSG(dynamicManager != nullptr, "SplitSceneManager needs a dynamic manager!");
+
+		m_StaticManager = BvhSceneManager::Create();
+	}
+
+	SplitSceneManager::~SplitSceneManager()
+	{
+		Clear();
+		FURYD << "SplitSceneManager::~SplitSceneManager";
+	}
+
+	std::type_index SplitSceneManager::GetTypeIndex() const
+	{
+		return m_TypeIndex;
+	}
+
+	void SplitSceneManager::AddSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		SceneManager *target = sceneNode->GetStatic() ? m_StaticManager.get() : m_DynamicManager.get();
+
+		// re-adding after SetStatic moves it to the other half.
+		auto manager = sceneNode->GetSceneManager();
+		if (manager == target)
+		{
+			target->UpdateSceneNode(sceneNode);
+			return;
+		}
+		else if (manager != nullptr)
+		{
+			manager->RemoveSceneNode(sceneNode);
+		}
+
+		target->AddSceneNode(sceneNode);
+	}
+
+	void SplitSceneManager::AddSceneNodeRecursively(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		AddSceneNode(sceneNode);
+
+		for (unsigned int i = 0; i < sceneNode->GetChildCount(); i++)
+			AddSceneNodeRecursively(sceneNode->GetChildAt(i));
+	}
+
+	void SplitSceneManager::RemoveSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		if (Holds(*sceneNode))
+			sceneNode->GetSceneManager()->RemoveSceneNode(sceneNode);
+	}
+
+	void SplitSceneManager::UpdateSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		if (Holds(*sceneNode))
+			sceneNode->GetSceneManager()->UpdateSceneNode(sceneNode);
+	}
+
+	void SplitSceneManager::SetDeferredUpdates(bool deferred)
+	{
+		// scenenodes queue on the half they're attached to.
+		m_StaticManager->SetDeferredUpdates(deferred);
+		m_DynamicManager->SetDeferredUpdates(deferred);
+
+		SceneManager::SetDeferredUpdates(deferred);
+	}
+
+	void SplitSceneManager::FlushUpdates()
+	{
+		m_StaticManager->FlushUpdates();
+		m_DynamicManager->FlushUpdates();
+	}
+
+	void SplitSceneManager::SetWalkStatsCounting(bool enable)
+	{
+		m_StaticManager->SetWalkStatsCounting(enable);
+		m_DynamicManager->SetWalkStatsCounting(enable);
+
+		SceneManager::SetWalkStatsCounting(enable);
+	}
+
+	CullingStats SplitSceneManager::GetWalkStats() const
+	{
+		CullingStats stats = m_StaticManager->GetWalkStats();
+		stats += m_DynamicManager->GetWalkStats();
+		return stats;
+	}
+
+	void SplitSceneManager::ResetWalkStats()
+	{
+		m_StaticManager->ResetWalkStats();
+		m_DynamicManager->ResetWalkStats();
+	}
+
+	void SplitSceneManager::WalkScene(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags) const
+	{
+		m_StaticManager->WalkScene(collider, filterFunc, flags);
+		m_DynamicManager->WalkScene(collider, filterFunc, flags);
+	}
+
+	void SplitSceneManager::WalkSceneParallel(const Collidable &collider, const FilterFunc &filterFunc, unsigned int flags) const
+	{
+		m_StaticManager->WalkSceneParallel(collider, filterFunc, flags);
+		m_DynamicManager->WalkSceneParallel(collider, filterFunc, flags);
+	}
+
+	void SplitSceneManager::WalkSceneMulti(const Colliders &colliders, const MultiFilterFunc &filterFunc, unsigned int flags) const
+	{
+		m_StaticManager->WalkSceneMulti(colliders, filterFunc, flags);
+		m_DynamicManager->WalkSceneMulti(colliders, filterFunc, flags);
+	}
+
+	void SplitSceneManager::WalkRay(const Ray &ray, float maxDistance, const RayFunc &rayFunc, unsigned int flags) const
+	{
+		m_StaticManager->WalkRay(ray, maxDistance, [&](const SceneNode::Ptr &sceneNode, float entry) -> float
+		{
+			maxDistance = rayFunc(sceneNode, entry);
+			return maxDistance;
+		}, flags);
+
+		m_DynamicManager->WalkRay(ray, maxDistance, rayFunc, flags);
+	}
+
+	void SplitSceneManager::Clear()
+	{
+		m_StaticManager->Clear();
+		m_DynamicManager->Clear();
+	}
+
+	void SplitSceneManager::Freeze()
+	{
+		m_StaticManager->Refresh();
+	}
+
+	std::shared_ptr<BvhSceneManager> SplitSceneManager::GetStaticManager() const
+	{
+		return m_StaticManager;
+	}
+
+	std::shared_ptr<SceneManager> SplitSceneManager::GetDynamicManager() const
+	{
+		return m_DynamicManager;
+	}
+
+	bool SplitSceneManager::Holds(const SceneNode &sceneNode) const
+	{
+		auto manager = sceneNode.GetSceneManager();
+		return manager != nullptr && (manager == m_StaticManager.get() || manager == m_DynamicManager.get());
+	}
+}
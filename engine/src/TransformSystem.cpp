@@ -0,0 +1,494 @@
+#include <future>
+
+#include "SceneManager.h"
+#include "SceneNode.h"
+#include "ThreadUtil.h"
+#include "TransformSystem.h"
+
+namespace fury
+{
+	const unsigned int TransformSystem::InvalidIndex = 0xffffffff;
+
+	// gathers values into the given order.
+	template<class Type>
+	static void Permute(std::vector<Type> &values, const std::vector<unsigned int> &order)
+	{
+		std::vector<Type> sorted;
+		sorted.reserve(order.size());
+
+		for (auto index : order)
+			sorted.push_back(values[index]);
+
+		values.swap(sorted);
+	}
+
+	// moves the last value into index, then pops back.
+	template<class Type>
+	static void RemoveAt(std::vector<Type> &values, unsigned int index)
+	{
+		values[index] = values.back();
+		values.pop_back();
+	}
+
+	TransformSystem::Ptr TransformSystem::Create()
+	{
+		return std::make_shared<TransformSystem>();
+	}
+
+	TransformSystem::~TransformSystem()
+	{
+		Clear();
+	}
+
+	void TransformSystem::AddSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		if (sceneNode->m_TransformSystem != this)
+		{
+			if (sceneNode->m_TransformSystem != nullptr)
+				sceneNode->m_TransformSystem->Detach(*sceneNode);
+
+			Attach(*sceneNode);
+		}
+
+		for (const auto &child : sceneNode->m_Childs)
+			AddSceneNode(child);
+	}
+
+	void TransformSystem::RemoveSceneNode(const std::shared_ptr<SceneNode> &sceneNode)
+	{
+		if (sceneNode->m_TransformSystem == this)
+			Detach(*sceneNode);
+
+		for (const auto &child : sceneNode->m_Childs)
+			RemoveSceneNode(child);
+
+		// a parent left in a system never recomposes it's detached childs.
+		auto parent = sceneNode->m_Parent.lock();
+		if (parent != nullptr && parent->m_TransformSystem != nullptr)
+			sceneNode->Recompose();
+	}
+
+	void TransformSystem::Update()
+	{
+		if (m_OrderDirty)
+			Sort();
+
+		m_ChangedCount = 0;
+
+		if (m_DirtyCount == 0)
+			return;
+
+		if (m_UpdateTasks.empty())
+			m_UpdateTasks.resize(1);
+
+		UpdateTask &task = m_UpdateTasks[0];
+		task.begin = 0;
+		task.end = m_SceneNodes.size();
+
+		UpdateRange(task);
+		EndUpdate(1);
+	}
+
+	void TransformSystem::UpdateParallel()
+	{
+		auto &threadUtil = ThreadUtil::Instance();
+		unsigned int workerCount = threadUtil->GetWorkerCount();
+
+		// waiting for tasks on a worker could deadlock the pool.
+		if (workerCount < 2 || m_SceneNodes.size() < m_ParallelThreshold || !threadUtil->IsMainThread())
+		{
+			Update();
+			return;
+		}
+
+		if (m_OrderDirty)
+			Sort();
+
+		m_ChangedCount = 0;
+
+		if (m_DirtyCount == 0)
+			return;
+
+		// roots read their parent outside the system, update those here.
+		for (auto root : m_RootIndices)
+		{
+			if (!m_Dirty[root])
+				continue;
+
+			auto parent = m_SceneNodes[root]->m_Parent.lock();
+			if (parent != nullptr)
+				parent->GetAffineWorldMatrix();
+		}
+
+		// runs of whole root subtrees, a few per worker.
+		unsigned int count = m_SceneNodes.size();
+		unsigned int targetSize = count / (workerCount * 4) + 1;
+		unsigned int taskCount = 0;
+
+		for (unsigned int i = 0; i < m_RootIndices.size(); i++)
+		{
+			unsigned int end = i + 1 < m_RootIndices.size() ? m_RootIndices[i + 1] : count;
+
+			// grow the last task until it's big enough.
+			if (taskCount > 0 && m_UpdateTasks[taskCount - 1].end - m_UpdateTasks[taskCount - 1].begin < targetSize)
+			{
+				m_UpdateTasks[taskCount - 1].end = end;
+				continue;
+			}
+
+			if (m_UpdateTasks.size() <= taskCount)
+				m_UpdateTasks.resize(taskCount + 1);
+
+			m_UpdateTasks[taskCount].begin = m_RootIndices[i];
+			m_UpdateTasks[taskCount].end = end;
+			taskCount++;
+		}
+
+		std::vector<std::future<void>> futures;
+		futures.reserve(taskCount);
+
+		for (unsigned int i = 0; i < taskCount; i++)
+		{
+			UpdateTask &task = m_UpdateTasks[i];
+			futures.push_back(threadUtil->Enqueue([this, &task]()
+			{
+				UpdateRange(task);
+			}));
+		}
+
+		for (auto &future : futures)
+			future.get();
+
+		EndUpdate(taskCount);
+	}
+
+	void TransformSystem::SetParallelThreshold(unsigned int sceneNodeCount)
+	{
+		m_ParallelThreshold = sceneNodeCount;
+	}
+
+	unsigned int TransformSystem::GetParallelThreshold() const
+	{
+		return m_ParallelThreshold;
+	}
+
+	void TransformSystem::Clear()
+	{
+		// detaching the last one doesn't move others.
+		while (!m_SceneNodes.empty())
+			Detach(*m_SceneNodes.back());
+
+		m_RootIndices.clear();
+		m_OrderDirty = false;
+	}
+
+	unsigned int TransformSystem::GetSceneNodeCount() const
+	{
+		return m_SceneNodes.size();
+	}
+
+	unsigned int TransformSystem::GetChangedCount() const
+	{
+		return m_ChangedCount;
+	}
+
+	const BoxBoundsArray &TransformSystem::GetWorldAABBs() const
+	{
+		return m_WorldAABBs;
+	}
+
+	const AffineMatrix &TransformSystem::GetInvertWorldMatrix(unsigned int index) const
+	{
+		if (m_InvertWorldDirty[index])
+		{
+			m_InvertWorldMatrices[index] = m_WorldMatrices[index].InverseAffine();
+			m_InvertWorldDirty[index] = 0;
+		}
+
+		return m_InvertWorldMatrices[index];
+	}
+
+	void TransformSystem::Attach(SceneNode &sceneNode)
+	{
+		sceneNode.m_TransformSystem = this;
+		sceneNode.m_TransformIndex = m_SceneNodes.size();
+
+		m_SceneNodes.push_back(&sceneNode);
+		m_Parents.push_back(InvalidIndex);
+		m_LocalPositions.push_back(sceneNode.m_LocalPosition);
+		m_LocalRotations.push_back(sceneNode.m_LocalRotation);
+		m_LocalScales.push_back(sceneNode.m_LocalScale);
+		m_LocalMatrices.push_back(sceneNode.m_LocalMatrix);
+		m_WorldMatrices.push_back(sceneNode.m_WorldMatrix);
+		m_InvertWorldMatrices.push_back(AffineMatrix());
+		m_InvertWorldDirty.push_back(1);
+		m_ModelAABBs.push_back(sceneNode.m_ModelAABB);
+		m_WorldAABBs.Add(sceneNode.m_WorldAABB);
+		m_Dirty.push_back(1);
+		m_Changed.push_back(0);
+
+		m_DirtyCount++;
+		m_OrderDirty = true;
+	}
+
+	void TransformSystem::Detach(SceneNode &sceneNode)
+	{
+		unsigned int index = sceneNode.m_TransformIndex;
+
+		// hand the last updated transforms back to the scenenode.
+		sceneNode.m_WorldRotation = sceneNode.GetWorldRoattion();
+		sceneNode.m_WorldScale = sceneNode.GetWorldScale();
+		sceneNode.m_WorldPosition = sceneNode.GetWorldPosition();
+
+		sceneNode.m_LocalPosition = m_LocalPositions[index];
+		sceneNode.m_LocalRotation = m_LocalRotations[index];
+		sceneNode.m_LocalScale = m_LocalScales[index];
+		sceneNode.m_LocalMatrix = m_LocalMatrices[index];
+		sceneNode.m_WorldMatrix = m_WorldMatrices[index];
+		sceneNode.m_TransformDirty = false;
+		sceneNode.m_WorldDirty = false;
+		sceneNode.m_InvertWorldDirty = true;
+
+		sceneNode.m_ModelAABB = m_ModelAABBs[index];
+		if (sceneNode.m_ModelAABB.GetInfinite())
+		{
+			sceneNode.m_LocalAABB = sceneNode.m_WorldAABB = sceneNode.m_ModelAABB;
+		}
+		else
+		{
+			sceneNode.m_LocalAABB = sceneNode.m_LocalMatrix.Multiply(sceneNode.m_ModelAABB);
+			sceneNode.m_WorldAABB = sceneNode.m_WorldMatrix.Multiply(sceneNode.m_ModelAABB);
+		}
+
+		bool dirty = m_Dirty[index] != 0;
+		if (dirty)
+			m_DirtyCount--;
+
+		sceneNode.m_TransformSystem = nullptr;
+		sceneNode.m_TransformIndex = 0;
+
+		// pending change, marks clean descendants and lets ancestors' Recompose find it.
+		if (dirty)
+		{
+			sceneNode.m_TransformDirty = true;
+			sceneNode.MarkDirty();
+		}
+
+		unsigned int last = m_SceneNodes.size() - 1;
+		if (index != last)
+			m_SceneNodes[last]->m_TransformIndex = index;
+
+		RemoveAt(m_SceneNodes, index);
+		RemoveAt(m_Parents, index);
+		RemoveAt(m_LocalPositions, index);
+		RemoveAt(m_LocalRotations, index);
+		RemoveAt(m_LocalScales, index);
+		RemoveAt(m_LocalMatrices, index);
+		RemoveAt(m_WorldMatrices, index);
+		RemoveAt(m_InvertWorldMatrices, index);
+		RemoveAt(m_InvertWorldDirty, index);
+		RemoveAt(m_ModelAABBs, index);
+		m_WorldAABBs.RemoveAt(index);
+		RemoveAt(m_Dirty, index);
+		RemoveAt(m_Changed, index);
+
+		m_OrderDirty = true;
+	}
+
+	void TransformSystem::Reparent(SceneNode &sceneNode)
+	{
+		SetDirty(sceneNode.m_TransformIndex);
+		m_OrderDirty = true;
+	}
+
+	void TransformSystem::SetDirty(unsigned int index)
+	{
+		if (!m_Dirty[index])
+		{
+			m_Dirty[index] = 1;
+			m_DirtyCount++;
+		}
+	}
+
+	void TransformSystem::SetLocalPosition(unsigned int index, Vector4 position)
+	{
+		if (m_Dirty[index] || m_LocalPositions[index] != position)
+		{
+			m_LocalPositions[index] = position;
+			SetDirty(index);
+		}
+	}
+
+	void TransformSystem::SetLocalRotation(unsigned int index, Quaternion rotation)
+	{
+		if (m_Dirty[index] || m_LocalRotations[index] != rotation)
+		{
+			m_LocalRotations[index] = rotation;
+			SetDirty(index);
+		}
+	}
+
+	void TransformSystem::SetLocalScale(unsigned int index, Vector4 scale)
+	{
+		if (m_Dirty[index] || m_LocalScales[index] != scale)
+		{
+			m_LocalScales[index] = scale;
+			SetDirty(index);
+		}
+	}
+
+	void TransformSystem::SetModelAABB(unsigned int index, const BoxBounds &aabb)
+	{
+		m_ModelAABBs[index] = aabb;
+
+		if (aabb.GetInfinite())
+			m_WorldAABBs.Set(index, aabb);
+		else
+			m_WorldAABBs.Set(index, m_WorldMatrices[index].Multiply(aabb));
+	}
+
+	void TransformSystem::Sort()
+	{
+		std::vector<unsigned int> order, parents;
+		order.reserve(m_SceneNodes.size());
+		parents.reserve(m_SceneNodes.size());
+
+		// roots are scenenodes whose parent isn't attached here.
+		for (auto sceneNode : m_SceneNodes)
+		{
+			auto parent = sceneNode->m_Parent.lock();
+			if (parent == nullptr || parent->m_TransformSystem != this)
+				SortSubTree(*sceneNode, InvalidIndex, order, parents);
+		}
+
+		Permute(m_SceneNodes, order);
+		Permute(m_LocalPositions, order);
+		Permute(m_LocalRotations, order);
+		Permute(m_LocalScales, order);
+		Permute(m_LocalMatrices, order);
+		Permute(m_WorldMatrices, order);
+		Permute(m_InvertWorldMatrices, order);
+		Permute(m_InvertWorldDirty, order);
+		Permute(m_ModelAABBs, order);
+		Permute(m_WorldAABBs.CenterX, order);
+		Permute(m_WorldAABBs.CenterY, order);
+		Permute(m_WorldAABBs.CenterZ, order);
+		Permute(m_WorldAABBs.ExtentsX, order);
+		Permute(m_WorldAABBs.ExtentsY, order);
+		Permute(m_WorldAABBs.ExtentsZ, order);
+		Permute(m_Dirty, order);
+		Permute(m_Changed, order);
+
+		m_Parents.swap(parents);
+		m_RootIndices.clear();
+
+		for (unsigned int i = 0; i < m_SceneNodes.size(); i++)
+		{
+			m_SceneNodes[i]->m_TransformIndex = i;
+
+			if (m_Parents[i] == InvalidIndex)
+				m_RootIndices.push_back(i);
+		}
+
+		m_OrderDirty = false;
+	}
+
+	void TransformSystem::SortSubTree(SceneNode &sceneNode, unsigned int parent, std::vector<unsigned int> &order, std::vector<unsigned int> &parents) const
+	{
+		unsigned int index = order.size();
+
+		order.push_back(sceneNode.m_TransformIndex);
+		parents.push_back(parent);
+
+		for (const auto &child : sceneNode.m_Childs)
+		{
+			if (child->m_TransformSystem == this)
+				SortSubTree(*child, index, order, parents);
+		}
+	}
+
+	void TransformSystem::UpdateRange(UpdateTask &task)
+	{
+		task.changed.clear();
+
+		// parents come first, their changed flag is final when their childs read it.
+		for (unsigned int i = task.begin; i < task.end; i++)
+		{
+			unsigned int parent = m_Parents[i];
+			unsigned char changed = m_Dirty[i] | (parent != InvalidIndex ? m_Changed[parent] : 0);
+
+			m_Changed[i] = changed;
+			if (changed)
+			{
+				UpdateEntry(i);
+				task.changed.push_back(i);
+			}
+		}
+	}
+
+	void TransformSystem::EndUpdate(unsigned int taskCount)
+	{
+		m_DirtyCount = 0;
+
+		// tasks are in array order, so parents are still notified before their childs.
+		for (unsigned int i = 0; i < taskCount; i++)
+		{
+			for (auto index : m_UpdateTasks[i].changed)
+				m_ChangedNodes.push_back(m_SceneNodes[index]->shared_from_this());
+		}
+
+		m_ChangedCount = m_ChangedNodes.size();
+
+		for (const auto &sceneNode : m_ChangedNodes)
+		{
+			if (sceneNode->m_SceneManager != nullptr)
+				sceneNode->m_SceneManager->QueueUpdate(sceneNode);
+
+			sceneNode->OnTransformChange->Emit(sceneNode);
+
+			// childs detached from this system follow their parent on their own.
+			for (auto &child : sceneNode->m_Childs)
+			{
+				if (child->m_TransformSystem != this)
+				{
+					child->MarkSubTreeDirty();
+					child->Recompose();
+				}
+			}
+		}
+
+		m_ChangedNodes.clear();
+	}
+
+	void TransformSystem::UpdateEntry(unsigned int index)
+	{
+		AffineMatrix &localMatrix = m_LocalMatrices[index];
+		AffineMatrix &worldMatrix = m_WorldMatrices[index];
+
+		if (m_Dirty[index])
+		{
+			m_Dirty[index] = 0;
+			localMatrix.TRS(m_LocalPositions[index], m_LocalRotations[index], m_LocalScales[index]);
+		}
+
+		unsigned int parent = m_Parents[index];
+		if (parent != InvalidIndex)
+		{
+			worldMatrix = m_WorldMatrices[parent] * localMatrix;
+		}
+		else
+		{
+			// a root might still have a parent outside the system.
+			auto parentNode = m_SceneNodes[index]->m_Parent.lock();
+			worldMatrix = parentNode != nullptr ? parentNode->GetAffineWorldMatrix() * localMatrix : localMatrix;
+		}
+
+		m_InvertWorldDirty[index] = 1;
+
+		const BoxBounds &modelAABB = m_ModelAABBs[index];
+		if (modelAABB.GetInfinite())
+			m_WorldAABBs.Set(index, modelAABB);
+		else
+			m_WorldAABBs.Set(index, worldMatrix.Multiply(modelAABB));
+	}
+}
\ No newline at end of file
@@ -48,16 +48,6 @@ namespace fury
 		return vector;
 	}
 
-	float Vector4::Length() const
-	{
-		return sqrt(x * x + y * y + z * z);
-	}
-
-	float Vector4::SquareLength() const
-	{
-		return x * x + y * y + z * z;
-	}
-
 	float Vector4::Distance(Vector4 other) const
 	{
 		float dx = x - other.x;
@@ -66,16 +56,6 @@ namespace fury
 		return sqrt(dx * dx + dy * dy + dz * dz);
 	}
 
-	Vector4 Vector4::CrossProduct(Vector4 other) const
-	{
-		return Vector4(
-			y * other.z - z * other.y, 
-			z * other.x - x * other.z, 
-			x * other.y - y * other.x, 
-			1.0f
-		);
-	}
-
 	Vector4 Vector4::Project(Vector4 other) const
 	{
 		return other * (*this * other / other.SquareLength());
@@ -85,71 +65,4 @@ namespace fury
 	{
 		return Vector4(*this);
 	}
-	
-	bool Vector4::operator == (Vector4 other) const 
-	{
-		return x == other.x && y == other.y && z == other.z;
-	}
-	
-	bool Vector4::operator != (Vector4 other) const 
-	{
-		return x != other.x || y != other.y || z != other.z;
-	}
-
-	bool Vector4::operator < (Vector4 other) const
-	{
-		return x < other.x && y < other.y && z < other.z;
-	}
-
-	bool Vector4::operator <= (Vector4 other) const
-	{
-		return x <= other.x && y <= other.y && z <= other.z;
-	}
-
-	bool Vector4::operator > (Vector4 other) const
-	{
-		return x > other.x && y > other.y && z > other.z;
-	}
-
-	bool Vector4::operator >= (Vector4 other) const
-	{
-		return x >= other.x && y >= other.y && z >= other.z;
-	}
-
-	Vector4 &Vector4::operator = (Vector4 other) 
-	{
-		x = other.x; y = other.y; z = other.z;
-		return *this;
-	}
-	
-	Vector4 Vector4::operator - () const 
-	{
-		return Vector4(-x, -y, -z, 1.0f);
-	}
-	
-	Vector4 Vector4::operator + (Vector4 other) const 
-	{
-		return Vector4(x + other.x, y + other.y, z + other.z, 1.0f);
-	}
-	
-	Vector4 Vector4::operator - (Vector4 other) const 
-	{
-		return Vector4(x - other.x, y - other.y, z - other.z, 1.0f);
-	}
-
-	float Vector4::operator * (Vector4 other) const 
-	{
-		return x * other.x + y * other.y + z * other.z;
-	}
-	
-	Vector4 Vector4::operator * (const float other) const
-	{
-		return Vector4(x * other, y * other, z * other, 1.0f);
-	}
-
-	Vector4 Vector4::operator / (const float other) const 
-	{
-		float i = 1.0f / other;
-		return Vector4(x * i, y * i, z * i, 1.0f);
-	}
 }
\ No newline at end of file
@@ -83,7 +83,7 @@ void BasicScene::UpdateGUI(float dt)
 {
 	static bool showProfilerWindow = true, showBufferWindow = true;
 
-	ImGui::Begin("Profiler", &showProfilerWindow, ImVec2(240, 260), 1.0f, 
+	ImGui::Begin("Profiler", &showProfilerWindow, ImVec2(240, 310), 1.0f, 
 		ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_ShowBorders | ImGuiWindowFlags_NoCollapse);
 
 	// fps graph
@@ -104,6 +104,9 @@ void BasicScene::UpdateGUI(float dt)
 	ImGui::Text("Mesh: %i", RenderUtil::Instance()->GetMeshCount());
 	ImGui::Text("SkinnedMesh: %i", RenderUtil::Instance()->GetSkinnedMeshCount());
 	ImGui::Text("Light: %i", RenderUtil::Instance()->GetLightCount());
+	ImGui::Text("Visible: %i", RenderUtil::Instance()->GetCullingStats().sceneNodesEmitted);
+	ImGui::Text("Culling: %.2f ms", RenderUtil::Instance()->GetCullingStats().time);
+	ImGui::Text("Sorting: %.2f ms", RenderUtil::Instance()->GetSortTime());
 
 	// switches
 	{
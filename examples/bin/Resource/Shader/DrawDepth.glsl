@@ -22,13 +22,14 @@ void main()
 
 #ifdef FRAGMENT_SHADER
 
+uniform float depth_near = 0;
 uniform float camera_far = 10000;
 
 in float out_depth;
 
 void main()
 {
-	gl_FragDepth = out_depth / camera_far;
+	gl_FragDepth = (out_depth - depth_near) / (camera_far - depth_near);
 }
 
 #endif
\ No newline at end of file